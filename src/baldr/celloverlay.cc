@@ -0,0 +1,262 @@
+#include "baldr/celloverlay.h"
+#include "baldr/parallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <valhalla/midgard/logging.h>
+
+namespace {
+
+// Version of the overlay file layout
+constexpr uint32_t kOverlayVersion = 2;
+
+// Counts that follow the sidecar header of an overlay file. They are
+// followed by the boundary node indexes and then, for each travel mode, its
+// access mask and its times.
+struct OverlayCounts {
+  uint32_t boundary_count;
+  uint32_t mode_count;
+};
+
+// Queue of (time, node) for shortest path searches, least time first
+template <class node_t>
+using TimeQueue = std::priority_queue<std::pair<float, node_t>,
+                                      std::vector<std::pair<float, node_t> >,
+                                      std::greater<std::pair<float, node_t> > >;
+
+}
+
+namespace valhalla {
+namespace baldr {
+
+// Constructor for an empty overlay.
+CellOverlay::CellOverlay() {
+}
+
+// Compute the overlay of a tile.
+CellOverlay::CellOverlay(const GraphTile& tile, const std::vector<uint32_t>& access_modes)
+    : TileSidecar(tile) {
+  // Boundary nodes have an edge to another tile on the same level
+  for (uint32_t n = 0; n < nodecount_; n++) {
+    const NodeInfo* node = tile.node(n);
+    for (uint32_t i = 0; i < node->edge_count(); i++) {
+      GraphId end = tile.directededge(node->edge_index() + i)->endnode();
+      if (end.level() == tile_.level() && end.Tile_Base() != tile_) {
+        boundary_nodes_.push_back(n);
+        break;
+      }
+    }
+  }
+
+  // Search from each boundary node over the edges inside the tile
+  size_t count = boundary_nodes_.size();
+  std::vector<float> node_times(nodecount_);
+  for (const auto access : access_modes) {
+    const EdgeCosts& costs = tile.GetEdgeCosts(access);
+    auto& times = times_[access];
+    times.resize(count * count);
+    for (size_t b = 0; b < count; b++) {
+      std::fill(node_times.begin(), node_times.end(), kUnreachable);
+      TimeQueue<uint32_t> queue;
+      node_times[boundary_nodes_[b]] = 0.0f;
+      queue.emplace(0.0f, boundary_nodes_[b]);
+      while (!queue.empty()) {
+        auto top = queue.top();
+        queue.pop();
+        if (top.first > node_times[top.second]) {
+          continue;
+        }
+        const NodeInfo* node = tile.node(top.second);
+        for (uint32_t i = 0; i < node->edge_count(); i++) {
+          uint32_t idx = node->edge_index() + i;
+          GraphId end = tile.directededge(idx)->endnode();
+          if (!costs.accessible(idx) || end.Tile_Base() != tile_) {
+            continue;
+          }
+          float time = top.first + costs.seconds(idx);
+          if (time < node_times[end.id()]) {
+            node_times[end.id()] = time;
+            queue.emplace(time, end.id());
+          }
+        }
+      }
+      for (size_t c = 0; c < count; c++) {
+        times[b * count + c] = node_times[boundary_nodes_[c]];
+      }
+    }
+  }
+}
+
+// Read an overlay file.
+CellOverlay::CellOverlay(const std::string& file) {
+  std::vector<uint32_t> boundary_nodes;
+  std::unordered_map<uint32_t, std::vector<float> > times;
+  bool read = Read(file, kOverlayVersion, [&](std::istream& in, const uint32_t) {
+    OverlayCounts counts;
+    if (!in.read(reinterpret_cast<char*>(&counts), sizeof(counts))) {
+      return;
+    }
+    boundary_nodes.resize(counts.boundary_count);
+    in.read(reinterpret_cast<char*>(boundary_nodes.data()),
+            boundary_nodes.size() * sizeof(uint32_t));
+    for (uint32_t m = 0; in && m < counts.mode_count; m++) {
+      uint32_t access = 0;
+      in.read(reinterpret_cast<char*>(&access), sizeof(access));
+      auto& mode_times = times[access];
+      mode_times.resize(static_cast<size_t>(counts.boundary_count) * counts.boundary_count);
+      in.read(reinterpret_cast<char*>(mode_times.data()), mode_times.size() * sizeof(float));
+    }
+  });
+  if (read) {
+    boundary_nodes_ = std::move(boundary_nodes);
+    times_ = std::move(times);
+  }
+}
+
+// Write the overlay to a file.
+bool CellOverlay::Write(const std::string& file) const {
+  return TileSidecar::Write(file, kOverlayVersion, [this](std::ostream& out) {
+    OverlayCounts counts{static_cast<uint32_t>(boundary_nodes_.size()),
+                         static_cast<uint32_t>(times_.size())};
+    out.write(reinterpret_cast<const char*>(&counts), sizeof(counts));
+    out.write(reinterpret_cast<const char*>(boundary_nodes_.data()),
+              boundary_nodes_.size() * sizeof(uint32_t));
+    for (const auto& mode : times_) {
+      out.write(reinterpret_cast<const char*>(&mode.first), sizeof(mode.first));
+      out.write(reinterpret_cast<const char*>(mode.second.data()),
+                mode.second.size() * sizeof(float));
+    }
+  });
+}
+
+// Get the overlay file name of a tile.
+std::string CellOverlay::FileName(const GraphId& graphid, const TileHierarchy& hierarchy) {
+  return hierarchy.tile_path().FullPath(hierarchy.tile_dir(), graphid, ".ovl");
+}
+
+// Get the boundary nodes.
+const std::vector<uint32_t>& CellOverlay::boundary_nodes() const {
+  return boundary_nodes_;
+}
+
+// Get the position of a node among the boundary nodes.
+int32_t CellOverlay::boundary_index(const uint32_t node_index) const {
+  auto found = std::lower_bound(boundary_nodes_.begin(), boundary_nodes_.end(), node_index);
+  if (found == boundary_nodes_.end() || *found != node_index) {
+    return -1;
+  }
+  return found - boundary_nodes_.begin();
+}
+
+// Get the travel times between the boundary nodes for a travel mode.
+const float* CellOverlay::times(const uint32_t access) const {
+  auto found = times_.find(access);
+  return (found == times_.end()) ? nullptr : found->second.data();
+}
+
+// Compute and write the overlays of all tiles of a level.
+size_t BuildOverlays(const TileHierarchy& hierarchy, const uint8_t level,
+                     const std::vector<uint32_t>& access_modes, size_t threads) {
+  auto tiles = GraphReader::GetTileSet(hierarchy, level);
+  ParallelFor(tiles.size(), threads, [&](const size_t i) {
+    GraphTile tile(hierarchy, tiles[i]);
+    if (tile.size() == 0) {
+      throw std::runtime_error("Could not load tile " + std::to_string(tiles[i].value));
+    }
+    std::string file = CellOverlay::FileName(tiles[i], hierarchy);
+    if (!CellOverlay(tile, access_modes).Write(file)) {
+      throw std::runtime_error("Could not write overlay " + file);
+    }
+  });
+  return tiles.size();
+}
+
+// Constructor
+OverlayGraph::OverlayGraph(const TileHierarchy& hierarchy, const uint32_t access)
+    : hierarchy_(hierarchy),
+      access_(access) {
+}
+
+// Get the overlay of a tile if there is one that matches the tile.
+const CellOverlay* OverlayGraph::GetOverlay(const GraphTile& tile) {
+  GraphId base = tile.id().Tile_Base();
+  auto found = overlays_.find(base);
+  if (found == overlays_.end()) {
+    std::unique_ptr<CellOverlay> overlay(new CellOverlay(CellOverlay::FileName(base, hierarchy_)));
+    if (!overlay->Matches(tile) || overlay->times(access_) == nullptr) {
+      overlay.reset();
+    }
+    found = overlays_.emplace(base, std::move(overlay)).first;
+  }
+  return found->second.get();
+}
+
+// Get the shortest travel time between 2 nodes on the same level.
+float OverlayGraph::TravelTime(GraphReader& reader, const GraphId& origin,
+                               const GraphId& destination) {
+  if (origin.level() != destination.level()) {
+    throw std::runtime_error("Overlay travel times need nodes on the same level");
+  }
+  GraphId origin_tile = origin.Tile_Base();
+  GraphId destination_tile = destination.Tile_Base();
+  std::unordered_map<GraphId, float> node_times;
+  TimeQueue<uint64_t> queue;
+  auto relax = [&node_times, &queue](const GraphId& node, const float time) {
+    auto inserted = node_times.emplace(node, time);
+    if (inserted.second || time < inserted.first->second) {
+      inserted.first->second = time;
+      queue.emplace(time, node.value);
+    }
+  };
+  relax(origin, 0.0f);
+  while (!queue.empty()) {
+    auto top = queue.top();
+    queue.pop();
+    GraphId node(top.second);
+    if (top.first > node_times[node]) {
+      continue;
+    }
+    if (node == destination) {
+      return top.first;
+    }
+    const GraphTile* tile = reader.GetGraphTile(node);
+    if (tile == nullptr) {
+      continue;
+    }
+
+    // Cross a cell through its overlay unless it holds the origin or
+    // destination. Only the edges leaving the cell are then expanded.
+    GraphId base = node.Tile_Base();
+    const CellOverlay* overlay = nullptr;
+    int32_t boundary = -1;
+    if (base != origin_tile && base != destination_tile) {
+      overlay = GetOverlay(*tile);
+      boundary = overlay ? overlay->boundary_index(node.id()) : -1;
+    }
+    if (boundary >= 0) {
+      const auto& boundary_nodes = overlay->boundary_nodes();
+      const float* times = overlay->times(access_) + boundary * boundary_nodes.size();
+      for (size_t c = 0; c < boundary_nodes.size(); c++) {
+        if (times[c] != kUnreachable && c != static_cast<size_t>(boundary)) {
+          relax(GraphId(base.tileid(), base.level(), boundary_nodes[c]), top.first + times[c]);
+        }
+      }
+    }
+    const EdgeCosts& costs = tile->GetEdgeCosts(access_);
+    const NodeInfo* nodeinfo = tile->node(node);
+    for (uint32_t i = 0; i < nodeinfo->edge_count(); i++) {
+      uint32_t idx = nodeinfo->edge_index() + i;
+      GraphId end = tile->directededge(idx)->endnode();
+      if (!costs.accessible(idx) || end.level() != node.level() ||
+          (boundary >= 0 && end.Tile_Base() == base)) {
+        continue;
+      }
+      relax(end, top.first + costs.seconds(idx));
+    }
+  }
+  return kUnreachable;
+}
+
+}
+}
@@ -1,10 +1,20 @@
 #include "baldr/connectivity_map.h"
 #include "baldr/json.h"
 #include "baldr/graphtile.h"
+#include "baldr/parallel.h"
 
 #include <valhalla/midgard/pointll.h>
+#include <valhalla/midgard/logging.h>
 #include <boost/filesystem.hpp>
-#include <list>
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace valhalla::baldr;
 using namespace valhalla::midgard;
@@ -46,106 +56,274 @@ namespace {
      }
    */
 
-  json::MapPtr to_properties(const size_t color) {
-    return json::map({
-      {std::string("color"), static_cast<uint64_t>(color)}
-    });
+  //version of the connectivity file layout
+  constexpr uint32_t kConnectivityVersion = 3;
+
+  //start of a connectivity file, followed by an entry per level. the tile
+  //ids of a level start at its offset and are followed by their colors
+  struct connectivity_header_t {
+    uint32_t version;
+    uint32_t level_count;
+    uint64_t tile_count;
+  };
+  struct connectivity_level_t {
+    uint32_t level;
+    uint32_t count;
+    uint64_t offset;
+  };
+
+  //the tiles on disk by level and their number
+  struct tile_listing_t {
+    std::vector<uint8_t> levels;
+    std::vector<std::vector<uint32_t> > tiles;
+    uint64_t count;
+  };
+
+  //adds the ids of the tiles of a level under a directory
+  void add_tiles(const boost::filesystem::path& dir, const bool recursive, const uint8_t level, const TileHierarchy& tile_hierarchy, std::vector<uint32_t>& tiles) {
+    for(const auto& tile : tile_hierarchy.tile_path().FindTiles(dir.string(), recursive))
+      if(tile.level() == level)
+        tiles.push_back(tile.tileid());
   }
 
-  json::MapPtr to_geometry(const std::list<PointLL>& tiles) {
-    auto multipoint = json::array({});
-    for(const auto& tile : tiles)
-      multipoint->emplace_back(json::array({json::fp_t{tile.first, 6}, json::fp_t{tile.second, 6}}));
-    return json::map({
-      {std::string("type"), std::string("MultiPoint")},
-      {std::string("coordinates"), multipoint}
+  //lists the tiles on disk
+  tile_listing_t list_tiles(const TileHierarchy& tile_hierarchy, const size_t threads) {
+    //a listing job for the files of each level directory and for each of its subdirectories
+    struct listing_t {
+      uint8_t level;
+      boost::filesystem::path dir;
+      bool recursive;
+    };
+    tile_listing_t listing{{}, {}, 0};
+    std::vector<listing_t> jobs;
+    for(const auto& tile_level : tile_hierarchy.levels()) {
+      listing.levels.push_back(tile_level.first);
+      boost::filesystem::path root_dir(tile_hierarchy.tile_dir() + '/' + std::to_string(tile_level.first) + '/');
+      if(!boost::filesystem::is_directory(root_dir))
+        continue;
+      jobs.push_back({tile_level.first, root_dir, false});
+      for(boost::filesystem::directory_iterator i(root_dir), end; i != end; ++i)
+        if(boost::filesystem::is_directory(i->path()))
+          jobs.push_back({tile_level.first, i->path(), true});
+    }
+    std::vector<std::vector<uint32_t> > listings(jobs.size());
+    ParallelFor(jobs.size(), threads, [&](const size_t i) {
+      add_tiles(jobs[i].dir, jobs[i].recursive, jobs[i].level, tile_hierarchy, listings[i]);
     });
+
+    //gather the jobs of each level
+    listing.tiles.resize(listing.levels.size());
+    for(size_t l = 0; l < listing.levels.size(); ++l) {
+      for(size_t i = 0; i < jobs.size(); ++i) {
+        if(jobs[i].level != listing.levels[l])
+          continue;
+        listing.tiles[l].insert(listing.tiles[l].end(), listings[i].begin(), listings[i].end());
+      }
+      listing.count += listing.tiles[l].size();
+    }
+    return listing;
   }
 
-  json::MapPtr to_feature(const std::pair<size_t, std::list<PointLL> >& region) {
-    return json::map({
-      {std::string("type"), std::string("Feature")},
-      {std::string("geometry"), to_geometry(region.second)},
-      {std::string("properties"), to_properties(region.first)}
+  //builds the bytes of a connectivity file from the tiles on disk
+  std::string build_file(const TileHierarchy& tile_hierarchy, const tile_listing_t& listing, const size_t threads) {
+    const auto& levels = listing.levels;
+
+    //color each level, neighboring tiles get the same color
+    std::vector<std::vector<uint32_t> > tiles(levels.size()), colors(levels.size());
+    ParallelFor(levels.size(), threads, [&](const size_t l) {
+      std::unordered_map<uint32_t, size_t> level_colors;
+      for(const auto tile : listing.tiles[l])
+        level_colors.emplace(tile, 0);
+      tile_hierarchy.levels().find(levels[l])->second.tiles.ColorMap(level_colors);
+      for(const auto& tile : level_colors)
+        tiles[l].push_back(tile.first);
+      std::sort(tiles[l].begin(), tiles[l].end());
+      for(const auto tile : tiles[l])
+        colors[l].push_back(static_cast<uint32_t>(level_colors[tile]));
     });
+
+    //lay out the file
+    connectivity_header_t header{kConnectivityVersion, static_cast<uint32_t>(levels.size()), listing.count};
+    std::vector<connectivity_level_t> entries;
+    uint64_t offset = sizeof(header) + levels.size() * sizeof(connectivity_level_t);
+    for(size_t l = 0; l < levels.size(); ++l) {
+      entries.push_back({levels[l], static_cast<uint32_t>(tiles[l].size()), offset});
+      offset += 2 * tiles[l].size() * sizeof(uint32_t);
+    }
+    std::string bytes(reinterpret_cast<const char*>(&header), sizeof(header));
+    bytes.append(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(connectivity_level_t));
+    for(size_t l = 0; l < levels.size(); ++l) {
+      bytes.append(reinterpret_cast<const char*>(tiles[l].data()), tiles[l].size() * sizeof(uint32_t));
+      bytes.append(reinterpret_cast<const char*>(colors[l].data()), colors[l].size() * sizeof(uint32_t));
+    }
+    return bytes;
   }
 
-  template <class T>
-  std::string to_feature_collection(const std::unordered_map<size_t, std::list<PointLL> >& regions, const std::multimap<size_t, size_t, T>& arities) {
-    auto features = json::array({});
-    for(const auto& arity : arities)
-      features->emplace_back(to_feature(*regions.find(arity.second)));
-    std::stringstream ss;
-    ss << *json::map({
-      {std::string("type"), std::string("FeatureCollection")},
-      {std::string("features"), features}
+  //writes a file through a temporary file so readers never see part of it. the
+  //temporary file has a unique name so concurrent writers do not share it
+  bool save_file(const std::string& bytes, const std::string& file_name) {
+    std::vector<char> temp_name(file_name.begin(), file_name.end());
+    for(const char c : std::string(".XXXXXX"))
+      temp_name.push_back(c);
+    temp_name.push_back('\0');
+    int fd = mkstemp(temp_name.data());
+    if(fd < 0)
+      return false;
+    bool written = fchmod(fd, 0644) == 0;
+    for(size_t offset = 0; written && offset < bytes.size(); ) {
+      ssize_t count = write(fd, bytes.data() + offset, bytes.size() - offset);
+      written = count > 0;
+      offset += written ? count : 0;
+    }
+    written = close(fd) == 0 && written;
+    if(!written || std::rename(temp_name.data(), file_name.c_str()) != 0) {
+      std::remove(temp_name.data());
+      return false;
+    }
+    return true;
+  }
+
+  //maps a file into memory read only
+  std::shared_ptr<const char> map_file(const std::string& file_name, size_t& size) {
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if(fd < 0)
+      return nullptr;
+    struct stat status;
+    if(fstat(fd, &status) != 0 || status.st_size == 0) {
+      close(fd);
+      return nullptr;
+    }
+    size = status.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED)
+      return nullptr;
+    return std::shared_ptr<const char>(static_cast<const char*>(mapped), [size](const char* p) {
+      munmap(const_cast<char*>(p), size);
     });
-    return ss.str();
   }
 }
 
 namespace valhalla {
   namespace baldr {
-    connectivity_map_t::connectivity_map_t(const TileHierarchy& tile_hierarchy):tile_hierarchy(tile_hierarchy) {
-      // Populate a map for each level of the tiles that exist
-      for (const auto& tile_level : tile_hierarchy.levels()) {
-        try {
-          auto& level_colors = colors.insert({tile_level.first, std::unordered_map<uint32_t, size_t>{}}).first->second;
-          boost::filesystem::path root_dir(tile_hierarchy.tile_dir() + '/' + std::to_string(tile_level.first) + '/');
-          if(boost::filesystem::exists(root_dir) && boost::filesystem::is_directory(root_dir)) {
-            for (boost::filesystem::recursive_directory_iterator i(root_dir), end; i != end; ++i) {
-              if (!boost::filesystem::is_directory(i->path())) {
-                GraphId id = GraphTile::GetTileId(i->path().string(), tile_hierarchy);
-                level_colors.insert({id.tileid(), 0});
-              }
-            }
-          }
-        }
-        catch(...) {
-        }
-      }
+    connectivity_map_t::connectivity_map_t(const TileHierarchy& tile_hierarchy, size_t threads):tile_hierarchy(tile_hierarchy) {
+      //map the file if there is a valid one. it is trusted to match the tiles,
+      //build() rewrites it when they change. checking it against the tiles
+      //would list the whole tile set every time a reader starts
+      auto file = file_name(tile_hierarchy);
+      size_t size = 0;
+      auto mapped = map_file(file, size);
+      if(mapped && set_data(mapped, size))
+        return;
+      if(mapped)
+        LOG_WARN("Ignoring invalid connectivity file " + file + ", run valhalla_build_connectivity");
 
-      // All tiles have color 0 (not connected), go through each level and connect them
-      for(auto& level_colors : colors) {
-        auto level = tile_hierarchy.levels().find(level_colors.first);
-        level->second.tiles.ColorMap(level_colors.second);
+      //build it in memory from the tiles on disk, without it no tiles are
+      //connected. only build() writes the file, readers may not own the tile
+      //directory
+      std::shared_ptr<std::string> bytes;
+      try {
+        bytes = std::make_shared<std::string>(build_file(tile_hierarchy, list_tiles(tile_hierarchy, threads), threads));
+      }
+      catch(const std::exception& e) {
+        LOG_ERROR(std::string("Could not build the connectivity map: ") + e.what());
+        return;
+      }
+      set_data(std::shared_ptr<const char>(bytes, bytes->data()), bytes->size());
+    }
+    size_t connectivity_map_t::build(const TileHierarchy& tile_hierarchy, size_t threads) {
+      auto file = file_name(tile_hierarchy);
+      auto listing = list_tiles(tile_hierarchy, threads);
+      auto bytes = build_file(tile_hierarchy, listing, threads);
+      if(!save_file(bytes, file))
+        throw std::runtime_error("Could not save connectivity file " + file);
+      return listing.count;
+    }
+    std::string connectivity_map_t::file_name(const TileHierarchy& tile_hierarchy) {
+      return tile_hierarchy.tile_dir() + "/connectivity.bin";
+    }
+    bool connectivity_map_t::set_data(const std::shared_ptr<const char>& bytes, const size_t size) {
+      //check the layout before pointing into it
+      if(size < sizeof(connectivity_header_t))
+        return false;
+      const auto* header = reinterpret_cast<const connectivity_header_t*>(bytes.get());
+      if(header->version != kConnectivityVersion ||
+         (size - sizeof(connectivity_header_t)) / sizeof(connectivity_level_t) < header->level_count)
+        return false;
+      const auto* entries = reinterpret_cast<const connectivity_level_t*>(header + 1);
+      std::unordered_map<uint32_t, level_colors_t> levels;
+      for(uint32_t l = 0; l < header->level_count; ++l) {
+        const auto& entry = entries[l];
+        if(entry.offset % sizeof(uint32_t) != 0 || entry.offset > size ||
+           (size - entry.offset) / (2 * sizeof(uint32_t)) < entry.count)
+          return false;
+        const auto* tiles = reinterpret_cast<const uint32_t*>(bytes.get() + entry.offset);
+        levels[entry.level] = {tiles, tiles + entry.count, entry.count};
       }
+      colors = std::move(levels);
+      data = bytes;
+      return true;
     }
     size_t connectivity_map_t::get_color(const GraphId& id) const {
       auto level = colors.find(id.level());
       if(level == colors.cend())
         return 0;
-      auto color = level->second.find(id.tileid());
-      if(color == level->second.cend())
+      const auto& level_colors = level->second;
+      auto tile = std::lower_bound(level_colors.tiles, level_colors.tiles + level_colors.count, id.tileid());
+      if(tile == level_colors.tiles + level_colors.count || *tile != id.tileid())
         return 0;
-      return color->second;
+      return level_colors.colors[tile - level_colors.tiles];
     }
     std::string connectivity_map_t::to_geojson(const uint32_t hierarchy_level) const {
+      std::stringstream ss;
+      to_geojson(ss, hierarchy_level);
+      return ss.str();
+    }
+
+    void connectivity_map_t::to_geojson(std::ostream& out, const uint32_t hierarchy_level) const {
       //bail if we dont have the level
       auto bbox = tile_hierarchy.levels().find(hierarchy_level);
       auto level = colors.find(hierarchy_level);
       if(bbox == tile_hierarchy.levels().cend() || level == colors.cend())
         throw std::runtime_error("hierarchy level not found");
+      const auto& level_colors = level->second;
 
-      //make a region map (inverse mapping of color to lists of tiles)
-      //could cache this but shouldnt need to call it much
-      std::unordered_map<size_t, std::list<PointLL> > regions;
-      for(const auto& tile : level->second) {
-        auto region = regions.find(tile.second);
-        if(region == regions.end())
-          regions.emplace(tile.second, std::list<PointLL>{bbox->second.tiles.Center(tile.first)});
-        else
-          region->second.push_back(bbox->second.tiles.Center(tile.first));
-      }
+      //count the tiles of each region so we can put the biggest ones first
+      std::unordered_map<uint32_t, uint32_t> arities;
+      for(size_t i = 0; i < level_colors.count; ++i)
+        ++arities[level_colors.colors[i]];
+      std::vector<std::pair<uint32_t, uint32_t> > regions(arities.begin(), arities.end());
+      std::sort(regions.begin(), regions.end(), [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+        return a.second > b.second || (a.second == b.second && a.first < b.first);
+      });
 
-      //record the arity of each region so we can put the biggest ones first
-      auto comp = [](const size_t& a, const size_t& b){return a > b;};
-      std::multimap<size_t, size_t, decltype(comp)> arities(comp);
-      for(const auto& region : regions)
-        arities.emplace(region.second.size(), region.first);
+      //group the tiles by region, in region order and keeping the tile order
+      std::unordered_map<uint32_t, uint32_t> starts;
+      uint32_t start = 0;
+      for(const auto& region : regions) {
+        starts.emplace(region.first, start);
+        start += region.second;
+      }
+      std::vector<uint32_t> grouped(level_colors.count);
+      for(size_t i = 0; i < level_colors.count; ++i)
+        grouped[starts[level_colors.colors[i]]++] = level_colors.tiles[i];
 
-      //turn it into geojson
-      return to_feature_collection<decltype(comp)>(regions, arities);
+      //write a multipoint feature of the tile centers of each region
+      auto flags = out.flags();
+      auto precision = out.precision();
+      out << "{\"type\":\"FeatureCollection\",\"features\":[";
+      auto tile = grouped.cbegin();
+      for(size_t r = 0; r < regions.size(); ++r) {
+        out << (r == 0 ? "" : ",") << "{\"type\":\"Feature\",\"geometry\":{\"type\":\"MultiPoint\",\"coordinates\":[";
+        for(uint32_t t = 0; t < regions[r].second; ++t, ++tile) {
+          auto center = bbox->second.tiles.Center(*tile);
+          out << (t == 0 ? "[" : ",[") << json::fp_t{center.first, 6} << ',' << json::fp_t{center.second, 6} << ']';
+        }
+        out << "]},\"properties\":{\"color\":" << regions[r].first << "}}";
+      }
+      out << "]}";
+      out.flags(flags);
+      out.precision(precision);
     }
 
     std::vector<size_t> connectivity_map_t::to_image(const uint32_t hierarchy_level) const {
@@ -156,12 +334,59 @@ namespace valhalla {
         throw std::runtime_error("hierarchy level not found");
 
       std::vector<size_t> tiles(bbox->second.tiles.nrows() * bbox->second.tiles.ncolumns(), static_cast<uint32_t>(0));
-      for(size_t i = 0; i < tiles.size(); ++i) {
-        const auto color = level->second.find(static_cast<uint32_t>(i));
-        if(color != level->second.cend())
-          tiles[i] = color->second;
+      for(size_t i = 0; i < level->second.count; ++i) {
+        if(level->second.tiles[i] < tiles.size())
+          tiles[level->second.tiles[i]] = level->second.colors[i];
+      }
+
+      return tiles;
+    }
+
+    connectivity_image_t connectivity_map_t::to_encoded_image(const uint32_t hierarchy_level) const {
+      //bail if we dont have the level
+      auto bbox = tile_hierarchy.levels().find(hierarchy_level);
+      auto level = colors.find(hierarchy_level);
+      if(bbox == tile_hierarchy.levels().cend() || level == colors.cend())
+        throw std::runtime_error("hierarchy level not found");
+      const auto& level_colors = level->second;
+
+      connectivity_image_t image{static_cast<uint32_t>(bbox->second.tiles.ncolumns()),
+                                 static_cast<uint32_t>(bbox->second.tiles.nrows()), {0}, {}};
+      std::unordered_map<uint32_t, uint32_t> palette{{0, 0}};
+      auto append = [&image](const uint32_t index, const uint32_t length) {
+        if(length == 0)
+          return;
+        if(!image.runs.empty() && image.runs.back().first == index)
+          image.runs.back().second += length;
+        else
+          image.runs.emplace_back(index, length);
+      };
+
+      //runs of empty grid between the tiles, the tiles are in grid order
+      uint32_t size = image.columns * image.rows;
+      uint32_t next = 0;
+      uint32_t index = 0;
+      for(size_t i = 0; i < level_colors.count && level_colors.tiles[i] < size; ++i) {
+        //neighboring tiles mostly share a color, skip the palette lookup then
+        if(i == 0 || level_colors.colors[i] != level_colors.colors[i - 1]) {
+          auto found = palette.emplace(level_colors.colors[i], image.palette.size());
+          if(found.second)
+            image.palette.push_back(level_colors.colors[i]);
+          index = found.first->second;
+        }
+        append(0, level_colors.tiles[i] - next);
+        append(index, 1);
+        next = level_colors.tiles[i] + 1;
       }
+      append(0, size - next);
+      return image;
+    }
 
+    std::vector<size_t> connectivity_image_t::decode() const {
+      std::vector<size_t> tiles;
+      tiles.reserve(static_cast<size_t>(columns) * rows);
+      for(const auto& run : runs)
+        tiles.insert(tiles.end(), run.second, palette[run.first]);
       return tiles;
     }
   }
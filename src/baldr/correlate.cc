@@ -0,0 +1,89 @@
+#include "baldr/correlate.h"
+#include "baldr/edgesearch.h"
+#include "baldr/parallel.h"
+
+#include <algorithm>
+
+namespace valhalla {
+namespace baldr {
+
+// Correlate a location to the graph.
+PathLocation Correlate(GraphReader& reader, const Location& location,
+                       const float radius, const uint32_t access) {
+  EdgeSearcher searcher(reader);
+  return Correlate(searcher, location, radius, access);
+}
+
+// Correlate a location to the graph, reusing the shapes of the searcher.
+PathLocation Correlate(EdgeSearcher& searcher, const Location& location,
+                       const float radius, const uint32_t access) {
+  PathLocation correlated(location);
+  auto nearest = searcher.Find(location.latlng_, radius, kMaxCorrelatedEdges, access);
+  if (nearest.empty()) {
+    return correlated;
+  }
+  correlated.CorrelateVertex(nearest.front().point);
+  for (const auto& edge : nearest) {
+    if (edge.distance > nearest.front().distance + kCorrelationTolerance) {
+      break;
+    }
+    correlated.CorrelateEdge(edge.edge);
+  }
+  return correlated;
+}
+
+// Correlate many locations to the graph.
+std::vector<PathLocation> CorrelateLocations(
+    const boost::property_tree::ptree& config,
+    const std::vector<Location>& locations, const float radius,
+    const uint32_t access, size_t threads) {
+  // Sort the locations by tile so each thread gets runs of the same tile
+  TileHierarchy hierarchy(config);
+  std::vector<std::pair<uint64_t, size_t> > order;
+  order.reserve(locations.size());
+  for (size_t i = 0; i < locations.size(); ++i) {
+    uint64_t tile = hierarchy.levels().empty() ? 0 :
+        hierarchy.GetGraphId(locations[i].latlng_, hierarchy.levels().rbegin()->first);
+    order.emplace_back(tile, i);
+  }
+  std::sort(order.begin(), order.end());
+
+  // Results are filled in place so threads never write the same element.
+  // PathLocation has no default constructor so start with the locations.
+  std::vector<PathLocation> results(locations.begin(), locations.end());
+  threads = ThreadCount(threads, locations.size());
+
+  // Read the tiles of the locations once, spread over the threads. The
+  // reader of each thread gets a copy of each, which shares the tile memory
+  std::vector<GraphId> tile_ids;
+  for (const auto& location : order) {
+    if (tile_ids.empty() || tile_ids.back().value != location.first) {
+      tile_ids.emplace_back(location.first);
+    }
+  }
+  std::vector<GraphTile> tiles(tile_ids.size());
+  bool lazy = config.get<bool>("lazy_tiles", false);
+  ParallelFor(tile_ids.size(), threads, [&](const size_t i) {
+    tiles[i] = GraphTile(hierarchy, tile_ids[i], lazy);
+  });
+
+  // Each thread correlates a contiguous slice of the sorted locations so
+  // runs of locations in the same tile reuse the decoded shapes
+  RunThreads(threads, [&](const size_t thread) {
+    GraphReader reader(config);
+    for (const auto& tile : tiles) {
+      reader.AddGraphTile(tile);
+    }
+    EdgeSearcher searcher(reader);
+    size_t begin = order.size() * thread / threads;
+    size_t end = order.size() * (thread + 1) / threads;
+    for (size_t i = begin; i < end; ++i) {
+      size_t index = order[i].second;
+      results[index] = Correlate(searcher, locations[index], radius, access);
+    }
+  });
+  return results;
+}
+
+}
+}
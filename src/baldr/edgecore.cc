@@ -0,0 +1,24 @@
+#include "baldr/edgecore.h"
+
+namespace valhalla {
+namespace baldr {
+
+// Copy the routing attributes of a directed edge
+EdgeCore::EdgeCore(const DirectedEdge& edge)
+    : endnode_(edge.endnode().value),
+      length_(edge.length()),
+      speed_(edge.speed()),
+      forwardaccess_(edge.forwardaccess()),
+      opp_index_(edge.opp_index()),
+      use_(static_cast<uint8_t>(edge.use())),
+      trans_up_(edge.trans_up()),
+      trans_down_(edge.trans_down()),
+      is_shortcut_(edge.is_shortcut()),
+      leaves_tile_(edge.leaves_tile()),
+      not_thru_(edge.not_thru()),
+      dest_only_(edge.destonly()),
+      unreachable_(edge.unreachable()) {
+}
+
+}
+}
@@ -0,0 +1,97 @@
+#include "baldr/edgecosts.h"
+#include "baldr/recordfields.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+using namespace valhalla::baldr;
+
+constexpr size_t kWords = sizeof(DirectedEdge) / sizeof(uint64_t);
+constexpr BitField kSpeedField = GetBitField(DirectedEdgeField::kSpeed);
+constexpr BitField kTruckSpeedField = GetBitField(DirectedEdgeField::kTruckSpeed);
+constexpr BitField kAccessField = GetBitField(DirectedEdgeField::kForwardAccess);
+constexpr BitField kLengthField = GetBitField(DirectedEdgeField::kLength);
+static_assert(InHalfWord(kSpeedField) && InHalfWord(kTruckSpeedField) &&
+              InHalfWord(kAccessField) && InHalfWord(kLengthField),
+              "Edge cost fields must fit 32 bit lanes");
+
+}
+
+namespace valhalla {
+namespace baldr {
+
+// Compute the travel time and accessibility of the directed edges
+EdgeCosts::EdgeCosts(const DirectedEdge* edges, const size_t count,
+                     const uint32_t access)
+    : access_(access),
+      seconds_(count),
+      accessible_(count) {
+  // Seconds = meters * 3.6 / kph, 0 for edges that are not accessible
+  const bool truck = (access == kTruckAccess);
+  const uint64_t* words = reinterpret_cast<const uint64_t*>(edges);
+  float* seconds = seconds_.data();
+  uint8_t* accessible = accessible_.data();
+  size_t i = 0;
+#if defined(__SSE2__)
+  // 4 edges at a time, the fields of each in a 32 bit lane
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i modes = _mm_set1_epi32(static_cast<int>(access));
+  const __m128i use_truck = truck ? _mm_set1_epi32(-1) : zero;
+  const __m128 kph_scale = _mm_set1_ps(3.6f);
+  const __m128 one = _mm_set1_ps(1.0f);
+  for (; i + 4 <= count; i += 4) {
+    const uint64_t* w = words + i * kWords;
+    __m128i speed = LoadField4<kWords>(w, kSpeedField);
+    __m128i truck_speed = LoadField4<kWords>(w, kTruckSpeedField);
+    __m128i pick = _mm_andnot_si128(_mm_cmpeq_epi32(truck_speed, zero), use_truck);
+    speed = _mm_or_si128(_mm_and_si128(pick, truck_speed), _mm_andnot_si128(pick, speed));
+    __m128i ok = _mm_andnot_si128(
+        _mm_cmpeq_epi32(_mm_and_si128(LoadField4<kWords>(w, kAccessField), modes), zero),
+        _mm_cmpgt_epi32(speed, zero));
+    __m128 length = _mm_cvtepi32_ps(LoadField4<kWords>(w, kLengthField));
+    __m128 time = _mm_div_ps(_mm_mul_ps(length, kph_scale),
+                             _mm_max_ps(_mm_cvtepi32_ps(speed), one));
+    _mm_storeu_ps(seconds + i, _mm_and_ps(time, _mm_castsi128_ps(ok)));
+    int bits = _mm_movemask_ps(_mm_castsi128_ps(ok));
+    accessible[i] = bits & 1;
+    accessible[i + 1] = (bits >> 1) & 1;
+    accessible[i + 2] = (bits >> 2) & 1;
+    accessible[i + 3] = (bits >> 3) & 1;
+  }
+#endif
+  // Scalar fallback and tail
+  for (; i < count; ++i) {
+    const DirectedEdge& edge = edges[i];
+    uint32_t speed = (truck && edge.truck_speed() > 0) ?
+        edge.truck_speed() : edge.speed();
+    bool ok = (edge.forwardaccess() & access) && speed > 0;
+    seconds[i] = ok ? edge.length() * 3.6f / speed : 0.0f;
+    accessible[i] = ok ? 1 : 0;
+  }
+}
+
+// Get the access mask the costs were computed for.
+uint32_t EdgeCosts::access() const {
+  return access_;
+}
+
+// Get the number of directed edges.
+size_t EdgeCosts::size() const {
+  return seconds_.size();
+}
+
+// Get the travel times of all the directed edges.
+const std::vector<float>& EdgeCosts::seconds() const {
+  return seconds_;
+}
+
+// Get the accessibility flags of all the directed edges.
+const std::vector<uint8_t>& EdgeCosts::accessible() const {
+  return accessible_;
+}
+
+}
+}
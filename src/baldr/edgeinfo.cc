@@ -1,4 +1,8 @@
 #include "baldr/edgeinfo.h"
+#include "baldr/shapedecoder.h"
+#include "baldr/quantizedshape.h"
+
+#include <cstring>
 
 using namespace valhalla::baldr;
 
@@ -16,28 +20,25 @@ json::ArrayPtr names_json(const std::vector<std::string>& names) {
 namespace valhalla {
 namespace baldr {
 
-EdgeInfo::EdgeInfo(char* ptr, const char* names_list,
-                   const size_t names_list_length)
-  : names_list_(names_list), names_list_length_(names_list_length) {
+EdgeInfo::EdgeInfo(const char* ptr, const char* names_list,
+                   const size_t names_list_length,
+                   const int32_t* quantized_shape,
+                   const uint32_t quantized_count)
+  : names_list_(names_list), names_list_length_(names_list_length),
+    quantized_shape_(quantized_shape), quantized_count_(quantized_count) {
 
-  wayid_ = *(reinterpret_cast<uint64_t*>(ptr));
+  wayid_ = *(reinterpret_cast<const uint64_t*>(ptr));
   ptr += sizeof(uint64_t);
 
-  item_ = reinterpret_cast<PackedItem*>(ptr);
+  item_ = reinterpret_cast<const PackedItem*>(ptr);
   ptr += sizeof(PackedItem);
 
   // Set street_name_offset_list_ pointer
-  street_name_offset_list_ = reinterpret_cast<uint32_t*>(ptr);
+  street_name_offset_list_ = reinterpret_cast<const uint32_t*>(ptr);
   ptr += (name_count() * sizeof(uint32_t));
 
   // Set encoded_shape_ pointer
   encoded_shape_ = ptr;
-  ptr += (encoded_shape_size() * sizeof(char));
-}
-
-EdgeInfo::~EdgeInfo() {
-  //nothing to delete these are all shallow pointers for the moment held
-  //by another object
 }
 
 // Gets the OSM way Id.
@@ -78,28 +79,57 @@ const std::vector<std::string> EdgeInfo::GetNames() const {
   return names;
 }
 
-// Returns shape as a vector of PointLL
-const std::vector<PointLL>& EdgeInfo::shape() const {
-  //if we haven't yet decoded the shape, do so
-  if(encoded_shape_ != nullptr) {
-    shape_ = midgard::decode<std::vector<PointLL> >(std::string(encoded_shape_,
-                                  item_->encoded_shape_size));
-    encoded_shape_ = nullptr;
+// Get a reference to the name at the specified index.
+boost::string_ref EdgeInfo::GetNameRef(uint8_t index) const {
+  uint32_t offset = GetStreetNameOffset(index);
+  if (offset < names_list_length_) {
+    const char* name = names_list_ + offset;
+    return boost::string_ref(name, strnlen(name, names_list_length_ - offset));
   }
+  throw std::runtime_error("GetNameRef: offset exceeds size of text list");
+}
 
-  //hand it back
-  return shape_;
+// Get references to the names
+void EdgeInfo::GetNameRefs(std::vector<boost::string_ref>& names) const {
+  names.clear();
+  for (uint32_t i = 0; i < name_count(); i++) {
+    names.push_back(GetNameRef(i));
+  }
 }
 
-// Returns the encoded shape string
-std::string EdgeInfo::encoded_shape() const {
-  if (encoded_shape_ == nullptr) {
-    return midgard::encode(shape_);
+// Get the encoded shape bytes within the tile.
+midgard::iterable_t<const char> EdgeInfo::encoded_shape_span() const {
+  return {encoded_shape_, encoded_shape_ + item_->encoded_shape_size};
+}
+
+// Get the quantized shape within the tile.
+midgard::iterable_t<const int32_t> EdgeInfo::quantized_shape() const {
+  return {quantized_shape_, quantized_count_ * 2};
+}
+
+// Decode the shape into the caller's buffer. Reads the tile bytes directly
+// rather than copying them into a string first.
+void EdgeInfo::DecodeShape(std::vector<PointLL>& shape) const {
+  shape.clear();
+  if (quantized_shape_ != nullptr) {
+    QuantizedShapes::Dequantize(quantized_shape_, quantized_count_, shape);
   } else {
-    return std::string(encoded_shape_, item_->encoded_shape_size);
+    DecodePolyline(encoded_shape_, item_->encoded_shape_size, shape);
   }
 }
 
+// Returns shape as a vector of PointLL
+std::vector<PointLL> EdgeInfo::shape() const {
+  std::vector<PointLL> shape;
+  DecodeShape(shape);
+  return shape;
+}
+
+// Returns the encoded shape string
+std::string EdgeInfo::encoded_shape() const {
+  return std::string(encoded_shape_, item_->encoded_shape_size);
+}
+
 json::MapPtr EdgeInfo::json() const {
   return json::map({
     {"way_id", static_cast<uint64_t>(wayid_)},
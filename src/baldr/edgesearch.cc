@@ -0,0 +1,146 @@
+#include "baldr/edgesearch.h"
+#include "baldr/localprojection.h"
+#include <valhalla/midgard/aabb2.h>
+#include <valhalla/midgard/constants.h>
+#include <valhalla/midgard/tiles.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+using namespace valhalla::midgard;
+using namespace valhalla::baldr;
+
+namespace {
+
+bool closer(const NearestEdge& a, const NearestEdge& b) {
+  return (a.distance < b.distance) ||
+         (a.distance == b.distance && a.edge.id < b.edge.id);
+}
+
+}
+
+namespace valhalla {
+namespace baldr {
+
+// Find the directed edges nearest to a location.
+std::vector<NearestEdge> FindNearestEdges(GraphReader& reader, const PointLL& ll,
+                                          const float radius, const size_t k,
+                                          const uint32_t access) {
+  return EdgeSearcher(reader).Find(ll, radius, k, access);
+}
+
+// Constructor
+EdgeSearcher::EdgeSearcher(GraphReader& reader)
+    : reader_(reader) {
+}
+
+// Find the directed edges nearest to a location, reusing decoded shapes.
+std::vector<NearestEdge> EdgeSearcher::Find(const PointLL& ll, const float radius,
+                                            const size_t k, const uint32_t access) {
+  std::vector<NearestEdge> candidates;
+  const auto& hierarchy = reader_.GetTileHierarchy();
+  if (k == 0 || radius < 0.0f || hierarchy.levels().empty()) {
+    return candidates;
+  }
+
+  // Bounding box of the search radius, clamped to the tiling
+  const auto& level = hierarchy.levels().rbegin()->second;
+  const auto& tiles = level.tiles;
+  const auto& world = tiles.TileBounds();
+  float dlat = radius / kMetersPerDegreeLat;
+  float dlng = dlat / std::max(static_cast<float>(std::cos(ll.lat() * kRadPerDeg)), 0.01f);
+  AABB2<PointLL> box(std::max(ll.lng() - dlng, world.minx()),
+                     std::max(ll.lat() - dlat, world.miny()),
+                     std::min(ll.lng() + dlng, world.maxx()),
+                     std::min(ll.lat() + dlat, world.maxy()));
+  if (box.minx() > box.maxx() || box.miny() > box.maxy()) {
+    return candidates;
+  }
+
+  // Tiles overlapping the box, nearest first
+  LocalProjection projection(ll);
+  std::vector<std::pair<float, int32_t> > tile_ids;
+  for (int32_t row = tiles.Row(box.miny()); row <= tiles.Row(box.maxy()); ++row) {
+    for (int32_t col = tiles.Col(box.minx()); col <= tiles.Col(box.maxx()); ++col) {
+      int32_t tileid = tiles.TileId(col, row);
+      const auto& bounds = tiles.TileBounds(tileid);
+      tile_ids.emplace_back(projection.Distance(bounds.minx(), bounds.miny(), bounds.maxx(), bounds.maxy()),
+                            tileid);
+    }
+  }
+  std::sort(tile_ids.begin(), tile_ids.end());
+
+  std::vector<std::pair<float, GraphId> > nearest;
+  std::unordered_map<uint64_t, ShapeProjection> projections;
+  std::vector<GraphId> searched;
+  float kth_distance = radius;
+  for (const auto& tile_id : tile_ids) {
+    // Stop once the remaining tiles are farther than the k-th nearest edge
+    if (tile_id.first > kth_distance) {
+      break;
+    }
+    GraphId base(tile_id.second, level.level, 0);
+    const GraphTile* tile = reader_.GetGraphTile(base);
+    if (tile == nullptr) {
+      continue;
+    }
+    searched.push_back(base);
+
+    // Only edges closer than the k-th nearest so far can be kept. Both
+    // directions of an edge share its shape so project it once
+    auto& shapes = shapes_[base];
+    tile->FindNearestEdges(ll, k, kth_distance, nearest, access, &shapes);
+    projections.clear();
+    for (const auto& n : nearest) {
+      const GraphId& edge_id = n.second;
+      const DirectedEdge* edge = tile->directededge(edge_id);
+      auto found = projections.find(edge->edgeinfo_offset());
+      if (found == projections.end()) {
+        found = projections.emplace(edge->edgeinfo_offset(),
+                                    projection.Project(shapes[edge->edgeinfo_offset()])).first;
+      }
+      const ShapeProjection& p = found->second;
+
+      // Fraction along and side of street are relative to the direction of
+      // the directed edge (the shape is stored in the forward direction)
+      PathLocation::SideOfStreet sos = PathLocation::NONE;
+      if (p.distance >= kSideOfStreetTolerance && p.along > 0.0f && p.along < 1.0f) {
+        bool left = (p.cross > 0.0f) == edge->forward();
+        sos = left ? PathLocation::LEFT : PathLocation::RIGHT;
+      }
+      float along = edge->forward() ? p.along : 1.0f - p.along;
+      candidates.push_back({PathLocation::PathEdge(edge_id, along, sos), p.distance, p.point});
+    }
+
+    // Keep the k nearest so far
+    if (candidates.size() >= k) {
+      std::nth_element(candidates.begin(), candidates.begin() + (k - 1),
+                       candidates.end(), closer);
+      candidates.erase(candidates.begin() + k, candidates.end());
+      kth_distance = candidates.back().distance;
+    }
+  }
+
+  // Only keep the shapes of the tiles searched for this location so the
+  // kept shapes never outgrow one search
+  for (auto shapes = shapes_.begin(); shapes != shapes_.end(); ) {
+    if (std::find(searched.begin(), searched.end(), shapes->first) == searched.end()) {
+      shapes = shapes_.erase(shapes);
+    } else {
+      ++shapes;
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end(), closer);
+  return candidates;
+}
+
+// Drop the decoded shapes.
+void EdgeSearcher::Clear() {
+  shapes_.clear();
+}
+
+}
+}
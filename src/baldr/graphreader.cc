@@ -1,10 +1,11 @@
 #include "baldr/graphreader.h"
 
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 #include <sys/stat.h>
-#include <boost/filesystem.hpp>
 
 #include <valhalla/midgard/logging.h>
 #include "baldr/connectivity_map.h"
@@ -13,6 +14,19 @@ using namespace valhalla::baldr;
 namespace {
   constexpr size_t DEFAULT_MAX_CACHE_SIZE = 1073741824; //1 gig
   constexpr size_t AVERAGE_TILE_SIZE = 2097152; //2 megs
+
+  //the connectivity map of each tile directory, mapped or built once per process
+  //and shared by all readers. it is made under the lock so concurrent readers
+  //wait for the first one rather than each building their own
+  std::shared_ptr<const connectivity_map_t> shared_connectivity_map(const TileHierarchy& tile_hierarchy) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const connectivity_map_t> > maps;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& map = maps[tile_hierarchy.tile_dir()];
+    if(!map)
+      map = std::make_shared<const connectivity_map_t>(tile_hierarchy);
+    return map;
+  }
 }
 
 namespace valhalla {
@@ -21,6 +35,13 @@ namespace baldr {
 //this constructor delegates to the other
 GraphReader::GraphReader(const boost::property_tree::ptree& pt):tile_hierarchy_(pt), cache_size_(0) {
   max_cache_size_ = pt.get<size_t>("max_cache_size", DEFAULT_MAX_CACHE_SIZE);
+  lazy_tiles_ = pt.get<bool>("lazy_tiles", false);
+  opposing_edge_tables_ = pt.get<bool>("opposing_edge_tables", false);
+
+  // Map the connectivity file now so the first request does not wait for it
+  struct stat buffer;
+  if (stat(connectivity_map_t::file_name(tile_hierarchy_).c_str(), &buffer) == 0)
+    connectivity_map_ = shared_connectivity_map(tile_hierarchy_);
 
   //assume avg of 10 megs per tile
   cache_.reserve(max_cache_size_/AVERAGE_TILE_SIZE);
@@ -31,22 +52,61 @@ bool GraphReader::DoesTileExist(const GraphId& graphid) const {
   return DoesTileExist(tile_hierarchy_, graphid);
 }
 bool GraphReader::DoesTileExist(const TileHierarchy& tile_hierarchy, const GraphId& graphid) {
-  std::string file_location = tile_hierarchy.tile_dir() + "/" +
-    GraphTile::FileSuffix(graphid.Tile_Base(), tile_hierarchy);
+  std::string file_location = tile_hierarchy.tile_path().FullPath(tile_hierarchy.tile_dir(), graphid);
   struct stat buffer;
   return stat(file_location.c_str(), &buffer) == 0;
 }
 
+// Get the tiles that exist on a level of the hierarchy.
+std::vector<GraphId> GraphReader::GetTileSet(const TileHierarchy& tile_hierarchy, const uint8_t level) {
+  auto tiles = tile_hierarchy.tile_path().FindTiles(tile_hierarchy.tile_dir() + '/' + std::to_string(level));
+  tiles.erase(std::remove_if(tiles.begin(), tiles.end(), [level](const GraphId& tile) {
+    return tile.level() != level;
+  }), tiles.end());
+  std::sort(tiles.begin(), tiles.end());
+  return tiles;
+}
+
 bool GraphReader::AreConnected(const GraphId& first, const GraphId& second) const {
-  //singleton is efficient here but does mean we cant reconfigure the tiles on the fly
-  static const connectivity_map_t connectivity_map(this->tile_hierarchy_);
+  //get it the first time when there was no file to map
+  if(!connectivity_map_)
+    connectivity_map_ = shared_connectivity_map(tile_hierarchy_);
 
   //both must be the same color but also neither must be 0
-  auto first_color = connectivity_map.get_color(first.Tile_Base());
-  auto second_color = connectivity_map.get_color(second.Tile_Base());
+  auto first_color = connectivity_map_->get_color(first.Tile_Base());
+  auto second_color = connectivity_map_->get_color(second.Tile_Base());
   return first_color == second_color && first_color != 0;
 }
 
+bool GraphReader::AreConnected(const GraphId& origin, const GraphId& destination, const uint32_t access) {
+  const NodeComponents* origin_components = GetComponents(origin);
+  const NodeComponents* destination_components = GetComponents(destination);
+  if (origin_components != nullptr && destination_components != nullptr) {
+    uint32_t origin_weak = origin_components->weak(origin.id(), access);
+    uint32_t destination_weak = destination_components->weak(destination.id(), access);
+    if (origin_weak != kNoComponent && destination_weak != kNoComponent) {
+      return origin_weak == destination_weak;
+    }
+  }
+  return AreConnected(origin, destination);
+}
+
+// Get the component labels of the nodes of a tile.
+const NodeComponents* GraphReader::GetComponents(const GraphId& graphid) {
+  GraphId base = graphid.Tile_Base();
+  auto found = components_.find(base);
+  if (found == components_.end()) {
+    std::shared_ptr<const NodeComponents> components(
+        new NodeComponents(NodeComponents::FileName(base, tile_hierarchy_)));
+    const GraphTile* tile = GetGraphTile(base);
+    if (tile == nullptr || !components->Matches(*tile)) {
+      components.reset();
+    }
+    found = components_.emplace(base, std::move(components)).first;
+  }
+  return found->second.get();
+}
+
 // Get a pointer to a graph tile object given a GraphId.
 const GraphTile* GraphReader::GetGraphTile(const GraphId& graphid) {
   //TODO: clear the cache automatically once we become overcommitted by a certain amount
@@ -57,7 +117,7 @@ const GraphTile* GraphReader::GetGraphTile(const GraphId& graphid) {
     return &cached->second;
 
   // It wasn't in cache so create a GraphTile object. This reads the tile from disk
-  GraphTile tile(tile_hierarchy_, graphid);
+  GraphTile tile(tile_hierarchy_, graphid, lazy_tiles_);
   // Need to check that the tile could be loaded, if it has no size it wasn't loaded
   if(tile.size() == 0)
     return nullptr;
@@ -75,6 +135,15 @@ const GraphTile* GraphReader::GetGraphTile(const PointLL& pointll){
   return GetGraphTile(pointll, tile_hierarchy_.levels().rbegin()->second.level);
 }
 
+// Add a tile read elsewhere to the cache
+void GraphReader::AddGraphTile(const GraphTile& tile) {
+  if(tile.size() == 0)
+    return;
+  auto inserted = cache_.emplace(tile.id().Tile_Base(), tile);
+  if(inserted.second)
+    cache_size_ += tile.size();
+}
+
 const TileHierarchy& GraphReader::GetTileHierarchy() const {
   return tile_hierarchy_;
 }
@@ -85,6 +154,7 @@ const TileHierarchy& GraphReader::GetTileHierarchy() const {
 void GraphReader::Clear() {
   cache_size_ = 0;
   cache_.clear();
+  components_.clear();
 }
 
 /** Returns true if the cache is over committed with respect to the limit
@@ -101,6 +171,16 @@ GraphId GraphReader::GetOpposingEdgeId(const GraphId& edgeid) {
 }
 GraphId GraphReader::GetOpposingEdgeId(const GraphId& edgeid, const GraphTile*& tile) {
   tile = GetGraphTile(edgeid);
+  if (opposing_edge_tables_ && tile != nullptr) {
+    // Read the opposing edge from the table of the tile
+    GraphId id = tile->GetOpposingEdgeId(*this, edgeid.id());
+    if (!id.Is_Valid()) {
+      tile = nullptr;
+    } else if (id.Tile_Base() != edgeid.Tile_Base()) {
+      tile = GetGraphTile(id);
+    }
+    return id;
+  }
   const auto* directededge = tile->directededge(edgeid);
   GraphId id = directededge->endnode();
   if (directededge->leaves_tile()) {
@@ -1,47 +1,79 @@
 #include "baldr/graphtile.h"
 #include "baldr/datetime.h"
+#include "baldr/graphreader.h"
+#include "baldr/localprojection.h"
+#include "baldr/shapedecoder.h"
+#include "baldr/tilesection.h"
 #include <valhalla/midgard/tiles.h>
 #include <valhalla/midgard/aabb2.h>
 #include <valhalla/midgard/pointll.h>
 #include <valhalla/midgard/logging.h>
+#include <valhalla/midgard/constants.h>
 
 #include <ctime>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <iostream>
 #include <fstream>
-#include <locale>
 #include <iomanip>
 #include <cmath>
-#include <boost/algorithm/string.hpp>
-
-namespace {
-  struct dir_facet : public std::numpunct<char> {
-   protected:
-    virtual char do_thousands_sep() const {
-        return '/';
-    }
-
-    virtual std::string do_grouping() const {
-        return "\03";
-    }
-  };
-  template <class numeric_t>
-  size_t digits(numeric_t number) {
-    size_t digits = (number < 0 ? 1 : 0);
-    while (static_cast<long long int>(number)) {
-        number /= 10;
-        digits++;
-    }
-    return digits;
-  }
-  const std::locale dir_locale(std::locale("C"), new dir_facet());
-  const AABB2<PointLL> world_box(PointLL(-180, -90), PointLL(180, 90));
-}
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <unordered_map>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace valhalla {
 namespace baldr {
 
+// Indexes derived from the tile data on first use
+struct GraphTile::LazyData {
+  // Normalized street name to directed edge indexes
+  std::once_flag name_index_flag;
+  std::unordered_map<std::string, std::vector<uint32_t> > name_index;
+
+  // Spatial index of directed edge shapes (ids are directed edge indexes)
+  std::once_flag rtree_flag;
+  PackedRTree rtree;
+
+  // Routing core of the directed edges (indexed like the directed edges)
+  std::once_flag edgecore_flag;
+  std::vector<EdgeCore> edgecores;
+
+  // Expansion attributes of the nodes (indexed like the nodes)
+  std::once_flag nodecore_flag;
+  std::vector<NodeCore> nodecores;
+
+  // Directed edges leaving the tile grouped by the tile they lead into.
+  // The edges into boundary_tiles[i] are boundary_edges[offsets[i]] up to
+  // boundary_edges[offsets[i + 1]].
+  std::once_flag boundary_flag;
+  std::vector<GraphId> boundary_tiles;
+  std::vector<uint32_t> boundary_offsets;
+  std::vector<uint32_t> boundary_edges;
+
+  // Fingerprint of the tile
+  std::once_flag fingerprint_flag;
+  uint64_t fingerprint = 0;
+
+  // Opposing directed edge of each directed edge. Edges within the tile are
+  // filled under opposing_flag, the edges into boundary_tiles[i] under
+  // opposing_flags[i] when first needed
+  std::once_flag opposing_flag;
+  std::unique_ptr<std::once_flag[]> opposing_flags;
+  std::vector<GraphId> opposing;
+
+  // Edge costs by access mask. Entries are never removed so references
+  // stay valid.
+  std::mutex edgecosts_mutex;
+  std::unordered_map<uint32_t, std::unique_ptr<EdgeCosts> > edgecosts;
+};
+
 // Default constructor
 GraphTile::GraphTile()
     : size_(0),
@@ -63,101 +95,308 @@ GraphTile::GraphTile()
 }
 
 // Constructor given a filename. Reads the graph data into memory.
-GraphTile::GraphTile(const TileHierarchy& hierarchy, const GraphId& graphid)
+GraphTile::GraphTile(const TileHierarchy& hierarchy, const GraphId& graphid,
+                     const bool lazy)
     : size_(0) {
 
   // Don't bother with invalid ids
   if (!graphid.Is_Valid())
     return;
 
+  // Read or map the file into memory
+  std::string file_location = hierarchy.tile_path().FullPath(hierarchy.tile_dir(), graphid);
+  char* ptr = nullptr;
+  size_t filesize = lazy ? MapFile(file_location, ptr) : ReadFile(file_location, ptr);
+  if (ptr == nullptr) {
+    return;
+  }
+  if (filesize < sizeof(GraphTileHeader)) {
+    LOG_ERROR("Tile " + file_location + " is too small to hold a header");
+    graphtile_.reset();
+    return;
+  }
+
+  // Set a pointer to the header (first structure in the binary data) and
+  // locate the sections according to the format version
+  header_ = reinterpret_cast<GraphTileHeader*>(ptr);
+  bool loaded = false;
+  switch (header_->format_version()) {
+    case kTileFormatV1:
+      loaded = SetSectionsV1(filesize);
+      break;
+    case kTileFormatV2:
+      loaded = SetSectionsV2(filesize);
+      break;
+    default:
+      LOG_ERROR("Tile " + file_location + " has unsupported format version " +
+                std::to_string(header_->format_version()));
+  }
+  if (!loaded) {
+    LOG_ERROR("Tile " + file_location + " could not be loaded");
+    graphtile_.reset();
+    return;
+  }
+
+  // Start reading the routing core of a mapped tile now. Sections are
+  // otherwise only read when a page of them is first touched.
+  if (lazy) {
+    size_t core = sizeof(GraphTileHeader);
+    if (header_->nodecount() > 0) {
+      core = std::max(core, static_cast<size_t>(
+          reinterpret_cast<char*>(nodes_ + header_->nodecount()) - ptr));
+    }
+    if (header_->directededgecount() > 0) {
+      core = std::max(core, static_cast<size_t>(
+          reinterpret_cast<char*>(directededges_ + header_->directededgecount()) - ptr));
+    }
+    madvise(ptr, core, MADV_WILLNEED);
+  }
+  BuildTransferIndex();
+
+  // Derived indexes are built on first use
+  lazy_ = std::make_shared<LazyData>();
+
+  // Set the size to indicate success
+  size_ = filesize;
+}
+
+// Read a tile file into memory. Sections of version 2 tiles are aligned to
+// cache lines relative to the start of the tile, so the start is aligned.
+size_t GraphTile::ReadFile(const std::string& file_location, char*& ptr) {
   // Open to the end of the file so we can immediately get size;
-  std::string file_location = hierarchy.tile_dir() + "/" +
-                FileSuffix(graphid.Tile_Base(), hierarchy);
   std::ifstream file(file_location, std::ios::in | std::ios::binary | std::ios::ate);
-  if (file.is_open()) {
-    // Read binary file into memory. TODO - protect against failure to
-    // allocate memory
-    size_t filesize = file.tellg();
-    graphtile_.reset(new char[filesize]);
-    file.seekg(0, std::ios::beg);
-    file.read(graphtile_.get(), filesize);
-    file.close();
-
-    // Set a pointer to the header (first structure in the binary data).
-    char* ptr = graphtile_.get();
-    header_ = reinterpret_cast<GraphTileHeader*>(ptr);
-    ptr += sizeof(GraphTileHeader);
-
-    // TODO check version
-
-    // Set a pointer to the node list
-    nodes_ = reinterpret_cast<NodeInfo*>(ptr);
-    ptr += header_->nodecount() * sizeof(NodeInfo);
-
-    // Set a pointer to the directed edge list
-    directededges_ = reinterpret_cast<DirectedEdge*>(ptr);
-    ptr += header_->directededgecount() * sizeof(DirectedEdge);
-
-    // Set a pointer to the transit departure list
-    departures_ = reinterpret_cast<TransitDeparture*>(ptr);
-    ptr += header_->departurecount() * sizeof(TransitDeparture);
-
-    // Set a pointer to the transit stop list
-    transit_stops_ = reinterpret_cast<TransitStop*>(ptr);
-    ptr += header_->stopcount() * sizeof(TransitStop);
-
-    // Set a pointer to the transit route list
-    transit_routes_ = reinterpret_cast<TransitRoute*>(ptr);
-    ptr += header_->routecount() * sizeof(TransitRoute);
-
-    // Set a pointer to the transit transfer list
-    transit_transfers_ = reinterpret_cast<TransitTransfer*>(ptr);
-    ptr += header_->transfercount() * sizeof(TransitTransfer);
-
-    // Set a pointer access restriction list
-    access_restrictions_ = reinterpret_cast<AccessRestriction*>(ptr);
-    ptr += header_->access_restriction_count() * sizeof(AccessRestriction);
-
-/*
-LOG_INFO("Tile: " + std::to_string(graphid.tileid()) + "," + std::to_string(graphid.level()));
-LOG_INFO("Departures: " + std::to_string(header_->departurecount()) +
-         " Stops: " + std::to_string(header_->stopcount()) +
-         " Routes: " + std::to_string(header_->routecount()) +
-         " Transfers: " + std::to_string(header_->transfercount()) +
-         " Exceptions: " + std::to_string(header_->calendarcount()));
-    */
-
-    // Set a pointer to the sign list
-    signs_ = reinterpret_cast<Sign*>(ptr);
-    ptr += header_->signcount() * sizeof(Sign);
-
-    // Set a pointer to the admininstrative information list
-    admins_ = reinterpret_cast<Admin*>(ptr);
-    ptr += header_->admincount() * sizeof(Admin);
-
-    // Set a pointer to the edge cell list
-    edge_cells_ = reinterpret_cast<GraphId*>(ptr);
-    ptr += header_->cell_offset(kGridDim - 1, kGridDim - 1).second * sizeof(GraphId);
-
-    // Start of edge information and its size
-    edgeinfo_ = graphtile_.get() + header_->edgeinfo_offset();
-    edgeinfo_size_ = header_->textlist_offset() - header_->edgeinfo_offset();
-
-    // Start of text list and its size
-    textlist_ = graphtile_.get() + header_->textlist_offset();
+  if (!file.is_open()) {
+    LOG_DEBUG("Tile " + file_location + " was not found");
+    return 0;
+  }
+
+  // TODO - protect against failure to allocate memory
+  size_t filesize = file.tellg();
+  graphtile_.reset(new char[filesize + kTileSectionAlignment]);
+  ptr = graphtile_.get();
+  ptr += (kTileSectionAlignment - reinterpret_cast<uintptr_t>(ptr) % kTileSectionAlignment) %
+         kTileSectionAlignment;
+  file.seekg(0, std::ios::beg);
+  file.read(ptr, filesize);
+  return filesize;
+}
+
+// Map a tile file into memory, read only. Pages are read on first access
+// without read ahead, so sections that are never used are never read.
+size_t GraphTile::MapFile(const std::string& file_location, char*& ptr) {
+  int fd = open(file_location.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG_DEBUG("Tile " + file_location + " was not found");
+    return 0;
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0 || status.st_size == 0) {
+    LOG_ERROR("Tile " + file_location + " is empty");
+    close(fd);
+    return 0;
+  }
+  size_t filesize = status.st_size;
+  void* mapped = mmap(nullptr, filesize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    LOG_ERROR("Tile " + file_location + " could not be mapped");
+    return 0;
+  }
+  madvise(mapped, filesize, MADV_RANDOM);
+  ptr = static_cast<char*>(mapped);
+  graphtile_.reset(ptr, [filesize](char* p) { munmap(p, filesize); });
+  return filesize;
+}
+
+// Locate the sections of a version 1 tile: the sections follow the header
+// in a fixed order, their sizes given by the record counts.
+bool GraphTile::SetSectionsV1(const size_t filesize) {
+  char* base = reinterpret_cast<char*>(header_);
+  char* ptr = base + sizeof(GraphTileHeader);
+
+  // Set a pointer to the node list
+  nodes_ = reinterpret_cast<NodeInfo*>(ptr);
+  ptr += header_->nodecount() * sizeof(NodeInfo);
+
+  // Set a pointer to the directed edge list
+  directededges_ = reinterpret_cast<DirectedEdge*>(ptr);
+  ptr += header_->directededgecount() * sizeof(DirectedEdge);
+
+  // Set a pointer to the transit departure list
+  departures_ = reinterpret_cast<TransitDeparture*>(ptr);
+  ptr += header_->departurecount() * sizeof(TransitDeparture);
+
+  // Set a pointer to the transit stop list
+  transit_stops_ = reinterpret_cast<TransitStop*>(ptr);
+  ptr += header_->stopcount() * sizeof(TransitStop);
+
+  // Set a pointer to the transit route list
+  transit_routes_ = reinterpret_cast<TransitRoute*>(ptr);
+  ptr += header_->routecount() * sizeof(TransitRoute);
+
+  // Set a pointer to the transit transfer list
+  transit_transfers_ = reinterpret_cast<TransitTransfer*>(ptr);
+  ptr += header_->transfercount() * sizeof(TransitTransfer);
+
+  // Set a pointer access restriction list
+  access_restrictions_ = reinterpret_cast<AccessRestriction*>(ptr);
+  ptr += header_->access_restriction_count() * sizeof(AccessRestriction);
+
+  // Set a pointer to the sign list
+  signs_ = reinterpret_cast<Sign*>(ptr);
+  ptr += header_->signcount() * sizeof(Sign);
+
+  // Set a pointer to the admininstrative information list
+  admins_ = reinterpret_cast<Admin*>(ptr);
+  ptr += header_->admincount() * sizeof(Admin);
+
+  // Set a pointer to the edge cell list
+  edge_cells_ = reinterpret_cast<GraphId*>(ptr);
+  ptr += header_->cell_offset(kGridDim - 1, kGridDim - 1).second * sizeof(GraphId);
+
+  // Start of edge information and its size
+  edgeinfo_ = base + header_->edgeinfo_offset();
+  edgeinfo_size_ = header_->textlist_offset() - header_->edgeinfo_offset();
+
+  // Start of text list and its size. The optional quantized shapes are
+  // stored after the text list.
+  textlist_ = base + header_->textlist_offset();
+  uint32_t quantized_offset = header_->quantized_shape_offset();
+  if (quantized_offset > header_->textlist_offset() && quantized_offset < filesize &&
+      quantized_offset % sizeof(int32_t) == 0) {
+    textlist_size_ = quantized_offset - header_->textlist_offset();
+    quantized_shapes_ = QuantizedShapes(base + quantized_offset,
+                                        filesize - quantized_offset);
+  } else {
+    if (quantized_offset != 0) {
+      LOG_ERROR("Invalid quantized shape offset, ignoring quantized shapes");
+    }
     textlist_size_ = filesize - header_->textlist_offset();
+  }
+  return true;
+}
 
-    // Set the size to indicate success
-    size_ = filesize;
+// Locate the sections of a version 2 tile from its table of contents.
+bool GraphTile::SetSectionsV2(const size_t filesize) {
+  char* base = reinterpret_cast<char*>(header_);
+  size_t count = header_->section_count();
+  if (sizeof(GraphTileHeader) + count * sizeof(TileSection) > filesize) {
+    LOG_ERROR("Tile table of contents exceeds the tile size");
+    return false;
   }
-  else {
-    LOG_DEBUG("Tile " + file_location + " was not found");
+
+  // Find each known section, checking it lies within the tile
+  const TileSection* toc = reinterpret_cast<const TileSection*>(base + sizeof(GraphTileHeader));
+  std::unordered_map<uint32_t, std::pair<char*, size_t> > sections;
+  for (size_t i = 0; i < count; ++i) {
+    const TileSection& section = toc[i];
+    if (section.offset > filesize || section.size > filesize - section.offset ||
+        (section.alignment != 0 && section.offset % section.alignment != 0)) {
+      LOG_ERROR("Invalid tile section " + std::to_string(section.type));
+      return false;
+    }
+    sections[section.type] = std::make_pair(base + section.offset, section.size);
+  }
+
+  // Fixed size records must match the record counts in the header
+  bool valid = true;
+  auto records = [&sections, &valid](const TileSection::Type type, const size_t count,
+                                     const size_t record_size) -> char* {
+    auto found = sections.find(static_cast<uint32_t>(type));
+    size_t size = (found == sections.end()) ? 0 : found->second.second;
+    if (size != count * record_size) {
+      LOG_ERROR("Tile section " + std::to_string(static_cast<uint32_t>(type)) +
+                " size does not match the record count");
+      valid = false;
+    }
+    return (found == sections.end()) ? nullptr : found->second.first;
+  };
+  nodes_ = reinterpret_cast<NodeInfo*>(records(TileSection::Type::kNodes,
+      header_->nodecount(), sizeof(NodeInfo)));
+  directededges_ = reinterpret_cast<DirectedEdge*>(records(TileSection::Type::kDirectedEdges,
+      header_->directededgecount(), sizeof(DirectedEdge)));
+  departures_ = reinterpret_cast<TransitDeparture*>(records(TileSection::Type::kDepartures,
+      header_->departurecount(), sizeof(TransitDeparture)));
+  transit_stops_ = reinterpret_cast<TransitStop*>(records(TileSection::Type::kTransitStops,
+      header_->stopcount(), sizeof(TransitStop)));
+  transit_routes_ = reinterpret_cast<TransitRoute*>(records(TileSection::Type::kTransitRoutes,
+      header_->routecount(), sizeof(TransitRoute)));
+  transit_transfers_ = reinterpret_cast<TransitTransfer*>(records(TileSection::Type::kTransitTransfers,
+      header_->transfercount(), sizeof(TransitTransfer)));
+  access_restrictions_ = reinterpret_cast<AccessRestriction*>(records(TileSection::Type::kAccessRestrictions,
+      header_->access_restriction_count(), sizeof(AccessRestriction)));
+  signs_ = reinterpret_cast<Sign*>(records(TileSection::Type::kSigns,
+      header_->signcount(), sizeof(Sign)));
+  admins_ = reinterpret_cast<Admin*>(records(TileSection::Type::kAdmins,
+      header_->admincount(), sizeof(Admin)));
+  edge_cells_ = reinterpret_cast<GraphId*>(records(TileSection::Type::kEdgeCells,
+      header_->cell_offset(kGridDim - 1, kGridDim - 1).second, sizeof(GraphId)));
+  if (!valid) {
+    return false;
+  }
+
+  // Variable size sections. Edge info and names are read without checking
+  // for them so every tile has them, even if empty
+  auto edgeinfo = sections.find(static_cast<uint32_t>(TileSection::Type::kEdgeInfo));
+  auto textlist = sections.find(static_cast<uint32_t>(TileSection::Type::kTextList));
+  if (edgeinfo == sections.end() || textlist == sections.end()) {
+    LOG_ERROR("Tile has no edge info or text list section");
+    return false;
   }
+  edgeinfo_ = edgeinfo->second.first;
+  edgeinfo_size_ = edgeinfo->second.second;
+  textlist_ = textlist->second.first;
+  textlist_size_ = textlist->second.second;
+  auto quantized = sections.find(static_cast<uint32_t>(TileSection::Type::kQuantizedShapes));
+  if (quantized != sections.end()) {
+    quantized_shapes_ = QuantizedShapes(quantized->second.first, quantized->second.second);
+  }
+  return true;
 }
 
 GraphTile::~GraphTile() {
 }
 
+// Build the compressed sparse row index of transfers by from stop Id.
+void GraphTile::BuildTransferIndex() {
+  transfer_offsets_.clear();
+  sorted_transfers_.reset();
+  uint32_t count = header_->transfercount();
+  if (count == 0) {
+    return;
+  }
+
+  // Transfers are expected to be sorted by from stop Id and then to stop Id
+  // (see TransitTransfer::operator <). If they are not, sort a copy rather
+  // than the tile data, which may be mapped from the file.
+  if (!std::is_sorted(transit_transfers_, transit_transfers_ + count)) {
+    sorted_transfers_ = std::make_shared<std::vector<TransitTransfer> >(
+        transit_transfers_, transit_transfers_ + count);
+    std::sort(sorted_transfers_->begin(), sorted_transfers_->end());
+    transit_transfers_ = sorted_transfers_->data();
+  }
+
+  // Offsets are indexed by stop Id. Transfers from a stop Id past the
+  // stops of this tile sort last and are left out of the index.
+  uint32_t nstops = header_->stopcount();
+  transfer_offsets_.resize(nstops + 1, 0);
+  uint32_t ignored = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    if (transit_transfers_[i].from_stopid() < nstops) {
+      transfer_offsets_[transit_transfers_[i].from_stopid() + 1]++;
+    } else {
+      ignored++;
+    }
+  }
+  if (ignored > 0) {
+    LOG_WARN("Ignoring " + std::to_string(ignored) + " transfers from invalid stop Ids in tile " +
+             std::to_string(header_->graphid().value));
+  }
+  for (uint32_t i = 1; i <= nstops; i++) {
+    transfer_offsets_[i] += transfer_offsets_[i-1];
+  }
+}
+
 std::string GraphTile::FileSuffix(const GraphId& graphid, const TileHierarchy& hierarchy) {
   /*
   if you have a graphid where level == 8 and tileid == 24134109851
@@ -169,34 +408,7 @@ std::string GraphTile::FileSuffix(const GraphId& graphid, const TileHierarchy& h
   unique part of filename first) because there will be just so few
   objects in general in practice
   */
-
-  //figure the largest id for this level
-  const auto level = hierarchy.levels().find(graphid.level());
-  if(level == hierarchy.levels().end())
-    throw std::runtime_error("Could not compute FileSuffix for non-existent level");
-  const uint32_t max_id = Tiles<PointLL>::MaxTileId(world_box, level->second.tiles.TileSize());
-
-  //figure out how many digits
-  //TODO: dont convert it to a string to get the length there are faster ways..
-  size_t max_length = digits<uint32_t>(max_id);
-  const size_t remainder = max_length % 3;
-  if(remainder)
-    max_length += 3 - remainder;
-
-  //make a locale to use as a formatter for numbers
-  std::ostringstream stream;
-  stream.imbue(dir_locale);
-
-  //if it starts with a zero the pow trick doesn't work
-  if(graphid.level() == 0) {
-    stream << static_cast<uint32_t>(std::pow(10, max_length)) + graphid.tileid() << ".gph";
-    std::string suffix = stream.str();
-    suffix[0] = '0';
-    return suffix;
-  }
-  //it was something else
-  stream << graphid.level() * static_cast<uint32_t>(std::pow(10, max_length)) + graphid.tileid() << ".gph";
-  return stream.str();
+  return hierarchy.tile_path().Path(graphid);
 }
 
 // Get the tile Id given the full path to the file.
@@ -205,31 +417,12 @@ GraphId GraphTile::GetTileId(const std::string& fname, const TileHierarchy& hier
   auto pos = fname.find(hierarchy.tile_dir());
   if(pos == std::string::npos)
     throw std::runtime_error("File name for tile does not match hierarchy root dir");
-  auto name = fname.substr(pos + hierarchy.tile_dir().size());
-  boost::algorithm::trim_if(name, boost::is_any_of("/.gph"));
-
-  //split on slash
-  std::vector<std::string> tokens;
-  boost::split(tokens, name, boost::is_any_of("/"));
 
-  //need at least level and id
-  if(tokens.size() < 2)
+  //the level and id are in the last few directories
+  GraphId id = hierarchy.tile_path().Parse(fname.data(), fname.size());
+  if(!id.Is_Valid())
     throw std::runtime_error("Invalid tile path");
-
-  // Compute the Id
-  uint32_t id = 0;
-  uint32_t multiplier = std::pow(1000, tokens.size() - 2);
-  bool first = true;
-  for(const auto& token : tokens) {
-    if(first) {
-      first = false;
-      continue;
-    }
-    id += std::atoi(token.c_str()) * multiplier;
-    multiplier /= 1000;
-  }
-  uint32_t level = std::atoi(tokens.front().c_str());
-  return {id, level, 0};
+  return id;
 }
 
 // Get the bounding box of this graph tile.
@@ -242,6 +435,33 @@ size_t GraphTile::size() const {
   return size_;
 }
 
+// Get a fingerprint of the tile, computed on first use
+uint64_t GraphTile::fingerprint() const {
+  if (!lazy_) {
+    return 0;
+  }
+  std::call_once(lazy_->fingerprint_flag, [this]() {
+    // FNV-1a over 8 bytes at a time, seeded with the tile size
+    uint64_t hash = 14695981039346656037ULL ^ size_;
+    auto add = [&hash](const char* data, const size_t size) {
+      size_t i = 0;
+      for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ULL;
+      }
+      for (; i < size; i++) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+      }
+    };
+    add(reinterpret_cast<const char*>(nodes_), header_->nodecount() * sizeof(NodeInfo));
+    add(reinterpret_cast<const char*>(directededges_),
+        header_->directededgecount() * sizeof(DirectedEdge));
+    lazy_->fingerprint = hash;
+  });
+  return lazy_->fingerprint;
+}
+
 GraphId GraphTile::id() const {
   return header_->graphid();
 }
@@ -270,6 +490,36 @@ const NodeInfo* GraphTile::node(const size_t idx) const {
                            std::to_string(header_->nodecount()));
 }
 
+// Get the expansion attributes of the nodes, built on first use
+midgard::iterable_t<const NodeCore> GraphTile::GetNodeCores() const {
+  if (!lazy_) {
+    return midgard::iterable_t<const NodeCore>(nullptr, nullptr);
+  }
+  std::call_once(lazy_->nodecore_flag, [this]() {
+    lazy_->nodecores.reserve(header_->nodecount());
+    for (uint32_t idx = 0; idx < header_->nodecount(); idx++) {
+      lazy_->nodecores.emplace_back(nodes_[idx]);
+    }
+  });
+  return midgard::iterable_t<const NodeCore>(lazy_->nodecores.data(),
+                                             lazy_->nodecores.size());
+}
+
+const NodeCore* GraphTile::nodecore(const GraphId& node) const {
+  return nodecore(static_cast<size_t>(node.id()));
+}
+
+const NodeCore* GraphTile::nodecore(const size_t idx) const {
+  auto nodecores = GetNodeCores();
+  if (idx < nodecores.size())
+    return nodecores.begin() + idx;
+  throw std::runtime_error("GraphTile NodeCore index out of bounds: " +
+                           std::to_string(header_->graphid().tileid()) + "," +
+                           std::to_string(header_->graphid().level()) + "," +
+                           std::to_string(idx)  + " nodecount= " +
+                           std::to_string(header_->nodecount()));
+}
+
 // Get the directed edge given a GraphId
 const DirectedEdge* GraphTile::directededge(const GraphId& edge) const {
   if (edge.id() < header_->directededgecount())
@@ -293,8 +543,36 @@ const DirectedEdge* GraphTile::directededge(const size_t idx) const {
                            std::to_string(header_->directededgecount()));
 }
 
-std::unique_ptr<const EdgeInfo> GraphTile::edgeinfo(const size_t offset) const {
-  return std::unique_ptr<EdgeInfo>(new EdgeInfo(edgeinfo_ + offset, textlist_, textlist_size_));
+EdgeInfo GraphTile::edgeinfo(const size_t offset) const {
+  if (!quantized_shapes_.empty()) {
+    auto quantized = quantized_shapes_.find(offset);
+    if (quantized.size() > 0) {
+      return EdgeInfo(edgeinfo_ + offset, textlist_, textlist_size_,
+                      quantized.begin(), quantized.size() / 2);
+    }
+  }
+  return EdgeInfo(edgeinfo_ + offset, textlist_, textlist_size_);
+}
+
+// Decode the shapes of many edges at once.
+void GraphTile::DecodeShapes(const std::vector<uint32_t>& edgeinfo_offsets,
+                             std::vector<PointLL>& shapes,
+                             std::vector<uint32_t>& offsets) const {
+  shapes.clear();
+  offsets.clear();
+  offsets.reserve(edgeinfo_offsets.size() + 1);
+  for (const auto offset : edgeinfo_offsets) {
+    offsets.push_back(shapes.size());
+    auto ei = edgeinfo(offset);
+    auto quantized = ei.quantized_shape();
+    if (quantized.size() > 0) {
+      QuantizedShapes::Dequantize(quantized.begin(), quantized.size() / 2, shapes);
+    } else {
+      auto encoded = ei.encoded_shape_span();
+      DecodePolyline(encoded.begin(), encoded.size(), shapes);
+    }
+  }
+  offsets.push_back(shapes.size());
 }
 
 // Get the directed edges outbound from the specified node index.
@@ -307,10 +585,252 @@ const DirectedEdge* GraphTile::GetDirectedEdges(const uint32_t node_index,
   return directededge(nodeinfo->edge_index());
 }
 
+// Get the routing core of the directed edges, built on first use
+midgard::iterable_t<const EdgeCore> GraphTile::GetEdgeCores() const {
+  if (!lazy_) {
+    return midgard::iterable_t<const EdgeCore>(nullptr, nullptr);
+  }
+  std::call_once(lazy_->edgecore_flag, [this]() {
+    lazy_->edgecores.reserve(header_->directededgecount());
+    for (uint32_t idx = 0; idx < header_->directededgecount(); idx++) {
+      lazy_->edgecores.emplace_back(directededges_[idx]);
+    }
+  });
+  return midgard::iterable_t<const EdgeCore>(lazy_->edgecores.data(),
+                                             lazy_->edgecores.size());
+}
+
+// Get the routing core of the directed edges originating at a node
+const EdgeCore* GraphTile::GetEdgeCores(const uint32_t node_index,
+                                        uint32_t& count,
+                                        uint32_t& edge_index) const {
+  const NodeCore* nodeinfo = nodecore(node_index);
+  count = nodeinfo->edge_count();
+  edge_index = nodeinfo->edge_index();
+  auto edgecores = GetEdgeCores();
+  if (edge_index + count > edgecores.size()) {
+    throw std::runtime_error("GraphTile EdgeCore index out of bounds: " +
+                             std::to_string(header_->graphid().tileid()) + "," +
+                             std::to_string(header_->graphid().level()) + "," +
+                             std::to_string(edge_index) + " directededgecount= " +
+                             std::to_string(header_->directededgecount()));
+  }
+  return edgecores.begin() + edge_index;
+}
+
+// Get the travel time and accessibility of the directed edges for a travel
+// mode, computed on first request and cached
+const EdgeCosts& GraphTile::GetEdgeCosts(const uint32_t access) const {
+  static const EdgeCosts kNoCosts(nullptr, 0, 0);
+  if (!lazy_) {
+    return kNoCosts;
+  }
+  std::lock_guard<std::mutex> lock(lazy_->edgecosts_mutex);
+  auto& costs = lazy_->edgecosts[access];
+  if (!costs) {
+    costs.reset(new EdgeCosts(directededges_, header_->directededgecount(), access));
+  }
+  return *costs;
+}
+
+// Group the directed edges that leave the tile by the tile they lead into
+void GraphTile::BuildBoundaryEdges() const {
+  std::call_once(lazy_->boundary_flag, [this]() {
+    std::vector<std::pair<uint64_t, uint32_t> > boundary;
+    GraphId base = id().Tile_Base();
+    for (uint32_t idx = 0; idx < header_->directededgecount(); idx++) {
+      GraphId end_tile = directededges_[idx].endnode().Tile_Base();
+      if (end_tile != base) {
+        boundary.emplace_back(end_tile.value, idx);
+      }
+    }
+    std::sort(boundary.begin(), boundary.end());
+    lazy_->boundary_edges.reserve(boundary.size());
+    for (const auto& edge : boundary) {
+      if (lazy_->boundary_tiles.empty() || lazy_->boundary_tiles.back().value != edge.first) {
+        lazy_->boundary_tiles.emplace_back(edge.first);
+        lazy_->boundary_offsets.push_back(lazy_->boundary_edges.size());
+      }
+      lazy_->boundary_edges.push_back(edge.second);
+    }
+    lazy_->boundary_offsets.push_back(lazy_->boundary_edges.size());
+  });
+}
+
+// Get the tiles that directed edges of this tile lead into
+const std::vector<GraphId>& GraphTile::GetBoundaryTiles() const {
+  static const std::vector<GraphId> kNoTiles;
+  if (!lazy_) {
+    return kNoTiles;
+  }
+  BuildBoundaryEdges();
+  return lazy_->boundary_tiles;
+}
+
+// Get the directed edges of this tile that lead into another tile
+midgard::iterable_t<const uint32_t> GraphTile::GetBoundaryEdges(const GraphId& tile) const {
+  const auto& tiles = GetBoundaryTiles();
+  auto found = std::lower_bound(tiles.begin(), tiles.end(), tile.Tile_Base());
+  if (found == tiles.end() || *found != tile.Tile_Base()) {
+    return midgard::iterable_t<const uint32_t>(nullptr, nullptr);
+  }
+  size_t i = found - tiles.begin();
+  return midgard::iterable_t<const uint32_t>(
+      lazy_->boundary_edges.data() + lazy_->boundary_offsets[i],
+      lazy_->boundary_edges.data() + lazy_->boundary_offsets[i + 1]);
+}
+
+// Build the opposing edges of the edges ending within this tile. Edges
+// into other tiles are resolved per tile by ResolveOpposingEdges
+void GraphTile::BuildOpposingEdges() const {
+  std::call_once(lazy_->opposing_flag, [this]() {
+    lazy_->opposing.resize(header_->directededgecount());
+    GraphId base = id().Tile_Base();
+    for (uint32_t idx = 0; idx < header_->directededgecount(); idx++) {
+      const DirectedEdge& edge = directededges_[idx];
+      GraphId endnode = edge.endnode();
+      if (endnode.Tile_Base() == base && endnode.id() < header_->nodecount()) {
+        lazy_->opposing[idx] = GraphId(endnode.tileid(), endnode.level(),
+            node(endnode)->edge_index() + edge.opp_index());
+      }
+    }
+    lazy_->opposing_flags.reset(new std::once_flag[GetBoundaryTiles().size()]);
+  });
+}
+
+// Resolve the opposing edges of the edges into a boundary tile, loading
+// that tile the first time
+void GraphTile::ResolveOpposingEdges(GraphReader& reader, const size_t boundary) const {
+  std::call_once(lazy_->opposing_flags[boundary], [this, &reader, boundary]() {
+    const GraphTile* end_tile = reader.GetGraphTile(lazy_->boundary_tiles[boundary]);
+    if (end_tile == nullptr) {
+      return;
+    }
+    for (uint32_t i = lazy_->boundary_offsets[boundary];
+         i < lazy_->boundary_offsets[boundary + 1]; i++) {
+      uint32_t idx = lazy_->boundary_edges[i];
+      const DirectedEdge& edge = directededges_[idx];
+      GraphId endnode = edge.endnode();
+      if (endnode.id() < end_tile->header()->nodecount()) {
+        lazy_->opposing[idx] = GraphId(endnode.tileid(), endnode.level(),
+            end_tile->node(endnode)->edge_index() + edge.opp_index());
+      }
+    }
+  });
+}
+
+// Get the opposing directed edge of a directed edge, resolving only the
+// tile it ends in
+GraphId GraphTile::GetOpposingEdgeId(GraphReader& reader, const uint32_t idx) const {
+  if (!lazy_ || idx >= header_->directededgecount()) {
+    throw std::runtime_error("GraphTile opposing edge index out of bounds: " +
+                             std::to_string(header_->graphid().tileid()) + "," +
+                             std::to_string(header_->graphid().level()) + "," +
+                             std::to_string(idx) + " directededgecount= " +
+                             std::to_string(header_->directededgecount()));
+  }
+  BuildOpposingEdges();
+  GraphId end_tile = directededges_[idx].endnode().Tile_Base();
+  if (end_tile != id().Tile_Base()) {
+    const auto& tiles = lazy_->boundary_tiles;
+    ResolveOpposingEdges(reader, std::lower_bound(tiles.begin(), tiles.end(), end_tile) - tiles.begin());
+  }
+  return lazy_->opposing[idx];
+}
+
+// Get the opposing directed edges, resolving every boundary tile
+midgard::iterable_t<const GraphId> GraphTile::GetOpposingEdgeIds(GraphReader& reader) const {
+  if (!lazy_) {
+    return midgard::iterable_t<const GraphId>(nullptr, nullptr);
+  }
+  BuildOpposingEdges();
+  for (size_t boundary = 0; boundary < lazy_->boundary_tiles.size(); boundary++) {
+    ResolveOpposingEdges(reader, boundary);
+  }
+  return midgard::iterable_t<const GraphId>(lazy_->opposing.data(),
+                                            lazy_->opposing.size());
+}
+
+// Get the directed edges that end at a node, resolving only the tiles
+// its edges lead into
+const GraphId* GraphTile::GetIncomingEdgeIds(GraphReader& reader,
+                                             const uint32_t node_index,
+                                             uint32_t& count) const {
+  const NodeInfo* nodeinfo = node(node_index);
+  count = nodeinfo->edge_count();
+  if (!lazy_ || nodeinfo->edge_index() + count > header_->directededgecount()) {
+    throw std::runtime_error("GraphTile incoming edge index out of bounds: " +
+                             std::to_string(header_->graphid().tileid()) + "," +
+                             std::to_string(header_->graphid().level()) + "," +
+                             std::to_string(nodeinfo->edge_index()) + " directededgecount= " +
+                             std::to_string(header_->directededgecount()));
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    GetOpposingEdgeId(reader, nodeinfo->edge_index() + i);
+  }
+  return lazy_->opposing.data() + nodeinfo->edge_index();
+}
+
 // Convenience method to get the names for an edge given the offset to the
 // edge info
 std::vector<std::string> GraphTile::GetNames(const uint32_t edgeinfo_offset) const {
-  return edgeinfo(edgeinfo_offset)->GetNames();
+  return edgeinfo(edgeinfo_offset).GetNames();
+}
+
+// Get references to the names for an edge given the offset to the edge info
+void GraphTile::GetNameRefs(const uint32_t edgeinfo_offset,
+                            std::vector<boost::string_ref>& names) const {
+  edgeinfo(edgeinfo_offset).GetNameRefs(names);
+}
+
+// Get the directed edges that have the given street name.
+const std::vector<uint32_t>& GraphTile::GetEdgesByName(const boost::string_ref name) const {
+  static const std::vector<uint32_t> kNoEdges;
+  if (!lazy_) {
+    return kNoEdges;
+  }
+
+  // Index the names of all edges (except transition edges, which have no
+  // edge info) the first time
+  std::call_once(lazy_->name_index_flag, [this]() {
+    std::vector<boost::string_ref> names;
+    for (uint32_t idx = 0; idx < header_->directededgecount(); idx++) {
+      const DirectedEdge& edge = directededges_[idx];
+      if (edge.trans_up() || edge.trans_down()) {
+        continue;
+      }
+      edgeinfo(edge.edgeinfo_offset()).GetNameRefs(names);
+      for (const auto& n : names) {
+        auto& edges = lazy_->name_index[NormalizeName(n)];
+        if (edges.empty() || edges.back() != idx) {
+          edges.push_back(idx);
+        }
+      }
+    }
+  });
+
+  auto found = lazy_->name_index.find(NormalizeName(name));
+  return (found == lazy_->name_index.end()) ? kNoEdges : found->second;
+}
+
+// Normalize a street name for searching.
+std::string GraphTile::NormalizeName(const boost::string_ref name) {
+  std::string normalized;
+  normalized.reserve(name.size());
+  bool separator = false;
+  for (const char c : name) {
+    unsigned char u = static_cast<unsigned char>(c);
+    if (u >= 0x80 || std::isalnum(u)) {
+      if (separator && !normalized.empty()) {
+        normalized.push_back(' ');
+      }
+      normalized.push_back(u < 0x80 ? std::tolower(u) : c);
+      separator = false;
+    } else {
+      separator = true;
+    }
+  }
+  return normalized;
 }
 
 // Get the admininfo at the specified index.
@@ -342,6 +862,26 @@ std::string GraphTile::GetName(const uint32_t textlist_offset) const {
   }
 }
 
+// Get a reference to the text/name for a given offset to the textlist
+boost::string_ref GraphTile::GetNameRef(const uint32_t textlist_offset) const {
+  if (textlist_offset < textlist_size_) {
+    const char* text = textlist_ + textlist_offset;
+    return boost::string_ref(text, strnlen(text, textlist_size_ - textlist_offset));
+  } else {
+    throw std::runtime_error("GetNameRef: offset exceeds size of text list");
+  }
+}
+
+// Get a reference to the country text of the admin at the specified index
+boost::string_ref GraphTile::GetCountryText(const size_t idx) const {
+  return GetNameRef(admin(idx)->country_offset());
+}
+
+// Get a reference to the state text of the admin at the specified index
+boost::string_ref GraphTile::GetStateText(const size_t idx) const {
+  return GetNameRef(admin(idx)->state_offset());
+}
+
 // Convenience method to get the signs for an edge given the
 // directed edge index.
 std::vector<SignInfo> GraphTile::GetSigns(const uint32_t idx) const {
@@ -467,6 +1007,72 @@ const TransitDeparture* GraphTile::GetNextDeparture(const uint32_t lineid,
   return nullptr;
 }
 
+// Get the departures along a line within the time window (no service
+// day filtering).
+midgard::iterable_t<const TransitDeparture> GraphTile::GetDepartures(
+                 const uint32_t lineid, const uint32_t start_time,
+                 const uint32_t end_time) const {
+  // Departures are sorted by line Id and then by departure time
+  const TransitDeparture* begin = departures_;
+  const TransitDeparture* end = departures_ + header_->departurecount();
+  const TransitDeparture* first = std::lower_bound(begin, end, lineid,
+      [start_time](const TransitDeparture& dep, const uint32_t lineid) {
+        return dep.lineid() < lineid || (dep.lineid() == lineid &&
+                                         dep.departure_time() < start_time);
+      });
+  const TransitDeparture* last = std::upper_bound(first, end, lineid,
+      [end_time](const uint32_t lineid, const TransitDeparture& dep) {
+        return lineid < dep.lineid() || (lineid == dep.lineid() &&
+                                         end_time < dep.departure_time());
+      });
+  return {first, last};
+}
+
+// Get the departures along a line within the time window that are valid
+// on the given service day.
+uint32_t GraphTile::GetDepartures(const uint32_t lineid,
+                 const uint32_t start_time, const uint32_t end_time,
+                 const uint32_t day, const uint32_t dow,
+                 const bool date_before_tile,
+                 std::vector<const TransitDeparture*>& departures) const {
+  auto range = GetDepartures(lineid, start_time, end_time);
+  if (range.size() == 0) {
+    return 0;
+  }
+
+  // Use the days mask if within the days of the departure else fall back
+  // to the day of week mask (same rules as GetNextDeparture)
+  const uint64_t day_bit = 1ULL << (day & 63);
+  uint32_t count = 0;
+  for (const auto& dep : range) {
+    const bool use_days = !date_before_tile && day <= dep.end_day();
+    if (use_days ? (dep.days() & day_bit) != 0 : (dep.days_of_week() & dow) != 0) {
+      departures.push_back(&dep);
+      count++;
+    }
+  }
+  return count;
+}
+
+// Get all departures from a transit stop node within the time window that
+// are valid on the given service day.
+uint32_t GraphTile::GetStopDepartures(const uint32_t node_index,
+                 const uint32_t start_time, const uint32_t end_time,
+                 const uint32_t day, const uint32_t dow,
+                 const bool date_before_tile,
+                 std::vector<const TransitDeparture*>& departures) const {
+  uint32_t count = 0;
+  uint32_t edge_count, edge_index;
+  const DirectedEdge* edge = GetDirectedEdges(node_index, edge_count, edge_index);
+  for (uint32_t i = 0; i < edge_count; i++, edge++) {
+    if (edge->IsTransitLine()) {
+      count += GetDepartures(edge->lineid(), start_time, end_time, day, dow,
+                             date_before_tile, departures);
+    }
+  }
+  return count;
+}
+
 // Get the departure given the line Id and tripid
 const TransitDeparture* GraphTile::GetTransitDeparture(const uint32_t lineid,
                      const uint32_t tripid) const {
@@ -550,103 +1156,36 @@ const TransitRoute* GraphTile::GetTransitRoute(const uint32_t idx) const {
 // compute the number of transfer records for the stop.
 std::pair<TransitTransfer*, uint32_t> GraphTile::GetTransfers(
               const uint32_t stopid) const {
-  uint32_t count = header_->transfercount();
-  if (count == 0) {
+  // Transfers from a stop are a contiguous slice given by the transfer index
+  if (stopid + 1 >= transfer_offsets_.size()) {
+    LOG_DEBUG("No transfers found from stopid = " + std::to_string(stopid));
     return {nullptr, 0};
   }
-
-  // Binary search
-  int32_t low = 0;
-  int32_t high = count-1;
-  int32_t mid;
-  bool found = false;
-  while (low <= high) {
-    mid = (low + high) / 2;
-    if (transit_transfers_[mid].from_stopid() == stopid) {
-      found = true;
-      break;
-    }
-    if (stopid < transit_transfers_[mid].from_stopid() ) {
-      high = mid - 1;
-    } else {
-      low = mid + 1;
-    }
-  }
-
-  if (found) {
-    // Back up while prior is equal (or at the beginning)
-    while (mid > 0 &&
-          transit_transfers_[mid-1].from_stopid() == stopid) {
-      mid--;
-    }
-
-    // Set the start and increment until not equal to get the count
-    uint32_t n = 0;
-    TransitTransfer* start = &transit_transfers_[mid];
-    while (transit_transfers_[mid].from_stopid() == stopid && mid < count) {
-      n++;
-      mid++;
-    }
-    return {start, n};
-  } else {
+  uint32_t n = transfer_offsets_[stopid + 1] - transfer_offsets_[stopid];
+  if (n == 0) {
     LOG_DEBUG("No transfers found from stopid = " + std::to_string(stopid));
     return {nullptr, 0};
   }
+  return {&transit_transfers_[transfer_offsets_[stopid]], n};
 }
 
 // Get a pointer to the transfer record given the from stop Id and
 // the to stop id.
 TransitTransfer* GraphTile::GetTransfer(const uint32_t from_stopid,
                                         const uint32_t to_stopid) const {
-  uint32_t count = header_->transfercount();
-  if (count == 0) {
-    return nullptr;
-  }
-
-  // Binary search
-  int32_t low = 0;
-  int32_t high = count-1;
-  int32_t mid;
-  bool found = false;
-  while (low <= high) {
-    mid = (low + high) / 2;
-    if (transit_transfers_[mid].from_stopid() == from_stopid) {
-      found = true;
-      break;
-    }
-    if (from_stopid < transit_transfers_[mid].from_stopid() ) {
-      high = mid - 1;
-    } else {
-      low = mid + 1;
-    }
-  }
-
-  if (found) {
-    // Back up while prior is equal (or at the beginning)
-    uint32_t m = mid;
-    while (mid > 0 &&
-          transit_transfers_[mid-1].from_stopid() == from_stopid) {
-      if (transit_transfers_[mid-1].to_stopid() == to_stopid) {
-        return &transit_transfers_[mid-1];
-      }
-      mid--;
-    }
-
-    // Set the start and increment until not equal to get the count
-    mid = m;
-    TransitTransfer* start = &transit_transfers_[mid];
-    while (transit_transfers_[mid].from_stopid() == from_stopid && mid < count) {
-      if (transit_transfers_[mid].to_stopid() == to_stopid) {
-        return &transit_transfers_[mid];
-      }
-      mid++;
-    }
-    return nullptr;
-  } else {
-    LOG_DEBUG("No transfers found from stopid = " + std::to_string(from_stopid) +
-              " to stopid " + std::to_string(to_stopid));
-    return nullptr;
+  // Transfers within the slice for the from stop are sorted by to stop Id
+  auto transfers = GetTransfers(from_stopid);
+  TransitTransfer* end = transfers.first + transfers.second;
+  TransitTransfer* transfer = std::lower_bound(transfers.first, end, to_stopid,
+      [](const TransitTransfer& t, const uint32_t stopid) {
+        return t.to_stopid() < stopid;
+      });
+  if (transfer != end && transfer->to_stopid() == to_stopid) {
+    return transfer;
   }
+  LOG_DEBUG("No transfers found from stopid = " + std::to_string(from_stopid) +
+            " to stopid " + std::to_string(to_stopid));
+  return nullptr;
 }
 
 // Get the access restriction given its directed edge index
@@ -701,6 +1240,95 @@ std::vector<AccessRestriction> GraphTile::GetAccessRestrictions(const uint32_t i
   return restrictions;
 }
 
+// Build the spatial index of directed edge shapes on first use
+const PackedRTree& GraphTile::GetEdgeIndex() const {
+  std::call_once(lazy_->rtree_flag, [this]() {
+    // Both directions share the edge info so compute each box once
+    std::unordered_map<uint32_t, PackedRTree::Box> boxes;
+    std::vector<PointLL> shape;
+    PackedRTree& rtree = lazy_->rtree;
+    rtree.reserve(header_->directededgecount());
+    for (uint32_t idx = 0; idx < header_->directededgecount(); idx++) {
+      const DirectedEdge& edge = directededges_[idx];
+      if (edge.trans_up() || edge.trans_down()) {
+        continue;
+      }
+      auto inserted = boxes.emplace(edge.edgeinfo_offset(), PackedRTree::Box{});
+      if (inserted.second) {
+        edgeinfo(edge.edgeinfo_offset()).DecodeShape(shape);
+        if (shape.empty()) {
+          boxes.erase(inserted.first);
+          continue;
+        }
+        PackedRTree::Box& box = inserted.first->second;
+        box = {shape[0].lng(), shape[0].lat(), shape[0].lng(), shape[0].lat()};
+        for (const auto& p : shape) {
+          box.minx = std::min(box.minx, p.lng());
+          box.miny = std::min(box.miny, p.lat());
+          box.maxx = std::max(box.maxx, p.lng());
+          box.maxy = std::max(box.maxy, p.lat());
+        }
+      }
+      rtree.Add(inserted.first->second, idx);
+    }
+    rtree.Build();
+  });
+  return lazy_->rtree;
+}
+
+// Find the directed edges whose shape bounding box intersects the box.
+void GraphTile::FindEdges(const midgard::AABB2<PointLL>& box,
+                          std::vector<GraphId>& edges) const {
+  if (!lazy_) {
+    return;
+  }
+  std::vector<uint32_t> indexes;
+  GetEdgeIndex().Query({box.minx(), box.miny(), box.maxx(), box.maxy()}, indexes);
+  const GraphId& id = header_->graphid();
+  for (const auto idx : indexes) {
+    edges.emplace_back(id.tileid(), id.level(), idx);
+  }
+}
+
+// Find the directed edges nearest to a location.
+void GraphTile::FindNearestEdges(const PointLL& ll, const size_t k,
+                                 const float max_distance,
+                                 std::vector<std::pair<float, GraphId> >& edges,
+                                 const uint32_t access,
+                                 std::unordered_map<uint32_t, std::vector<PointLL> >* shapes) const {
+  edges.clear();
+  if (!lazy_) {
+    return;
+  }
+  // Edges that are skipped are farther than any distance searched
+  LocalProjection projection(ll);
+  std::vector<PointLL> shape;
+  std::vector<std::pair<float, uint32_t> > nearest;
+  GetEdgeIndex().Nearest(k, max_distance,
+    [&projection](const PackedRTree::Box& box) {
+      return projection.Distance(box.minx, box.miny, box.maxx, box.maxy);
+    },
+    [this, &projection, &shape, access, shapes](const uint32_t idx) {
+      const DirectedEdge& edge = directededges_[idx];
+      if (edge.is_shortcut() || !(edge.forwardaccess() & access)) {
+        return std::numeric_limits<float>::infinity();
+      }
+      if (shapes == nullptr) {
+        edgeinfo(edge.edgeinfo_offset()).DecodeShape(shape);
+        return projection.Project(shape).distance;
+      }
+      auto cached = shapes->emplace(edge.edgeinfo_offset(), std::vector<PointLL>());
+      if (cached.second) {
+        edgeinfo(edge.edgeinfo_offset()).DecodeShape(cached.first->second);
+      }
+      return projection.Project(cached.first->second).distance;
+    }, nearest);
+  const GraphId& id = header_->graphid();
+  for (const auto& n : nearest) {
+    edges.emplace_back(n.first, GraphId(id.tileid(), id.level(), n.second));
+  }
+}
+
 // Get the array of graphids for this cell
 midgard::iterable_t<GraphId> GraphTile::GetCell(size_t column, size_t row) const {
   auto offsets = header_->cell_offset(column, row);
@@ -209,11 +209,44 @@ void GraphTileHeader::set_complex_restriction_offset(const uint32_t offset) {
   complex_restriction_offset_ = offset;
 }
 
+// Get the offset in bytes to the quantized shapes (0 if none).
+uint32_t GraphTileHeader::quantized_shape_offset() const {
+  return quantized_shape_offset_;
+}
+
+// Sets the offset to the quantized shapes.
+void GraphTileHeader::set_quantized_shape_offset(const uint32_t offset) {
+  quantized_shape_offset_ = offset;
+}
+
 // Sets the edge bin offsets
 void GraphTileHeader::set_edge_cell_offsets(const uint32_t (&offsets)[kCellCount]) {
   memcpy(cell_offsets_, offsets, sizeof(cell_offsets_));
 }
 
+// Get the format version of the tile layout.
+uint32_t GraphTileHeader::format_version() const {
+  return (format_version_ == 0) ? kTileFormatV1 : format_version_;
+}
+
+// Sets the format version of the tile layout.
+void GraphTileHeader::set_format_version(const uint32_t version) {
+  format_version_ = version;
+}
+
+// Get the number of entries in the table of contents.
+uint32_t GraphTileHeader::section_count() const {
+  return section_count_;
+}
+
+// Sets the number of entries in the table of contents.
+void GraphTileHeader::set_section_count(const uint32_t count) {
+  if (count > 255) {
+    throw std::runtime_error("Exceeding max. section count: " + std::to_string(count));
+  }
+  section_count_ = count;
+}
+
 // Get the offset to the given cell in the 5x5 grid.
 std::pair<uint32_t, uint32_t> GraphTileHeader::cell_offset(size_t column, size_t row) const {
   auto i = row * kGridDim + column;
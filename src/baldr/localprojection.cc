@@ -0,0 +1,76 @@
+#include "baldr/localprojection.h"
+#include <valhalla/midgard/constants.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace valhalla::midgard;
+
+namespace valhalla {
+namespace baldr {
+
+// Constructor
+LocalProjection::LocalProjection(const PointLL& ll)
+    : ll_(ll),
+      lng_scale_(std::cos(ll.lat() * kRadPerDeg) * kMetersPerDegreeLat) {
+}
+
+// Get the distance to the nearest point of a bounding box.
+float LocalProjection::Distance(const float minx, const float miny,
+                                const float maxx, const float maxy) const {
+  float dx = std::max(std::max(minx - ll_.lng(), ll_.lng() - maxx), 0.0f) * lng_scale_;
+  float dy = std::max(std::max(miny - ll_.lat(), ll_.lat() - maxy), 0.0f) * kMetersPerDegreeLat;
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+// Project the location onto a shape.
+ShapeProjection LocalProjection::Project(const std::vector<PointLL>& shape) const {
+  if (shape.empty()) {
+    return {std::numeric_limits<float>::max(), 0.0f, 0.0f, ll_};
+  }
+
+  // Shape points are relative to the location
+  float x0 = (shape[0].lng() - ll_.lng()) * lng_scale_;
+  float y0 = (shape[0].lat() - ll_.lat()) * kMetersPerDegreeLat;
+  if (shape.size() == 1) {
+    return {std::sqrt(x0 * x0 + y0 * y0), 0.0f, 0.0f, shape[0]};
+  }
+
+  // Closest segment, where along it the closest point is and the length of
+  // the shape before it
+  float closest = std::numeric_limits<float>::max();
+  size_t best = 0;
+  float best_t = 0.0f, best_length = 0.0f, before = 0.0f, cross = 0.0f, total = 0.0f;
+  for (size_t i = 1; i < shape.size(); ++i) {
+    float x1 = (shape[i].lng() - ll_.lng()) * lng_scale_;
+    float y1 = (shape[i].lat() - ll_.lat()) * kMetersPerDegreeLat;
+    float ux = x1 - x0;
+    float uy = y1 - y0;
+    float len2 = ux * ux + uy * uy;
+    float t = len2 > 0.0f ? std::min(std::max(-(x0 * ux + y0 * uy) / len2, 0.0f), 1.0f) : 0.0f;
+    float dx = x0 + t * ux;
+    float dy = y0 + t * uy;
+    float length = std::sqrt(len2);
+    if (dx * dx + dy * dy < closest) {
+      closest = dx * dx + dy * dy;
+      best = i - 1;
+      best_t = t;
+      best_length = length;
+      before = total;
+      // Location relative to the segment start crossed with the segment
+      cross = ux * -y0 - uy * -x0;
+    }
+    total += length;
+    x0 = x1;
+    y0 = y1;
+  }
+
+  float along = (total > 0.0f) ? (before + best_t * best_length) / total : 0.0f;
+  PointLL point(shape[best].lng() + best_t * (shape[best + 1].lng() - shape[best].lng()),
+                shape[best].lat() + best_t * (shape[best + 1].lat() - shape[best].lat()));
+  return {std::sqrt(closest), std::min(along, 1.0f), cross, point};
+}
+
+}
+}
@@ -0,0 +1,57 @@
+#include "baldr/nameinterner.h"
+
+#include <stdexcept>
+
+namespace valhalla {
+namespace baldr {
+
+// Constructor
+NameInterner::NameInterner() {
+}
+
+// Get the process-wide interner.
+NameInterner& NameInterner::Get() {
+  static NameInterner interner;
+  return interner;
+}
+
+// Get the id of a name, adding it if needed.
+uint32_t NameInterner::Intern(const boost::string_ref name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = ids_.find(name);
+  if (found != ids_.end()) {
+    return found->second;
+  }
+  if (names_.size() >= kInvalidNameId) {
+    throw std::runtime_error("NameInterner: too many names");
+  }
+  uint32_t id = names_.size();
+  names_.emplace_back(name.data(), name.size());
+  ids_.emplace(boost::string_ref(names_.back()), id);
+  return id;
+}
+
+// Get the id of a name without adding it.
+uint32_t NameInterner::Find(const boost::string_ref name) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = ids_.find(name);
+  return (found == ids_.end()) ? kInvalidNameId : found->second;
+}
+
+// Get the name for an id.
+const std::string& NameInterner::name(const uint32_t id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (id < names_.size()) {
+    return names_[id];
+  }
+  throw std::runtime_error("NameInterner: name id out of bounds");
+}
+
+// Get the number of interned names.
+size_t NameInterner::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return names_.size();
+}
+
+}
+}
@@ -0,0 +1,257 @@
+#include "baldr/nodecomponents.h"
+#include "baldr/graphreader.h"
+#include "baldr/parallel.h"
+
+#include <algorithm>
+#include <valhalla/midgard/logging.h>
+
+namespace {
+
+// Version of the labels file layout
+constexpr uint32_t kComponentsVersion = 2;
+
+// Counts that follow the sidecar header of a labels file. They are
+// followed, for each travel mode, by its access mask, the strong components
+// and then the weak components.
+struct ComponentsCounts {
+  uint32_t mode_count;
+  uint32_t spare;
+};
+
+// Node of the depth first search, with the range of its directed edges
+// still to be followed
+struct SearchFrame {
+  uint32_t node;
+  uint32_t tile;
+  uint32_t edge;
+  uint32_t end_edge;
+};
+
+}
+
+namespace valhalla {
+namespace baldr {
+
+// Constructor for empty labels.
+NodeComponents::NodeComponents() {
+}
+
+// Constructor for unlabeled nodes of a tile.
+NodeComponents::NodeComponents(const GraphTile& tile)
+    : TileSidecar(tile) {
+}
+
+// Read a labels file.
+NodeComponents::NodeComponents(const std::string& file) {
+  decltype(labels_) labels;
+  bool read = Read(file, kComponentsVersion, [&labels](std::istream& in, const uint32_t nodecount) {
+    ComponentsCounts counts;
+    if (!in.read(reinterpret_cast<char*>(&counts), sizeof(counts))) {
+      return;
+    }
+    for (uint32_t m = 0; in && m < counts.mode_count; m++) {
+      uint32_t access = 0;
+      in.read(reinterpret_cast<char*>(&access), sizeof(access));
+      auto& mode = labels[access];
+      mode.first.resize(nodecount);
+      mode.second.resize(nodecount);
+      in.read(reinterpret_cast<char*>(mode.first.data()), mode.first.size() * sizeof(uint32_t));
+      in.read(reinterpret_cast<char*>(mode.second.data()), mode.second.size() * sizeof(uint32_t));
+    }
+  });
+  if (read) {
+    labels_ = std::move(labels);
+  }
+}
+
+// Write the labels to a file.
+bool NodeComponents::Write(const std::string& file) const {
+  return TileSidecar::Write(file, kComponentsVersion, [this](std::ostream& out) {
+    ComponentsCounts counts{static_cast<uint32_t>(labels_.size()), 0};
+    out.write(reinterpret_cast<const char*>(&counts), sizeof(counts));
+    for (const auto& mode : labels_) {
+      out.write(reinterpret_cast<const char*>(&mode.first), sizeof(mode.first));
+      out.write(reinterpret_cast<const char*>(mode.second.first.data()),
+                mode.second.first.size() * sizeof(uint32_t));
+      out.write(reinterpret_cast<const char*>(mode.second.second.data()),
+                mode.second.second.size() * sizeof(uint32_t));
+    }
+  });
+}
+
+// Get the labels file name of a tile.
+std::string NodeComponents::FileName(const GraphId& graphid, const TileHierarchy& hierarchy) {
+  return hierarchy.tile_path().FullPath(hierarchy.tile_dir(), graphid, ".scc");
+}
+
+// Get the strong component of a node.
+uint32_t NodeComponents::strong(const uint32_t node_index, const uint32_t access) const {
+  auto found = labels_.find(access);
+  if (found == labels_.end() || node_index >= found->second.first.size()) {
+    return kNoComponent;
+  }
+  return found->second.first[node_index];
+}
+
+// Get the weak component of a node.
+uint32_t NodeComponents::weak(const uint32_t node_index, const uint32_t access) const {
+  auto found = labels_.find(access);
+  if (found == labels_.end() || node_index >= found->second.second.size()) {
+    return kNoComponent;
+  }
+  return found->second.second[node_index];
+}
+
+// Set the labels of a travel mode.
+void NodeComponents::set_labels(const uint32_t access, std::vector<uint32_t> strong,
+                                std::vector<uint32_t> weak) {
+  if (strong.size() != nodecount_ || weak.size() != nodecount_) {
+    throw std::runtime_error("Components need a label for each node of the tile");
+  }
+  labels_[access] = std::make_pair(std::move(strong), std::move(weak));
+}
+
+// Label the connected components of the nodes of all levels.
+size_t BuildComponents(const TileHierarchy& hierarchy,
+                       const std::vector<uint32_t>& access_modes) {
+  // Number the nodes of every level, tile by tile
+  std::vector<GraphId> tile_ids;
+  for (const auto& level : hierarchy.levels()) {
+    auto level_tiles = GraphReader::GetTileSet(hierarchy, level.first);
+    tile_ids.insert(tile_ids.end(), level_tiles.begin(), level_tiles.end());
+  }
+  std::vector<GraphTile> tiles;
+  std::unordered_map<GraphId, uint32_t> tile_index;
+  std::vector<uint32_t> offsets(1, 0);
+  for (const auto& tile_id : tile_ids) {
+    tiles.emplace_back(hierarchy, tile_id, true);
+    if (tiles.back().size() == 0) {
+      throw std::runtime_error("Could not load tile " + std::to_string(tile_id.value));
+    }
+    tile_index.emplace(tile_id, tiles.size() - 1);
+    offsets.push_back(offsets.back() + tiles.back().header()->nodecount());
+  }
+  uint32_t nodecount = offsets.back();
+
+  // Label each mode on its own thread
+  std::vector<std::vector<uint32_t> > strong(access_modes.size()), weak(access_modes.size());
+  ParallelFor(access_modes.size(), access_modes.size(), [&](const size_t m) {
+    std::vector<const EdgeCosts*> costs;
+    for (const auto& tile : tiles) {
+      costs.push_back(&tile.GetEdgeCosts(access_modes[m]));
+    }
+
+    // Weak components: union find over the edges the mode can use
+    std::vector<uint32_t> parent(nodecount);
+    for (uint32_t v = 0; v < nodecount; v++) {
+      parent[v] = v;
+    }
+    auto find = [&parent](uint32_t v) {
+      while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+      }
+      return v;
+    };
+
+    // Strong components: Tarjan's algorithm with an explicit stack
+    const uint32_t kUnvisited = kNoComponent;
+    std::vector<uint32_t> index(nodecount, kUnvisited), low(nodecount);
+    std::vector<uint32_t>& components = strong[m];
+    components.assign(nodecount, kNoComponent);
+    std::vector<bool> on_stack(nodecount, false);
+    std::vector<uint32_t> stack;
+    std::vector<SearchFrame> frames;
+    uint32_t counter = 0, component = 0;
+    auto visit = [&](const uint32_t v, const uint32_t t) {
+      index[v] = low[v] = counter++;
+      stack.push_back(v);
+      on_stack[v] = true;
+      const NodeInfo* node = tiles[t].node(v - offsets[t]);
+      frames.push_back({v, t, node->edge_index(), node->edge_index() + node->edge_count()});
+    };
+    for (uint32_t t = 0; t < tiles.size(); t++) {
+      for (uint32_t root = offsets[t]; root < offsets[t + 1]; root++) {
+        if (index[root] != kUnvisited) {
+          continue;
+        }
+        visit(root, t);
+        while (!frames.empty()) {
+          SearchFrame& frame = frames.back();
+          if (frame.edge < frame.end_edge) {
+            // Follow the next edge. Transitions join the copies of a node
+            // on each level and are followed whatever the mode.
+            uint32_t idx = frame.edge++;
+            const DirectedEdge* edge = tiles[frame.tile].directededge(idx);
+            if (!costs[frame.tile]->accessible(idx) && !edge->trans_up() && !edge->trans_down()) {
+              continue;
+            }
+            GraphId end = edge->endnode();
+            auto end_tile = tile_index.find(end.Tile_Base());
+            if (end_tile == tile_index.end() || end.id() >= tiles[end_tile->second].header()->nodecount()) {
+              continue;
+            }
+            uint32_t w = offsets[end_tile->second] + end.id();
+            uint32_t v = frame.node;
+            parent[find(v)] = find(w);
+            if (index[w] == kUnvisited) {
+              visit(w, end_tile->second);
+            } else if (on_stack[w]) {
+              low[v] = std::min(low[v], index[w]);
+            }
+          } else {
+            // All edges followed, the node may be the root of a component
+            uint32_t v = frame.node;
+            frames.pop_back();
+            if (low[v] == index[v]) {
+              uint32_t w;
+              do {
+                w = stack.back();
+                stack.pop_back();
+                on_stack[w] = false;
+                components[w] = component;
+              } while (w != v);
+              component++;
+            }
+            if (!frames.empty()) {
+              low[frames.back().node] = std::min(low[frames.back().node], low[v]);
+            }
+          }
+        }
+      }
+    }
+
+    // Number the weak components in order of their first node
+    std::vector<uint32_t>& islands = weak[m];
+    islands.assign(nodecount, kNoComponent);
+    std::vector<uint32_t> numbers(nodecount, kNoComponent);
+    uint32_t island = 0;
+    for (uint32_t v = 0; v < nodecount; v++) {
+      uint32_t& number = numbers[find(v)];
+      if (number == kNoComponent) {
+        number = island++;
+      }
+      islands[v] = number;
+    }
+    LOG_DEBUG("Access " + std::to_string(access_modes[m]) + ": " + std::to_string(component) +
+              " strong and " + std::to_string(island) + " weak components");
+  });
+
+  // Write the labels of each tile
+  for (uint32_t t = 0; t < tiles.size(); t++) {
+    NodeComponents components(tiles[t]);
+    for (size_t m = 0; m < access_modes.size(); m++) {
+      components.set_labels(access_modes[m],
+          std::vector<uint32_t>(strong[m].begin() + offsets[t], strong[m].begin() + offsets[t + 1]),
+          std::vector<uint32_t>(weak[m].begin() + offsets[t], weak[m].begin() + offsets[t + 1]));
+    }
+    std::string file = NodeComponents::FileName(tile_ids[t], hierarchy);
+    if (!components.Write(file)) {
+      throw std::runtime_error("Could not write components " + file);
+    }
+  }
+  return tiles.size();
+}
+
+}
+}
@@ -0,0 +1,20 @@
+#include "baldr/nodecore.h"
+
+namespace valhalla {
+namespace baldr {
+
+// Copy the expansion attributes of a node
+NodeCore::NodeCore(const NodeInfo& node)
+    : latlng_(node.latlng()),
+      edge_index_(node.edge_index()),
+      edge_count_(node.edge_count()),
+      access_(node.access()),
+      type_(static_cast<uint8_t>(node.type())),
+      parent_(node.parent()),
+      child_(node.child()),
+      mode_change_(node.mode_change()),
+      spare_(0) {
+}
+
+}
+}
@@ -0,0 +1,162 @@
+#include "baldr/packedrtree.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Hilbert curve order of 16 bits per axis
+constexpr uint32_t kHilbertMax = (1 << 16) - 1;
+
+// Distance along the Hilbert curve of a cell on a 2^16 x 2^16 grid
+uint32_t hilbert(uint32_t x, uint32_t y) {
+  uint32_t d = 0;
+  for (uint32_t s = 1 << 15; s > 0; s >>= 1) {
+    uint32_t rx = (x & s) > 0;
+    uint32_t ry = (y & s) > 0;
+    d += s * s * ((3 * rx) ^ ry);
+    // Rotate the quadrant
+    if (ry == 0) {
+      if (rx == 1) {
+        x = kHilbertMax - x;
+        y = kHilbertMax - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+}
+
+namespace valhalla {
+namespace baldr {
+
+// Constructor
+PackedRTree::PackedRTree() {
+}
+
+// Reserve memory for the items
+void PackedRTree::reserve(const size_t count) {
+  boxes_.reserve(count + count / (kNodeSize - 1) + 1);
+  ids_.reserve(count);
+}
+
+// Add an item
+void PackedRTree::Add(const Box& box, const uint32_t id) {
+  if (!level_bounds_.empty()) {
+    throw std::runtime_error("PackedRTree: cannot add items after Build");
+  }
+  boxes_.push_back(box);
+  ids_.push_back(id);
+}
+
+// Sort the items along the Hilbert curve and build the nodes
+void PackedRTree::Build() {
+  if (!level_bounds_.empty()) {
+    throw std::runtime_error("PackedRTree: Build was already called");
+  }
+  size_t count = ids_.size();
+  level_bounds_.push_back(0);
+  if (count == 0) {
+    level_bounds_.push_back(0);
+    return;
+  }
+
+  // Bounds of all items
+  Box bounds = boxes_.front();
+  for (const auto& b : boxes_) {
+    bounds.minx = std::min(bounds.minx, b.minx);
+    bounds.miny = std::min(bounds.miny, b.miny);
+    bounds.maxx = std::max(bounds.maxx, b.maxx);
+    bounds.maxy = std::max(bounds.maxy, b.maxy);
+  }
+
+  // Sort the items by the Hilbert value of their centers
+  float width = std::max(bounds.maxx - bounds.minx, std::numeric_limits<float>::min());
+  float height = std::max(bounds.maxy - bounds.miny, std::numeric_limits<float>::min());
+  std::vector<std::pair<uint32_t, uint32_t> > order(count);
+  for (size_t i = 0; i < count; ++i) {
+    const Box& b = boxes_[i];
+    uint32_t x = kHilbertMax * ((b.minx + b.maxx) * 0.5f - bounds.minx) / width;
+    uint32_t y = kHilbertMax * ((b.miny + b.maxy) * 0.5f - bounds.miny) / height;
+    order[i] = {hilbert(std::min(x, kHilbertMax), std::min(y, kHilbertMax)), i};
+  }
+  std::sort(order.begin(), order.end());
+  std::vector<Box> boxes;
+  boxes.reserve(count + count / (kNodeSize - 1) + 1);
+  std::vector<uint32_t> ids(count);
+  for (size_t i = 0; i < count; ++i) {
+    boxes.push_back(boxes_[order[i].second]);
+    ids[i] = ids_[order[i].second];
+  }
+
+  // Pack each level into nodes until there is a single root node. A tree
+  // with a single item still gets a root node so the root is never an item.
+  size_t start = 0;
+  size_t end = count;
+  do {
+    for (size_t i = start; i < end; i += kNodeSize) {
+      Box node = boxes[i];
+      for (size_t j = i + 1; j < std::min(i + kNodeSize, end); ++j) {
+        node.minx = std::min(node.minx, boxes[j].minx);
+        node.miny = std::min(node.miny, boxes[j].miny);
+        node.maxx = std::max(node.maxx, boxes[j].maxx);
+        node.maxy = std::max(node.maxy, boxes[j].maxy);
+      }
+      boxes.push_back(node);
+    }
+    level_bounds_.push_back(end);
+    start = end;
+    end = boxes.size();
+  } while (end - start > 1);
+  level_bounds_.push_back(end);
+
+  boxes_.swap(boxes);
+  ids_.swap(ids);
+}
+
+// Get the number of items
+size_t PackedRTree::size() const {
+  return ids_.size();
+}
+
+// Get the range of children of the node at the given position
+size_t PackedRTree::FirstChild(const size_t pos, size_t& end) const {
+  // Find the level of the node. Levels are few so a linear search is fine.
+  size_t level = 1;
+  while (pos >= level_bounds_[level + 1]) {
+    level++;
+  }
+  size_t first = level_bounds_[level - 1] + (pos - level_bounds_[level]) * kNodeSize;
+  end = std::min(first + kNodeSize, level_bounds_[level]);
+  return first;
+}
+
+// Find the items whose box intersects the given box
+void PackedRTree::Query(const Box& box, std::vector<uint32_t>& results) const {
+  if (ids_.empty()) {
+    return;
+  }
+  std::vector<size_t> stack = { boxes_.size() - 1 };
+  while (!stack.empty()) {
+    size_t pos = stack.back();
+    stack.pop_back();
+    const Box& b = boxes_[pos];
+    if (b.minx > box.maxx || b.maxx < box.minx ||
+        b.miny > box.maxy || b.maxy < box.miny) {
+      continue;
+    }
+    if (pos < ids_.size()) {
+      results.push_back(ids_[pos]);
+      continue;
+    }
+    size_t end;
+    for (size_t i = FirstChild(pos, end); i < end; ++i) {
+      stack.push_back(i);
+    }
+  }
+}
+
+}
+}
@@ -0,0 +1,56 @@
+#include "baldr/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace valhalla {
+namespace baldr {
+
+// Get the number of threads to run work items on.
+size_t ThreadCount(const size_t threads, const size_t count) {
+  size_t wanted = (threads == 0) ? std::max(std::thread::hardware_concurrency(), 1u) : threads;
+  return std::max<size_t>(std::min(wanted, count), 1);
+}
+
+// Run work on the calling thread and the extra threads, then rethrow the
+// first error.
+void RunThreads(const size_t threads, const std::function<void (size_t)>& work) {
+  std::vector<std::exception_ptr> errors(threads);
+  auto run = [&](const size_t thread) {
+    try {
+      work(thread);
+    } catch (...) {
+      errors[thread] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> pool;
+  for (size_t thread = 1; thread < threads; ++thread) {
+    pool.emplace_back(run, thread);
+  }
+  run(0);
+  for (auto& thread : pool) {
+    thread.join();
+  }
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+// Run the work items on a pool of threads.
+void ParallelFor(const size_t count, const size_t threads,
+                 const std::function<void (size_t)>& work) {
+  std::atomic<size_t> next(0);
+  RunThreads(ThreadCount(threads, count), [&](const size_t) {
+    for (size_t i = next++; i < count; i = next++) {
+      work(i);
+    }
+  });
+}
+
+}
+}
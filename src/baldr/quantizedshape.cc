@@ -0,0 +1,116 @@
+#include "baldr/quantizedshape.h"
+#include <valhalla/midgard/logging.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace valhalla::midgard;
+
+namespace valhalla {
+namespace baldr {
+
+// Constructor for a tile without quantized shapes.
+QuantizedShapes::QuantizedShapes()
+    : entries_(nullptr),
+      count_(0),
+      coords_(nullptr) {
+}
+
+// Constructor given the section within the tile.
+QuantizedShapes::QuantizedShapes(const char* ptr, const size_t size)
+    : QuantizedShapes() {
+  if (size < sizeof(uint32_t) + sizeof(Entry)) {
+    return;
+  }
+
+  // Validate the section size before using it. The encoded shapes are
+  // always present so a bad section is ignored rather than failing the tile.
+  uint32_t count = *reinterpret_cast<const uint32_t*>(ptr);
+  const Entry* entries = reinterpret_cast<const Entry*>(ptr + sizeof(uint32_t));
+  size_t index_size = sizeof(uint32_t) + (static_cast<size_t>(count) + 1) * sizeof(Entry);
+  if (index_size > size ||
+      index_size + static_cast<size_t>(entries[count].point_offset) * 2 * sizeof(int32_t) > size) {
+    LOG_ERROR("Quantized shape section is truncated, ignoring it");
+    return;
+  }
+
+  // The index must be sorted by edge info offset (find searches it) and the
+  // point offsets must not decrease, so every shape ends within the
+  // coordinates checked above
+  for (uint32_t i = 0; i < count; ++i) {
+    if (entries[i].point_offset > entries[i + 1].point_offset ||
+        (i + 1 < count && entries[i].edgeinfo_offset >= entries[i + 1].edgeinfo_offset)) {
+      LOG_ERROR("Quantized shape section index is not sorted, ignoring it");
+      return;
+    }
+  }
+  entries_ = entries;
+  count_ = count;
+  coords_ = reinterpret_cast<const int32_t*>(ptr + index_size);
+}
+
+// Are there any quantized shapes?
+bool QuantizedShapes::empty() const {
+  return count_ == 0;
+}
+
+// Get the quantized shape for the edge info at the given offset.
+iterable_t<const int32_t> QuantizedShapes::find(const uint32_t edgeinfo_offset) const {
+  const Entry* end = entries_ + count_;
+  const Entry* e = std::lower_bound(entries_, end, edgeinfo_offset,
+      [](const Entry& entry, const uint32_t offset) {
+        return entry.edgeinfo_offset < offset;
+      });
+  if (e == end || e->edgeinfo_offset != edgeinfo_offset) {
+    return {coords_, coords_};
+  }
+  return {coords_ + e->point_offset * 2, coords_ + (e + 1)->point_offset * 2};
+}
+
+// Convert quantized coordinates to points. This is a straight line loop
+// the compiler can vectorize (no dependency between points).
+void QuantizedShapes::Dequantize(const int32_t* coords, const size_t count,
+                                 std::vector<PointLL>& shape) {
+  size_t n = shape.size();
+  shape.resize(n + count);
+  PointLL* out = shape.data() + n;
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = PointLL(coords[i*2] / kQuantizedShapePrecision,
+                     coords[i*2+1] / kQuantizedShapePrecision);
+  }
+}
+
+// Serialize shapes into the section format.
+std::string QuantizedShapes::Serialize(
+    const std::map<uint32_t, std::vector<PointLL> >& shapes) {
+  // Index (std::map keeps it sorted by edge info offset)
+  std::vector<Entry> entries;
+  entries.reserve(shapes.size() + 1);
+  uint32_t total = 0;
+  for (const auto& shape : shapes) {
+    entries.push_back({shape.first, total});
+    total += shape.second.size();
+  }
+  entries.push_back({0, total});
+
+  // Quantized coordinates
+  std::vector<int32_t> coords;
+  coords.reserve(total * 2);
+  for (const auto& shape : shapes) {
+    for (const auto& p : shape.second) {
+      coords.push_back(static_cast<int32_t>(std::round(p.lng() * kQuantizedShapePrecision)));
+      coords.push_back(static_cast<int32_t>(std::round(p.lat() * kQuantizedShapePrecision)));
+    }
+  }
+
+  uint32_t count = shapes.size();
+  std::string section(reinterpret_cast<const char*>(&count), sizeof(count));
+  section.append(reinterpret_cast<const char*>(entries.data()),
+                 entries.size() * sizeof(Entry));
+  section.append(reinterpret_cast<const char*>(coords.data()),
+                 coords.size() * sizeof(int32_t));
+  return section;
+}
+
+}
+}
@@ -0,0 +1,41 @@
+#include "baldr/recordfields.h"
+
+using namespace valhalla::baldr;
+
+namespace {
+
+// Shift and mask one field out of records of kWords 64 bit words. The
+// record stride is a compile time constant. The loop stays scalar in the
+// default SSE2 build (there is no strided 64 bit gather before AVX2).
+template <size_t kWords>
+void extract(const void* records, const size_t count, const BitField& field,
+             uint32_t* values) {
+  const uint64_t* words = static_cast<const uint64_t*>(records) + field.word;
+  const uint32_t shift = field.shift;
+  const uint64_t mask = (uint64_t(1) << field.width) - 1;
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = static_cast<uint32_t>((words[i * kWords] >> shift) & mask);
+  }
+}
+
+}
+
+namespace valhalla {
+namespace baldr {
+
+// Extract one field of consecutive directed edges.
+void ExtractField(const DirectedEdge* edges, const size_t count,
+                  const DirectedEdgeField field, uint32_t* values) {
+  extract<sizeof(DirectedEdge) / sizeof(uint64_t)>(edges, count,
+                                                  GetBitField(field), values);
+}
+
+// Extract one field of consecutive nodes.
+void ExtractField(const NodeInfo* nodes, const size_t count,
+                  const NodeInfoField field, uint32_t* values) {
+  extract<sizeof(NodeInfo) / sizeof(uint64_t)>(nodes, count,
+                                              GetBitField(field), values);
+}
+
+}
+}
@@ -0,0 +1,197 @@
+#include "baldr/shapedecoder.h"
+
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+using namespace valhalla::midgard;
+
+namespace {
+
+// Number of encoded bytes classified at a time. Values that straddle the
+// end of a chunk are picked up again at the start of the next one.
+constexpr size_t kChunkSize = 256;
+
+// Longest varint (in bytes) the fast path assembles. 7 x 5 bits covers any
+// 32 bit zig-zag value.
+constexpr size_t kMaxVarintSize = 7;
+
+// Inverse of the polyline precision
+constexpr double kInvPrecision = 1e-6;
+
+// Mask of the low n bytes of a 64 bit word (n <= 7)
+constexpr uint64_t kByteMasks[] = {
+  0x0000000000000000ULL, 0x00000000000000FFULL, 0x000000000000FFFFULL,
+  0x0000000000FFFFFFULL, 0x00000000FFFFFFFFULL, 0x000000FFFFFFFFFFULL,
+  0x0000FFFFFFFFFFFFULL, 0x00FFFFFFFFFFFFFFULL
+};
+
+#if defined(__SSE2__) && defined(__GNUC__)
+// The AVX2 classifier is compiled for AVX2 whatever the build flags and used
+// only when the CPU supports it
+#define VALHALLA_AVX2_DISPATCH
+
+/**
+ * Classify the encoded bytes 32 at a time with AVX2 (see classify).
+ * @param  encoded   Encoded bytes.
+ * @param  n         Number of bytes (<= kChunkSize).
+ * @param  payload   (OUT) 5 bit payload per byte.
+ * @param  mask      (OUT) Terminator bit mask, must be zeroed.
+ * @return  Returns the number of bytes classified, a multiple of 32.
+ */
+__attribute__((target("avx2")))
+size_t classify_avx2(const char* encoded, const size_t n, uint8_t* payload,
+                     uint64_t* mask) {
+  const __m256i offset32 = _mm256_set1_epi8(63);
+  const __m256i bits32 = _mm256_set1_epi8(0x1f);
+  const __m256i cont32 = _mm256_set1_epi8(0x20);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i v = _mm256_sub_epi8(_mm256_loadu_si256(
+                  reinterpret_cast<const __m256i*>(encoded + i)), offset32);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(payload + i),
+                        _mm256_and_si256(v, bits32));
+    uint32_t t = static_cast<uint32_t>(_mm256_movemask_epi8(
+                   _mm256_cmpgt_epi8(cont32, v)));
+    mask[i >> 6] |= static_cast<uint64_t>(t) << (i & 63);
+  }
+  return i;
+}
+
+// Does the CPU support AVX2, checked once
+bool has_avx2() {
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  return avx2;
+}
+#endif
+
+/**
+ * Classify the encoded bytes. Writes the 5 bit payload of each byte and
+ * sets a bit in the terminator mask for every byte that ends a varint
+ * (continuation flag 0x20 not set).
+ * @param  encoded   Encoded bytes.
+ * @param  n         Number of bytes (<= kChunkSize).
+ * @param  payload   (OUT) 5 bit payload per byte.
+ * @param  mask      (OUT) Terminator bit mask, 64 bytes per word.
+ */
+void classify(const char* encoded, const size_t n, uint8_t* payload,
+              uint64_t* mask) {
+  memset(mask, 0, (kChunkSize / 64) * sizeof(uint64_t));
+  size_t i = 0;
+#if defined(VALHALLA_AVX2_DISPATCH)
+  if (has_avx2()) {
+    i = classify_avx2(encoded, n, payload, mask);
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128i offset16 = _mm_set1_epi8(63);
+  const __m128i bits16 = _mm_set1_epi8(0x1f);
+  const __m128i cont16 = _mm_set1_epi8(0x20);
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_sub_epi8(_mm_loadu_si128(
+                  reinterpret_cast<const __m128i*>(encoded + i)), offset16);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(payload + i),
+                     _mm_and_si128(v, bits16));
+    uint32_t t = static_cast<uint32_t>(_mm_movemask_epi8(
+                   _mm_cmplt_epi8(v, cont16)));
+    mask[i >> 6] |= static_cast<uint64_t>(t) << (i & 63);
+  }
+#endif
+  // Scalar fallback and tail
+  for (; i < n; ++i) {
+    int32_t byte = static_cast<int32_t>(encoded[i]) - 63;
+    payload[i] = static_cast<uint8_t>(byte & 0x1f);
+    if (byte < 0x20) {
+      mask[i >> 6] |= 1ULL << (i & 63);
+    }
+  }
+}
+
+/**
+ * Assemble a varint from its bytes' 5 bit payloads (least significant
+ * first). Gathers up to 8 payload bytes from one 64 bit load by merging
+ * neighbouring fields in 3 steps rather than looping over the bytes.
+ * @param  payload  Pointer to the first payload byte. At least 8 bytes
+ *                  must be readable.
+ * @param  n        Number of bytes in the varint.
+ * @return Returns the assembled (zig-zag encoded) value.
+ */
+uint32_t assemble(const uint8_t* payload, const size_t n) {
+  if (n > kMaxVarintSize) {
+    // Malformed/oversized value. Assemble it the slow way.
+    uint32_t result = 0;
+    for (size_t i = 0; i < n; ++i) {
+      result |= static_cast<uint32_t>(payload[i]) << (5 * i);
+    }
+    return result;
+  }
+  uint64_t x;
+  memcpy(&x, payload, sizeof(x));
+  x &= kByteMasks[n];
+  x = (x & 0x001F001F001F001FULL) | ((x & 0x1F001F001F001F00ULL) >> 3);
+  x = (x & 0x000003FF000003FFULL) | ((x & 0x03FF000003FF0000ULL) >> 6);
+  x = (x & 0x00000000000FFFFFULL) | ((x & 0x000FFFFF00000000ULL) >> 12);
+  return static_cast<uint32_t>(x);
+}
+
+// Count trailing zeros of a non zero word
+inline uint32_t ctz(const uint64_t x) {
+  return static_cast<uint32_t>(__builtin_ctzll(x));
+}
+
+}
+
+namespace valhalla {
+namespace baldr {
+
+// Decode encoded polyline bytes and append the points to the shape.
+size_t DecodePolyline(const char* encoded, const size_t size,
+                      std::vector<PointLL>& shape) {
+  // Payload has padding so the 8 byte load in assemble never reads past it
+  uint8_t payload[kChunkSize + sizeof(uint64_t)];
+  uint64_t mask[kChunkSize / 64];
+
+  size_t initial = shape.size();
+  shape.reserve(initial + size / 4);
+  int32_t values[2] = { 0, 0 };   // lat, lng
+  uint32_t which = 0;
+  size_t pos = 0;
+  while (pos < size) {
+    size_t n = std::min(kChunkSize, size - pos);
+    classify(encoded + pos, n, payload, mask);
+    memset(payload + n, 0, sizeof(uint64_t));
+
+    // Walk the terminators. Each one ends a value that started right after
+    // the previous terminator.
+    size_t start = 0;
+    for (size_t w = 0; w < kChunkSize / 64; ++w) {
+      uint64_t bits = mask[w];
+      while (bits) {
+        size_t end = (w << 6) + ctz(bits);
+        bits &= bits - 1;
+        uint32_t v = assemble(payload + start, end - start + 1);
+        values[which] += static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+        if (which == 1) {
+          shape.emplace_back(static_cast<float>(values[1] * kInvPrecision),
+                             static_cast<float>(values[0] * kInvPrecision));
+        }
+        which ^= 1;
+        start = end + 1;
+      }
+    }
+
+    // No complete value in a full chunk or trailing unterminated bytes
+    // means the input is malformed (or truncated), stop here
+    if (start == 0) {
+      break;
+    }
+    pos += start;
+  }
+  return shape.size() - initial;
+}
+
+}
+}
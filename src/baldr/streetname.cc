@@ -7,8 +7,9 @@
 namespace valhalla {
 namespace baldr {
 
-StreetName::StreetName(const std::string& value)
-    : value_(value) {
+StreetName::StreetName(const std::string& value, const uint32_t id)
+    : value_(value),
+      id_(id) {
 }
 
 StreetName::~StreetName() {
@@ -18,7 +19,14 @@ const std::string& StreetName::value() const {
   return value_;
 }
 
+uint32_t StreetName::id() const {
+  return id_;
+}
+
 bool StreetName::operator ==(const StreetName& rhs) const {
+  // Interned ids are unique per name so there is no need to compare text
+  if (id_ != kInvalidNameId && rhs.id_ != kInvalidNameId)
+    return (id_ == rhs.id_);
   return (value_ == rhs.value_);
 }
 
@@ -15,7 +15,8 @@ const std::vector<std::string> StreetNameUs::post_dirs_ { " North", " East",
 const std::vector<std::string> StreetNameUs::post_cardinal_dirs_ { " North",
     " East", " South", " West" };
 
-StreetNameUs::StreetNameUs(const std::string& value) : StreetName(value) {
+StreetNameUs::StreetNameUs(const std::string& value, const uint32_t id)
+    : StreetName(value, id) {
 }
 
 std::string StreetNameUs::GetPreDir() const {
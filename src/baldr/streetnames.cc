@@ -13,9 +13,10 @@ StreetNames::StreetNames()
     : std::list<std::unique_ptr<StreetName>>() {
 }
 
-StreetNames::StreetNames(const std::vector<std::string>& names) {
+StreetNames::StreetNames(const std::vector<std::string>& names, const bool intern) {
   for (auto& name : names) {
-    this->emplace_back(midgard::make_unique<StreetName>(name));
+    this->emplace_back(midgard::make_unique<StreetName>(name,
+        intern ? NameInterner::Get().Intern(name) : kInvalidNameId));
   }
 }
 
@@ -68,7 +69,8 @@ std::unique_ptr<StreetNames> StreetNames::clone() const {
       StreetNames>();
   for (const auto& street_name : *this) {
     clone_street_names->emplace_back(
-        midgard::make_unique<StreetName>(street_name->value()));
+        midgard::make_unique<StreetName>(street_name->value(),
+            street_name->id()));
   }
 
   return clone_street_names;
@@ -82,7 +84,8 @@ std::unique_ptr<StreetNames> StreetNames::FindCommonStreetNames(
     for (const auto& other_street_name : other_street_names) {
       if (*street_name == *other_street_name) {
         common_street_names->emplace_back(
-            midgard::make_unique<StreetName>(street_name->value()));
+            midgard::make_unique<StreetName>(street_name->value(),
+                street_name->id()));
         break;
       }
     }
@@ -102,14 +105,17 @@ std::unique_ptr<StreetNames> StreetNames::FindCommonBaseNames(
         // thus, 'US 30 West' will be used instead of 'US 30'
         if (!street_name->GetPostCardinalDir().empty())
           common_base_names->emplace_back(
-              midgard::make_unique<StreetName>(street_name->value()));
+              midgard::make_unique<StreetName>(street_name->value(),
+                  street_name->id()));
         else if (!other_street_name->GetPostCardinalDir().empty())
           common_base_names->emplace_back(
-              midgard::make_unique<StreetName>(other_street_name->value()));
+              midgard::make_unique<StreetName>(other_street_name->value(),
+                  other_street_name->id()));
         // Use street_name by default
         else
           common_base_names->emplace_back(
-              midgard::make_unique<StreetName>(street_name->value()));
+              midgard::make_unique<StreetName>(street_name->value(),
+                  street_name->id()));
         break;
       }
     }
@@ -10,12 +10,13 @@ namespace valhalla {
 namespace baldr {
 
 std::unique_ptr<StreetNames> StreetNamesFactory::Create(
-    const std::string& country_code, const std::vector<std::string>& names) {
+    const std::string& country_code, const std::vector<std::string>& names,
+    const bool intern) {
   if (country_code == "US") {
-    return midgard::make_unique<StreetNamesUs>(names);
+    return midgard::make_unique<StreetNamesUs>(names, intern);
   }
 
-  return midgard::make_unique<StreetNames>(names);
+  return midgard::make_unique<StreetNames>(names, intern);
 }
 
 }
@@ -12,9 +12,10 @@ StreetNamesUs::StreetNamesUs()
     : StreetNames() {
 }
 
-StreetNamesUs::StreetNamesUs(const std::vector<std::string>& names) {
+StreetNamesUs::StreetNamesUs(const std::vector<std::string>& names, const bool intern) {
   for (auto& name : names) {
-    this->emplace_back(midgard::make_unique<StreetNameUs>(name));
+    this->emplace_back(midgard::make_unique<StreetNameUs>(name,
+        intern ? NameInterner::Get().Intern(name) : kInvalidNameId));
   }
 }
 
@@ -26,7 +27,8 @@ std::unique_ptr<StreetNames> StreetNamesUs::clone() const {
       StreetNamesUs>();
   for (const auto& street_name : *this) {
     clone_street_names->emplace_back(
-        midgard::make_unique<StreetNameUs>(street_name->value()));
+        midgard::make_unique<StreetNameUs>(street_name->value(),
+            street_name->id()));
   }
 
   return clone_street_names;
@@ -40,7 +42,8 @@ std::unique_ptr<StreetNames> StreetNamesUs::FindCommonStreetNames(
     for (const auto& other_street_name : other_street_names) {
       if (*street_name == *other_street_name) {
         common_street_names->emplace_back(
-            midgard::make_unique<StreetNameUs>(street_name->value()));
+            midgard::make_unique<StreetNameUs>(street_name->value(),
+                street_name->id()));
         break;
       }
     }
@@ -60,14 +63,17 @@ std::unique_ptr<StreetNames> StreetNamesUs::FindCommonBaseNames(
         // thus, 'US 30 West' will be used instead of 'US 30'
         if (!street_name->GetPostCardinalDir().empty())
           common_base_names->emplace_back(
-              midgard::make_unique<StreetNameUs>(street_name->value()));
+              midgard::make_unique<StreetNameUs>(street_name->value(),
+                  street_name->id()));
         else if (!other_street_name->GetPostCardinalDir().empty())
           common_base_names->emplace_back(
-              midgard::make_unique<StreetNameUs>(other_street_name->value()));
+              midgard::make_unique<StreetNameUs>(other_street_name->value(),
+                  other_street_name->id()));
         // Use street_name by default
         else
           common_base_names->emplace_back(
-              midgard::make_unique<StreetNameUs>(street_name->value()));
+              midgard::make_unique<StreetNameUs>(street_name->value(),
+                  street_name->id()));
         break;
       }
     }
@@ -36,6 +36,10 @@ TileHierarchy::TileHierarchy(const boost::property_tree::ptree& pt) {
   //if we didn't have any levels that is just not usable
   if(levels_.empty())
     throw std::runtime_error("Expected 1 or more levels in the tile hierarchy");
+
+  //the paths need enough digits for the largest tile id of each level
+  for(const auto& level : levels_)
+    tile_path_.AddLevel(level.first, Tiles<PointLL>::MaxTileId(AABB2<PointLL>(PointLL(-180, -90), PointLL(180, 90)), level.second.tiles.TileSize()));
 }
 
 TileHierarchy::TileHierarchy(){}
@@ -52,6 +56,10 @@ bool TileHierarchy::HasLevel(const unsigned char level) const {
   return levels_.find(level) != levels_.end();
 }
 
+const TilePath& TileHierarchy::tile_path() const {
+  return tile_path_;
+}
+
 GraphId TileHierarchy::GetGraphId(const midgard::PointLL& pointll, const unsigned char level) const {
   GraphId id;
   const auto& tl = levels_.find(level);
@@ -0,0 +1,186 @@
+#include "baldr/tilepath.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+
+constexpr char kExtension[] = ".gph";
+constexpr size_t kExtensionLength = sizeof(kExtension) - 1;
+
+// Is the name a tile file name
+bool IsTileName(const char* name, const size_t length) {
+  return length > kExtensionLength &&
+         std::memcmp(name + length - kExtensionLength, kExtension, kExtensionLength) == 0;
+}
+
+}
+
+namespace valhalla {
+namespace baldr {
+
+// Constructor for no levels.
+TilePath::TilePath() {
+  std::fill(groups_, groups_ + 256, -1);
+}
+
+// Adds a level.
+void TilePath::AddLevel(const uint8_t level, const uint32_t max_id) {
+  // Enough groups of 3 digits for the largest tile id
+  int8_t groups = 0;
+  for (uint32_t id = max_id; id > 0; id /= 1000) {
+    groups++;
+  }
+  groups_[level] = groups;
+}
+
+// Formats the path of a tile into a buffer.
+size_t TilePath::Format(const GraphId& graphid, char* buffer) const {
+  uint32_t level = graphid.level();
+  int8_t groups = groups_[level];
+  if (groups < 0) {
+    throw std::runtime_error("Could not compute FileSuffix for non-existent level");
+  }
+
+  // The level without leading zeros
+  char* out = buffer;
+  if (level >= 100) {
+    *out++ = '0' + level / 100;
+  }
+  if (level >= 10) {
+    *out++ = '0' + level / 10 % 10;
+  }
+  *out++ = '0' + level % 10;
+
+  // The groups of the tile id, written from the last one
+  uint32_t id = graphid.tileid();
+  out += 4 * groups;
+  for (char* group = out; group != out - 4 * groups; id /= 1000) {
+    group -= 4;
+    group[0] = '/';
+    group[1] = '0' + id / 100 % 10;
+    group[2] = '0' + id / 10 % 10;
+    group[3] = '0' + id % 10;
+  }
+  std::memcpy(out, kExtension, kExtensionLength + 1);
+  return out + kExtensionLength - buffer;
+}
+
+// Gets the path of a tile.
+std::string TilePath::Path(const GraphId& graphid) const {
+  char buffer[kMaxLength];
+  return std::string(buffer, Format(graphid, buffer));
+}
+
+// Gets the full path of a tile file, or of a file kept next to it.
+std::string TilePath::FullPath(const std::string& dir, const GraphId& graphid,
+                               const char* extension) const {
+  char buffer[kMaxLength];
+  size_t length = Format(graphid, buffer) - kExtensionLength;
+  size_t extension_length = std::strlen(extension);
+  std::string path;
+  path.reserve(dir.size() + 1 + length + extension_length);
+  path.append(dir).append(1, '/').append(buffer, length).append(extension, extension_length);
+  return path;
+}
+
+// Parses the tile path at the end of a file path.
+GraphId TilePath::Parse(const char* path, const size_t length) const {
+  if (!IsTileName(path, length)) {
+    return {};
+  }
+
+  // Read the directories back from the extension. Each one is either the
+  // level, if it has the number of groups read so far, or another group.
+  size_t end = length - kExtensionLength;
+  uint32_t id = 0;
+  uint32_t multiplier = 1;
+  for (int8_t groups = 0; groups <= 4; groups++) {
+    size_t start = end;
+    uint32_t value = 0;
+    while (start > 0 && path[start - 1] != '/') {
+      start--;
+    }
+    if (start == end || end - start > 3) {
+      return {};
+    }
+    for (size_t i = start; i < end; i++) {
+      if (path[i] < '0' || path[i] > '9') {
+        return {};
+      }
+      value = value * 10 + (path[i] - '0');
+    }
+    bool canonical = end - start == 1 || path[start] != '0';
+    if (canonical && value < 256 && groups_[value] == groups) {
+      return {id, value, 0};
+    }
+    if (end - start != 3 || groups == 4 || start == 0) {
+      return {};
+    }
+    id += value * multiplier;
+    multiplier *= 1000;
+    end = start - 1;
+  }
+  return {};
+}
+
+// Finds the tile files under a directory.
+std::vector<GraphId> TilePath::FindTiles(const std::string& dir, const bool recursive) const {
+  std::vector<GraphId> tiles;
+  std::string path = dir;
+  if (path.empty() || path.back() != '/') {
+    path.push_back('/');
+  }
+
+  // Directories still to read. Entry names are appended to the path of the
+  // directory being read, so most entries need no allocation.
+  std::vector<std::string> pending(1, path);
+  while (!pending.empty()) {
+    path.swap(pending.back());
+    pending.pop_back();
+    DIR* handle = opendir(path.c_str());
+    if (handle == nullptr) {
+      continue;
+    }
+    size_t base = path.size();
+    while (const dirent* entry = readdir(handle)) {
+      const char* name = entry->d_name;
+      size_t name_length = std::strlen(name);
+      if (name[0] == '.' && (name_length == 1 || (name_length == 2 && name[1] == '.'))) {
+        continue;
+      }
+      path.resize(base);
+      path.append(name, name_length);
+
+      // Only look up the type when the directory entry does not have it.
+      // Links to files are followed, links to directories are not.
+      unsigned char type = entry->d_type;
+      bool link = (type == DT_LNK);
+      if (type == DT_UNKNOWN || link) {
+        struct stat status;
+        if (stat(path.c_str(), &status) != 0) {
+          continue;
+        }
+        type = S_ISDIR(status.st_mode) ? DT_DIR : (S_ISREG(status.st_mode) ? DT_REG : DT_UNKNOWN);
+      }
+      if (type == DT_DIR) {
+        if (recursive && !link) {
+          pending.push_back(path + '/');
+        }
+      } else if (type == DT_REG && IsTileName(name, name_length)) {
+        GraphId tile = Parse(path.data(), path.size());
+        if (tile.Is_Valid()) {
+          tiles.push_back(tile);
+        }
+      }
+    }
+    closedir(handle);
+  }
+  return tiles;
+}
+
+}
+}
@@ -0,0 +1,255 @@
+#include "baldr/tilereorder.h"
+#include "baldr/celloverlay.h"
+#include "baldr/graphreader.h"
+#include "baldr/nodecomponents.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <valhalla/midgard/logging.h>
+
+namespace {
+
+constexpr uint32_t kHilbertSize = 65536;
+
+}
+
+namespace valhalla {
+namespace baldr {
+
+// Tile with access to its sections for rewriting
+class ReorderableTile : public GraphTile {
+ public:
+  using GraphTile::GraphTile;
+
+  // Rewrite the tile with the nodes and directed edges renumbered
+  std::string Reorder(const std::unordered_map<GraphId, TileOrder>& orders) const;
+};
+
+// Distance along a Hilbert curve to a cell of the grid.
+uint32_t HilbertIndex(uint32_t x, uint32_t y) {
+  uint32_t d = 0;
+  for (uint32_t s = kHilbertSize / 2; s > 0; s /= 2) {
+    uint32_t rx = (x & s) > 0;
+    uint32_t ry = (y & s) > 0;
+    d += s * s * ((3 * rx) ^ ry);
+    // Rotate the quadrant so the curve within it has the base orientation
+    if (ry == 0) {
+      if (rx == 1) {
+        x = kHilbertSize - 1 - x;
+        y = kHilbertSize - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+// Order the nodes of a tile along a Hilbert curve.
+TileOrder HilbertOrder(const GraphTile& tile, const TileHierarchy& hierarchy) {
+  // Position of each node along the curve over the tile bounding box
+  auto box = tile.BoundingBox(hierarchy);
+  auto cell = [](const float value, const float min, const float max) {
+    float scaled = (value - min) / (max - min) * (kHilbertSize - 1);
+    return static_cast<uint32_t>(std::min(std::max(scaled, 0.0f),
+                                          static_cast<float>(kHilbertSize - 1)));
+  };
+  uint32_t nodecount = tile.header()->nodecount();
+  std::vector<std::pair<uint32_t, uint32_t> > curve(nodecount);
+  for (uint32_t i = 0; i < nodecount; ++i) {
+    const auto& ll = tile.node(i)->latlng();
+    curve[i] = std::make_pair(HilbertIndex(cell(ll.lng(), box.minx(), box.maxx()),
+                                           cell(ll.lat(), box.miny(), box.maxy())), i);
+  }
+  std::sort(curve.begin(), curve.end());
+
+  // Directed edges follow their nodes
+  TileOrder order;
+  order.nodes.resize(nodecount);
+  order.edges.resize(tile.header()->directededgecount());
+  uint32_t edge_index = 0;
+  for (uint32_t i = 0; i < nodecount; ++i) {
+    const NodeInfo* node = tile.node(curve[i].second);
+    order.nodes[curve[i].second] = i;
+    for (uint32_t j = 0; j < node->edge_count(); ++j) {
+      if (node->edge_index() + j >= order.edges.size()) {
+        throw std::runtime_error("Node edges exceed the directed edge count");
+      }
+      order.edges[node->edge_index() + j] = edge_index++;
+    }
+  }
+  if (edge_index != order.edges.size()) {
+    throw std::runtime_error("Directed edges must each belong to one node");
+  }
+  return order;
+}
+
+// Rewrite the tile with the nodes and directed edges renumbered.
+std::string ReorderableTile::Reorder(
+    const std::unordered_map<GraphId, TileOrder>& orders) const {
+  const char* base = reinterpret_cast<const char*>(header_);
+  std::string bytes(base, size_);
+  auto write = [&bytes, base](const void* section, const void* data, const size_t size) {
+    if (size > 0) {
+      std::copy(static_cast<const char*>(data), static_cast<const char*>(data) + size,
+                bytes.begin() + (static_cast<const char*>(section) - base));
+    }
+  };
+
+  // New id of an edge or node given the orders of the tiles
+  auto remap = [&orders](const GraphId& id, const bool node) {
+    auto found = orders.find(id.Tile_Base());
+    if (found == orders.end()) {
+      return id;
+    }
+    const auto& order = node ? found->second.nodes : found->second.edges;
+    if (id.id() >= order.size()) {
+      throw std::runtime_error("Graph id " + std::to_string(id.value) + " is not in its tile");
+    }
+    return GraphId(id.tileid(), id.level(), order[id.id()]);
+  };
+  auto found = orders.find(header_->graphid().Tile_Base());
+  if (found == orders.end()) {
+    throw std::runtime_error("No order for tile " + std::to_string(header_->graphid().value));
+  }
+  const TileOrder& order = found->second;
+
+  // Nodes in their new order, each followed by its directed edges
+  uint32_t nodecount = header_->nodecount();
+  uint32_t edgecount = header_->directededgecount();
+  std::vector<NodeInfo> nodes(nodecount);
+  std::vector<DirectedEdge> edges(edgecount);
+  for (uint32_t i = 0; i < nodecount; ++i) {
+    NodeInfo& node = nodes[order.nodes[i]];
+    node = nodes_[i];
+    if (node.edge_count() > 0) {
+      node.set_edge_index(order.edges[nodes_[i].edge_index()]);
+    }
+  }
+  uint32_t edge_index = 0;
+  for (auto& node : nodes) {
+    if (node.edge_count() == 0) {
+      node.set_edge_index(edge_index);
+    }
+    edge_index = node.edge_index() + node.edge_count();
+  }
+  for (uint32_t i = 0; i < edgecount; ++i) {
+    DirectedEdge& edge = edges[order.edges[i]];
+    edge = directededges_[i];
+    edge.set_endnode(remap(edge.endnode(), true));
+  }
+  write(nodes_, nodes.data(), nodecount * sizeof(NodeInfo));
+  write(directededges_, edges.data(), edgecount * sizeof(DirectedEdge));
+
+  // Signs and access restrictions are sorted by directed edge index
+  std::vector<Sign> signs(signs_, signs_ + header_->signcount());
+  for (auto& sign : signs) {
+    sign.set_edgeindex(order.edges[sign.edgeindex()]);
+  }
+  std::stable_sort(signs.begin(), signs.end(), [](const Sign& a, const Sign& b) {
+    return a.edgeindex() < b.edgeindex();
+  });
+  write(signs_, signs.data(), signs.size() * sizeof(Sign));
+  std::vector<AccessRestriction> restrictions(access_restrictions_,
+      access_restrictions_ + header_->access_restriction_count());
+  for (auto& restriction : restrictions) {
+    restriction.set_edgeindex(order.edges[restriction.edgeindex()]);
+  }
+  std::stable_sort(restrictions.begin(), restrictions.end());
+  write(access_restrictions_, restrictions.data(),
+        restrictions.size() * sizeof(AccessRestriction));
+
+  // Edge cells
+  std::vector<GraphId> cells(edge_cells_,
+      edge_cells_ + header_->cell_offset(kGridDim - 1, kGridDim - 1).second);
+  for (auto& cell : cells) {
+    cell = remap(cell, false);
+  }
+  write(edge_cells_, cells.data(), cells.size() * sizeof(GraphId));
+  return bytes;
+}
+
+// Rewrite a tile with its nodes and directed edges renumbered.
+std::string ReorderTile(const TileHierarchy& hierarchy, const GraphId& graphid,
+                        const std::unordered_map<GraphId, TileOrder>& orders) {
+  ReorderableTile tile(hierarchy, graphid);
+  if (tile.size() == 0) {
+    throw std::runtime_error("Could not load tile " + std::to_string(graphid.value));
+  }
+  return tile.Reorder(orders);
+}
+
+// Rewrite all the tiles with their nodes in Hilbert order.
+size_t ReorderTiles(const TileHierarchy& hierarchy) {
+  // Find the tiles of each level
+  std::vector<GraphId> tiles;
+  for (const auto& level : hierarchy.levels()) {
+    auto level_tiles = GraphReader::GetTileSet(hierarchy, level.first);
+    tiles.insert(tiles.end(), level_tiles.begin(), level_tiles.end());
+  }
+
+  // Order every tile before rewriting any, end nodes refer to other tiles
+  std::unordered_map<GraphId, TileOrder> orders;
+  for (const auto& id : tiles) {
+    GraphTile tile(hierarchy, id);
+    if (tile.size() == 0) {
+      throw std::runtime_error("Could not load tile " + std::to_string(id.value));
+    }
+    orders.emplace(id, HilbertOrder(tile, hierarchy));
+  }
+
+  // Write every tile to a temporary file before replacing any, so that a
+  // failure leaves the tiles as they were
+  std::vector<std::string> locations;
+  auto remove_temp_files = [&locations](const size_t from) {
+    for (size_t i = from; i < locations.size(); i++) {
+      std::remove((locations[i] + ".tmp").c_str());
+    }
+  };
+  for (const auto& id : tiles) {
+    std::string bytes = ReorderTile(hierarchy, id, orders);
+    locations.push_back(hierarchy.tile_path().FullPath(hierarchy.tile_dir(), id));
+    std::ofstream file(locations.back() + ".tmp", std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), bytes.size());
+    file.close();
+    if (!file) {
+      remove_temp_files(0);
+      throw std::runtime_error("Could not write tile " + locations.back());
+    }
+  }
+
+  // Replace the tiles, keeping each old tile as a backup until all of them
+  // are replaced so that a failed rename can put the old tiles back
+  auto restore = [&locations](const size_t count) {
+    bool restored = true;
+    for (size_t i = 0; i < count; i++) {
+      if (std::rename((locations[i] + ".bak").c_str(), locations[i].c_str()) != 0) {
+        LOG_ERROR("Could not restore tile " + locations[i] + " from its backup");
+        restored = false;
+      }
+    }
+    return restored;
+  };
+  for (size_t i = 0; i < tiles.size(); i++) {
+    bool backed_up = std::rename(locations[i].c_str(), (locations[i] + ".bak").c_str()) == 0;
+    if (!backed_up || std::rename((locations[i] + ".tmp").c_str(), locations[i].c_str()) != 0) {
+      bool restored = restore(backed_up ? i + 1 : i);
+      remove_temp_files(i);
+      throw std::runtime_error("Could not replace tile " + locations[i] +
+                               (restored ? "" : ", some tiles are left as .bak files"));
+    }
+  }
+
+  // Their component labels and overlays refer to the old order, remove them
+  for (size_t i = 0; i < tiles.size(); i++) {
+    std::remove((locations[i] + ".bak").c_str());
+    std::remove(NodeComponents::FileName(tiles[i], hierarchy).c_str());
+    std::remove(CellOverlay::FileName(tiles[i], hierarchy).c_str());
+    LOG_DEBUG("Reordered tile " + locations[i]);
+  }
+  return tiles.size();
+}
+
+}
+}
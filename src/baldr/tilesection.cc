@@ -0,0 +1,48 @@
+#include "baldr/tilesection.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace valhalla {
+namespace baldr {
+
+// Serialize a tile in the version 2 format.
+std::string SerializeTile(GraphTileHeader header,
+    const std::vector<std::pair<TileSection::Type, std::string> >& sections) {
+  // Lay out the sections after the header and table of contents
+  std::vector<TileSection> toc;
+  size_t offset = sizeof(GraphTileHeader) + sections.size() * sizeof(TileSection);
+  for (const auto& section : sections) {
+    offset = (offset + kTileSectionAlignment - 1) / kTileSectionAlignment * kTileSectionAlignment;
+    if (offset + section.second.size() > std::numeric_limits<uint32_t>::max()) {
+      throw std::runtime_error("Tile exceeds the maximum size");
+    }
+    toc.push_back({static_cast<uint32_t>(section.first), static_cast<uint32_t>(offset),
+                   static_cast<uint32_t>(section.second.size()), kTileSectionAlignment});
+    offset += section.second.size();
+
+    // Keep the offsets of the variable size sections in the header as well
+    if (section.first == TileSection::Type::kEdgeInfo) {
+      header.set_edgeinfo_offset(toc.back().offset);
+    } else if (section.first == TileSection::Type::kTextList) {
+      header.set_textlist_offset(toc.back().offset);
+    } else if (section.first == TileSection::Type::kQuantizedShapes) {
+      header.set_quantized_shape_offset(toc.back().offset);
+    }
+  }
+  header.set_format_version(kTileFormatV2);
+  header.set_section_count(sections.size());
+
+  std::string tile(offset, '\0');
+  std::copy_n(reinterpret_cast<const char*>(&header), sizeof(GraphTileHeader), &tile[0]);
+  std::copy_n(reinterpret_cast<const char*>(toc.data()), toc.size() * sizeof(TileSection),
+              &tile[sizeof(GraphTileHeader)]);
+  for (size_t i = 0; i < sections.size(); ++i) {
+    std::copy(sections[i].second.begin(), sections[i].second.end(), &tile[toc[i].offset]);
+  }
+  return tile;
+}
+
+}
+}
@@ -0,0 +1,98 @@
+#include "baldr/tilesidecar.h"
+
+#include <cstdio>
+#include <fstream>
+#include <valhalla/midgard/logging.h>
+
+namespace {
+
+// Start of a sidecar file
+struct SidecarHeader {
+  uint32_t version;
+  uint32_t nodecount;
+  uint64_t tile;
+  uint64_t fingerprint;
+};
+
+}
+
+namespace valhalla {
+namespace baldr {
+
+// Constructor for no data.
+TileSidecar::TileSidecar()
+    : nodecount_(0),
+      fingerprint_(0) {
+}
+
+// Constructor for data built from a tile.
+TileSidecar::TileSidecar(const GraphTile& tile)
+    : tile_(tile.id().Tile_Base()),
+      nodecount_(tile.header()->nodecount()),
+      fingerprint_(tile.fingerprint()) {
+}
+
+// Get the tile the data was built from.
+GraphId TileSidecar::tile() const {
+  return tile_;
+}
+
+// Get the number of nodes of the tile the data was built from.
+uint32_t TileSidecar::nodecount() const {
+  return nodecount_;
+}
+
+// Get the fingerprint of the tile the data was built from.
+uint64_t TileSidecar::fingerprint() const {
+  return fingerprint_;
+}
+
+// Was the data built from this tile, as it is now?
+bool TileSidecar::Matches(const GraphTile& tile) const {
+  return tile_ == tile.id().Tile_Base() && nodecount_ == tile.header()->nodecount() &&
+         fingerprint_ == tile.fingerprint();
+}
+
+// Read a sidecar file.
+bool TileSidecar::Read(const std::string& file, const uint32_t version,
+                       const std::function<void (std::istream&, const uint32_t)>& read_body) {
+  std::ifstream in(file, std::ios::in | std::ios::binary);
+  if (!in.is_open()) {
+    LOG_DEBUG(file + " was not found");
+    return false;
+  }
+  SidecarHeader header;
+  if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      header.version != version) {
+    LOG_ERROR(file + " has an unsupported format");
+    return false;
+  }
+  read_body(in, header.nodecount);
+  if (!in) {
+    LOG_ERROR(file + " is truncated");
+    return false;
+  }
+  tile_ = GraphId(header.tile);
+  nodecount_ = header.nodecount;
+  fingerprint_ = header.fingerprint;
+  return true;
+}
+
+// Write the header and the data through a temporary file.
+bool TileSidecar::Write(const std::string& file, const uint32_t version,
+                        const std::function<void (std::ostream&)>& write_body) const {
+  std::string temp_file = file + ".tmp";
+  std::ofstream out(temp_file, std::ios::out | std::ios::binary | std::ios::trunc);
+  SidecarHeader header{version, nodecount_, tile_.value, fingerprint_};
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  write_body(out);
+  out.close();
+  if (!out || std::rename(temp_file.c_str(), file.c_str()) != 0) {
+    std::remove(temp_file.c_str());
+    return false;
+  }
+  return true;
+}
+
+}
+}
@@ -0,0 +1,39 @@
+#include "baldr/connectivity_map.h"
+#include "baldr/nodecomponents.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <boost/property_tree/json_parser.hpp>
+#include <valhalla/midgard/logging.h>
+
+using namespace valhalla::baldr;
+
+// Builds the connectivity map of a tile set and the component labels of its
+// nodes and saves them next to the tiles, so that services read them rather
+// than build them. Run it again whenever the tiles change.
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    std::cerr << "Usage: " << argv[0] << " config.json [threads]" << std::endl;
+    std::cerr << "Writes the connectivity map of the tiles in "
+                 "mjolnir.hierarchy.tile_dir to connectivity.bin and the "
+                 "component labels of each tile to its .scc file" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    boost::property_tree::ptree pt;
+    boost::property_tree::read_json(argv[1], pt);
+    TileHierarchy hierarchy(pt.get_child("mjolnir.hierarchy"));
+    size_t threads = argc == 3 ? std::strtoul(argv[2], nullptr, 10) : 0;
+    size_t count = connectivity_map_t::build(hierarchy, threads);
+    LOG_INFO("Wrote the connectivity of " + std::to_string(count) + " tiles to " +
+             connectivity_map_t::file_name(hierarchy));
+    count = BuildComponents(hierarchy);
+    LOG_INFO("Labeled the node components of " + std::to_string(count) + " tiles");
+  }
+  catch (const std::exception& e) {
+    LOG_ERROR(e.what());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,37 @@
+#include "baldr/tilereorder.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <boost/property_tree/json_parser.hpp>
+#include <valhalla/midgard/logging.h>
+
+using namespace valhalla::baldr;
+
+// Rewrites the tiles of a tile set with their nodes and directed edges in a
+// locality preserving order. Run it on a complete tile set that no service
+// is reading from, then run valhalla_build_connectivity again.
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " config.json" << std::endl;
+    std::cerr << "Reorders the nodes and directed edges of the tiles in "
+                 "mjolnir.hierarchy.tile_dir along a Hilbert curve. No tile is "
+                 "replaced unless all of them could be written. The .scc and "
+                 ".ovl files of the tiles are removed, run "
+                 "valhalla_build_connectivity and rebuild the overlays "
+                 "afterwards" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    boost::property_tree::ptree pt;
+    boost::property_tree::read_json(argv[1], pt);
+    TileHierarchy hierarchy(pt.get_child("mjolnir.hierarchy"));
+    size_t count = ReorderTiles(hierarchy);
+    LOG_INFO("Reordered " + std::to_string(count) + " tiles");
+  }
+  catch (const std::exception& e) {
+    LOG_ERROR(e.what());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
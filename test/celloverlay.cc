@@ -0,0 +1,282 @@
+#include "test.h"
+
+#include "baldr/celloverlay.h"
+
+#include <fstream>
+#include <functional>
+#include <map>
+#include <queue>
+#include <random>
+#include <boost/filesystem.hpp>
+#include <valhalla/midgard/util.h>
+
+using namespace std;
+using namespace valhalla::baldr;
+using namespace valhalla::midgard;
+
+namespace {
+
+boost::property_tree::ptree test_config() {
+  std::stringstream json; json << "\
+  {\
+    \"tile_dir\": \"test/celloverlay_tiles\",\
+    \"levels\": [\
+      {\"name\": \"local\", \"level\": 2, \"size\": 0.25},\
+      {\"name\": \"highway\", \"level\": 0, \"size\": 4},\
+      {\"name\": \"arterial\", \"level\": 1, \"size\": 1, \"importance_cutoff\": \"Trunk\"}\
+    ]\
+  }";
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(json, pt);
+  return pt;
+}
+
+constexpr int kColumns = 12;
+constexpr int kRows = 8;
+
+// Write a grid of streets over 3 x 2 tiles. Every fifth street is for
+// pedestrians only, lengths and speeds vary. Lengths are multiplied by scale.
+void write_grid(const TileHierarchy& h, const uint32_t scale = 1) {
+  // Node ids: nodes are numbered within their tile in grid order
+  std::vector<GraphId> ids(kColumns * kRows);
+  std::map<GraphId, uint32_t> tile_nodes;
+  auto latlng = [](const int x, const int y) {
+    return PointLL(-76.5f + 0.0625f * x + 0.03f, 40.0f + 0.0625f * y + 0.03f);
+  };
+  for (int y = 0; y < kRows; ++y) {
+    for (int x = 0; x < kColumns; ++x) {
+      GraphId tile = h.GetGraphId(latlng(x, y), 2);
+      ids[y * kColumns + x] = GraphId(tile.tileid(), 2, tile_nodes[tile]++);
+    }
+  }
+
+  std::map<GraphId, std::pair<std::vector<NodeInfo>, std::vector<DirectedEdge> > > tiles;
+  const int dx[] = {1, -1, 0, 0}, dy[] = {0, 0, 1, -1}, opposite[] = {1, 0, 3, 2};
+  auto exists = [](const int x, const int y) {
+    return x >= 0 && y >= 0 && x < kColumns && y < kRows;
+  };
+  for (int y = 0; y < kRows; ++y) {
+    for (int x = 0; x < kColumns; ++x) {
+      GraphId id = ids[y * kColumns + x];
+      auto& tile = tiles[id.Tile_Base()];
+      NodeInfo node;
+      node.set_latlng(latlng(x, y));
+      node.set_edge_index(tile.second.size());
+      uint32_t count = 0;
+      for (int d = 0; d < 4; ++d) {
+        int ex = x + dx[d], ey = y + dy[d];
+        if (!exists(ex, ey))
+          continue;
+        // Local index of the opposing edge at the end node
+        uint32_t opp_index = 0;
+        for (int od = 0; od < opposite[d]; ++od) {
+          opp_index += exists(ex + dx[od], ey + dy[od]);
+        }
+        int street = (d < 2) ? y : kRows + x;
+        GraphId end = ids[ey * kColumns + ex];
+        DirectedEdge edge;
+        edge.set_endnode(end);
+        edge.set_opp_index(opp_index);
+        edge.set_leaves_tile(end.Tile_Base() != id.Tile_Base());
+        edge.set_length(scale * (400 + 37 * ((x + ex) * 3 + (y + ey) * 5) % 300));
+        edge.set_speed(30 + 10 * (street % 4));
+        edge.set_forwardaccess(street % 5 == 2 ? kPedestrianAccess : kAllAccess);
+        tile.second.push_back(edge);
+        ++count;
+      }
+      node.set_edge_count(count);
+      tile.first.push_back(node);
+    }
+  }
+
+  for (const auto& tile : tiles) {
+    const auto& nodes = tile.second.first;
+    const auto& edges = tile.second.second;
+    GraphTileHeader header;
+    header.set_graphid(tile.first);
+    header.set_nodecount(nodes.size());
+    header.set_directededgecount(edges.size());
+    uint32_t offset = sizeof(GraphTileHeader) + nodes.size() * sizeof(NodeInfo) +
+                      edges.size() * sizeof(DirectedEdge);
+    header.set_edgeinfo_offset(offset);
+    header.set_textlist_offset(offset);
+    auto fullpath = h.tile_dir() + '/' + GraphTile::FileSuffix(tile.first, h);
+    boost::filesystem::create_directories(boost::filesystem::path(fullpath).parent_path());
+    std::ofstream file(fullpath, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(GraphTileHeader));
+    file.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(NodeInfo));
+    file.write(reinterpret_cast<const char*>(edges.data()), edges.size() * sizeof(DirectedEdge));
+  }
+}
+
+// Shortest travel time expanding every edge
+float expand_all(GraphReader& reader, const GraphId& origin, const GraphId& destination,
+                 const uint32_t access) {
+  std::map<GraphId, float> times;
+  std::priority_queue<std::pair<float, uint64_t>, std::vector<std::pair<float, uint64_t> >,
+                      std::greater<std::pair<float, uint64_t> > > queue;
+  times[origin] = 0.0f;
+  queue.emplace(0.0f, origin.value);
+  while (!queue.empty()) {
+    auto top = queue.top();
+    queue.pop();
+    GraphId node(top.second);
+    if (top.first > times[node])
+      continue;
+    if (node == destination)
+      return top.first;
+    const GraphTile* tile = reader.GetGraphTile(node);
+    const NodeInfo* nodeinfo = tile->node(node);
+    const EdgeCosts& costs = tile->GetEdgeCosts(access);
+    for (uint32_t i = 0; i < nodeinfo->edge_count(); ++i) {
+      uint32_t idx = nodeinfo->edge_index() + i;
+      if (!costs.accessible(idx))
+        continue;
+      GraphId end = tile->directededge(idx)->endnode();
+      float time = top.first + costs.seconds(idx);
+      auto found = times.find(end);
+      if (found == times.end() || time < found->second) {
+        times[end] = time;
+        queue.emplace(time, end.value);
+      }
+    }
+  }
+  return kUnreachable;
+}
+
+// Times are the same, both may be unreachable
+bool same_time(const float a, const float b) {
+  return a == b || equal(a, b, 1e-3f);
+}
+
+// All the nodes of the grid
+std::vector<GraphId> all_nodes(GraphReader& reader, const TileHierarchy& h) {
+  std::vector<GraphId> nodes;
+  for (const auto& tile_id : GraphReader::GetTileSet(h, 2)) {
+    const GraphTile* tile = reader.GetGraphTile(tile_id);
+    for (uint32_t n = 0; n < tile->header()->nodecount(); ++n) {
+      nodes.emplace_back(tile_id.tileid(), 2, n);
+    }
+  }
+  return nodes;
+}
+
+void TestCellOverlay() {
+  auto pt = test_config();
+  TileHierarchy h(pt);
+  boost::filesystem::remove_all(h.tile_dir());
+  write_grid(h);
+
+  GraphReader reader(pt);
+  GraphId tile_id = h.GetGraphId({-76.4f, 40.1f}, 2);
+  const GraphTile* tile = reader.GetGraphTile(tile_id);
+  CellOverlay overlay(*tile, {kAutoAccess, kPedestrianAccess});
+
+  // A 4 x 4 corner tile of the grid has 7 nodes on its inner sides
+  if (overlay.tile() != tile_id || overlay.nodecount() != 16 ||
+      overlay.boundary_nodes().size() != 7 || overlay.times(kBicycleAccess) != nullptr)
+    throw std::runtime_error("Unexpected overlay");
+  size_t count = overlay.boundary_nodes().size();
+  for (size_t b = 0; b < count; ++b) {
+    if (overlay.boundary_index(overlay.boundary_nodes()[b]) != static_cast<int32_t>(b) ||
+        overlay.times(kAutoAccess)[b * count + b] != 0.0f)
+      throw std::runtime_error("Unexpected boundary node");
+  }
+  if (overlay.boundary_index(0) != -1)
+    throw std::runtime_error("The corner node is not a boundary node");
+
+  // The times between boundary nodes match a search over the whole graph
+  // when the shortest path stays in the tile, and never beat it
+  for (size_t b = 0; b < count; ++b) {
+    for (size_t c = 0; c < count; ++c) {
+      GraphId from(tile_id.tileid(), 2, overlay.boundary_nodes()[b]);
+      GraphId to(tile_id.tileid(), 2, overlay.boundary_nodes()[c]);
+      float expected = expand_all(reader, from, to, kPedestrianAccess);
+      if (overlay.times(kPedestrianAccess)[b * count + c] < expected - 1e-3f)
+        throw std::runtime_error("Overlay time is shorter than the shortest path");
+    }
+  }
+
+  // Round trip through a file
+  overlay.Write("test/celloverlay.ovl");
+  CellOverlay read("test/celloverlay.ovl");
+  boost::filesystem::remove("test/celloverlay.ovl");
+  if (boost::filesystem::exists("test/celloverlay.ovl.tmp"))
+    throw std::runtime_error("Expected no temporary file to be left");
+  if (read.tile() != tile_id || read.fingerprint() != tile->fingerprint() ||
+      read.boundary_nodes() != overlay.boundary_nodes() ||
+      !std::equal(read.times(kAutoAccess), read.times(kAutoAccess) + count * count,
+                  overlay.times(kAutoAccess)))
+    throw std::runtime_error("Overlay file does not round trip");
+  if (CellOverlay("test/missing.ovl").tile().Is_Valid())
+    throw std::runtime_error("Expected an empty overlay");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestOverlayGraph() {
+  auto pt = test_config();
+  TileHierarchy h(pt);
+  boost::filesystem::remove_all(h.tile_dir());
+  write_grid(h);
+
+  if (BuildOverlays(h, 2, {kAutoAccess, kPedestrianAccess}, 3) != 6)
+    throw std::runtime_error("Expected an overlay for each of the 6 tiles");
+  for (const auto& tile_id : GraphReader::GetTileSet(h, 2)) {
+    if (!boost::filesystem::exists(CellOverlay::FileName(tile_id, h)))
+      throw std::runtime_error("Missing overlay file");
+  }
+
+  // Travel times over the overlay match searches over every edge
+  GraphReader reader(pt);
+  auto nodes = all_nodes(reader, h);
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<size_t> pick(0, nodes.size() - 1);
+  for (auto access : {kAutoAccess, kPedestrianAccess}) {
+    OverlayGraph overlay(h, access);
+    for (int i = 0; i < 40; ++i) {
+      GraphId origin = nodes[pick(generator)], destination = nodes[pick(generator)];
+      float expected = expand_all(reader, origin, destination, access);
+      if (!same_time(overlay.TravelTime(reader, origin, destination), expected))
+        throw std::runtime_error("Overlay travel time differs from the shortest path");
+    }
+  }
+
+  // Only pedestrians reach the crossing of 2 pedestrian streets
+  GraphId crossing(h.GetGraphId({-76.2f, 40.1f}, 2).tileid(), 2, 8);
+  GraphId corner(h.GetGraphId({-75.8f, 40.4f}, 2).tileid(), 2, 15);
+  if (OverlayGraph(h, kAutoAccess).TravelTime(reader, corner, crossing) != kUnreachable ||
+      OverlayGraph(h, kPedestrianAccess).TravelTime(reader, corner, crossing) == kUnreachable)
+    throw std::runtime_error("Expected the crossing to be reachable on foot only");
+
+  // Tiles without an overlay are expanded edge by edge
+  boost::filesystem::remove(CellOverlay::FileName(h.GetGraphId({-76.1f, 40.1f}, 2), h));
+  OverlayGraph partial(h, kAutoAccess);
+  GraphId west(h.GetGraphId({-76.4f, 40.1f}, 2).tileid(), 2, 0);
+  GraphId east(h.GetGraphId({-75.8f, 40.4f}, 2).tileid(), 2, 15);
+  if (!same_time(partial.TravelTime(reader, west, east), expand_all(reader, west, east, kAutoAccess)))
+    throw std::runtime_error("Expected the same time without an overlay");
+  if (partial.TravelTime(reader, west, west) != 0.0f)
+    throw std::runtime_error("Expected no time to the origin");
+
+  // Overlays of tiles rebuilt with the same node count are not used
+  write_grid(h, 2);
+  GraphReader rebuilt(pt);
+  OverlayGraph stale(h, kAutoAccess);
+  if (!same_time(stale.TravelTime(rebuilt, west, east), expand_all(rebuilt, west, east, kAutoAccess)))
+    throw std::runtime_error("Expected overlays of rebuilt tiles to be ignored");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+}
+
+int main() {
+  test::suite suite("celloverlay");
+
+  suite.test(TEST_CASE(TestCellOverlay));
+
+  suite.test(TEST_CASE(TestOverlayGraph));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,249 @@
+#include "test.h"
+
+#include "baldr/connectivity_map.h"
+#include "baldr/graphreader.h"
+
+#include <fstream>
+#include <boost/filesystem.hpp>
+
+using namespace std;
+using namespace valhalla::baldr;
+
+namespace {
+
+boost::property_tree::ptree test_config() {
+  std::stringstream json; json << "\
+  {\
+    \"tile_dir\": \"test/connectivity_map_tiles\",\
+    \"levels\": [\
+      {\"name\": \"local\", \"level\": 2, \"size\": 0.25},\
+      {\"name\": \"highway\", \"level\": 0, \"size\": 4},\
+      {\"name\": \"arterial\", \"level\": 1, \"size\": 1, \"importance_cutoff\": \"Trunk\"}\
+    ]\
+  }";
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(json, pt);
+  return pt;
+}
+
+// Tiles only need to exist to be part of the map
+void touch(const std::string& path) {
+  boost::filesystem::create_directories(boost::filesystem::path(path).parent_path());
+  std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+}
+
+// 2 neighboring tiles and an island on the local level, 1 highway tile
+struct TestTiles {
+  GraphId west, east, island, highway;
+};
+
+TestTiles write_tiles(const TileHierarchy& h) {
+  TestTiles tiles{h.GetGraphId({-76.2f, 40.1f}, 2), h.GetGraphId({-75.9f, 40.1f}, 2),
+                  h.GetGraphId({-70.1f, 45.1f}, 2), h.GetGraphId({-76.2f, 40.1f}, 0)};
+  for (const auto& tile : {tiles.west, tiles.east, tiles.island, tiles.highway}) {
+    touch(h.tile_dir() + '/' + GraphTile::FileSuffix(tile, h));
+  }
+  // Other files next to the tiles are not tiles
+  auto path = h.tile_dir() + '/' + GraphTile::FileSuffix(tiles.west, h);
+  touch(path.substr(0, path.rfind('.')) + ".ovl");
+  return tiles;
+}
+
+void check_colors(const connectivity_map_t& map, const TestTiles& tiles) {
+  auto west = map.get_color(tiles.west);
+  if (west == 0 || map.get_color(tiles.east) != west)
+    throw std::runtime_error("Expected neighboring tiles to have the same color");
+  auto island = map.get_color(tiles.island);
+  if (island == 0 || island == west)
+    throw std::runtime_error("Expected the island to have its own color");
+  if (map.get_color(tiles.highway) == 0)
+    throw std::runtime_error("Expected the highway tile to have a color");
+  if (map.get_color(GraphId(tiles.west.tileid() + 1000, 2, 0)) != 0 ||
+      map.get_color(GraphId(tiles.west.tileid(), 1, 0)) != 0)
+    throw std::runtime_error("Expected missing tiles to have no color");
+}
+
+void TestBuild() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+  auto tiles = write_tiles(h);
+
+  // Without a file the map is built in memory and nothing is written
+  auto file = connectivity_map_t::file_name(h);
+  connectivity_map_t built(h, 2);
+  check_colors(built, tiles);
+  if (boost::filesystem::exists(file))
+    throw std::runtime_error("Expected the connectivity file not to be written");
+
+  // Building ahead of time saves the file, leaving no temporary file behind
+  if (connectivity_map_t::build(h, 1) != 4)
+    throw std::runtime_error("Expected the 4 tiles to be built");
+  if (!boost::filesystem::exists(file) || boost::filesystem::status(file).permissions() & boost::filesystem::others_write)
+    throw std::runtime_error("Expected the connectivity file to be saved");
+  for (boost::filesystem::directory_iterator i(h.tile_dir()), end; i != end; ++i)
+    if (i->path().filename().string().find("connectivity.bin.") == 0)
+      throw std::runtime_error("Expected no temporary file to be left");
+
+  // It is mapped after that
+  auto image = built.to_image(2);
+  connectivity_map_t mapped(h);
+  check_colors(mapped, tiles);
+  if (mapped.to_image(2) != image || mapped.to_geojson(2) != built.to_geojson(2))
+    throw std::runtime_error("Expected the mapped colors to match the built ones");
+  if (image[tiles.east.tileid()] != built.get_color(tiles.east) ||
+      std::count(image.begin(), image.end(), 0) != static_cast<long>(image.size()) - 3)
+    throw std::runtime_error("Unexpected image");
+
+  // Building again replaces the file
+  boost::filesystem::remove_all(h.tile_dir() + "/2");
+  if (connectivity_map_t::build(h, 1) != 1)
+    throw std::runtime_error("Expected only the highway tile to be left");
+  if (connectivity_map_t(h).get_color(tiles.west) != 0)
+    throw std::runtime_error("Expected the rebuilt map to drop the removed tiles");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestTrustedFile() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+  auto tiles = write_tiles(h);
+  connectivity_map_t::build(h);
+  auto file = connectivity_map_t::file_name(h);
+  auto time = boost::filesystem::last_write_time(file);
+
+  // The file is mapped without looking at the tiles, so it keeps the colors
+  // of removed tiles and is left as it is
+  boost::filesystem::remove(h.tile_dir() + '/' + GraphTile::FileSuffix(tiles.island, h));
+  check_colors(connectivity_map_t(h), tiles);
+  if (boost::filesystem::last_write_time(file) != time)
+    throw std::runtime_error("Expected the file not to be written");
+
+  // Until it is built again
+  connectivity_map_t::build(h);
+  if (connectivity_map_t(h).get_color(tiles.island) != 0)
+    throw std::runtime_error("Expected the removed tile to have no color");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestEncodedImage() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+  auto tiles = write_tiles(h);
+  connectivity_map_t map(h);
+
+  // The 3 tiles and the empty grid around them fit in a few runs
+  auto image = map.to_encoded_image(2);
+  if (image.columns != 1440 || image.rows != 720 || image.palette.size() != 3 ||
+      image.palette[0] != 0 || image.runs.size() != 5)
+    throw std::runtime_error("Unexpected encoded image");
+  if (image.decode() != map.to_image(2))
+    throw std::runtime_error("Expected the encoded image to decode to the image");
+
+  // Runs start at cell 0 with the empty cells before the first tile
+  if (image.runs.front().first != 0 || image.runs.front().second != tiles.west.tileid())
+    throw std::runtime_error("Expected a leading empty run");
+
+  if (map.to_encoded_image(0).decode() != map.to_image(0) || map.to_encoded_image(0).runs.size() != 3)
+    throw std::runtime_error("Expected the highway image to decode to the image");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestGeoJson() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+  auto tiles = write_tiles(h);
+  connectivity_map_t map(h);
+
+  // A feature per region, the biggest first, with the tile centers
+  std::stringstream out;
+  out << 1.5;
+  map.to_geojson(out, 2);
+  out << ' ' << 1.5;
+  std::string geojson = out.str().substr(3, out.str().size() - 7);
+  if (out.str().substr(out.str().size() - 4) != " 1.5" || geojson != map.to_geojson(2))
+    throw std::runtime_error("Expected the stream format to be kept");
+  std::stringstream json(geojson);
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(json, pt);
+  std::vector<std::pair<size_t, size_t> > features;
+  for (const auto& feature : pt.get_child("features")) {
+    features.emplace_back(feature.second.get<size_t>("properties.color"),
+                          feature.second.get_child("geometry.coordinates").size());
+  }
+  if (pt.get<std::string>("type") != "FeatureCollection" || features.size() != 2 ||
+      features[0] != std::make_pair(map.get_color(tiles.west), size_t(2)) ||
+      features[1] != std::make_pair(map.get_color(tiles.island), size_t(1)))
+    throw std::runtime_error("Unexpected features");
+  auto center = pt.get_child("features").front().second.get_child("geometry.coordinates").front().second;
+  if (std::abs(center.front().second.get_value<float>() + 76.125f) > 1e-4f ||
+      std::abs(center.back().second.get_value<float>() - 40.125f) > 1e-4f)
+    throw std::runtime_error("Expected the center of the west tile");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestInvalidFile() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+  auto tiles = write_tiles(h);
+
+  // A truncated file is ignored and left as it is
+  connectivity_map_t::build(h);
+  auto file = connectivity_map_t::file_name(h);
+  auto size = boost::filesystem::file_size(file) - 4;
+  boost::filesystem::resize_file(file, size);
+  check_colors(connectivity_map_t(h), tiles);
+  if (boost::filesystem::file_size(file) != size)
+    throw std::runtime_error("Expected the invalid file not to be written");
+
+  // So is a file of another version
+  std::string header("\x07\0\0\0\0\0\0\0", 8);
+  std::ofstream(file, std::ios::out | std::ios::binary | std::ios::trunc).write(header.data(), header.size());
+  check_colors(connectivity_map_t(h), tiles);
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestAreConnected() {
+  auto pt = test_config();
+  TileHierarchy h(pt);
+  boost::filesystem::remove_all(h.tile_dir());
+  auto tiles = write_tiles(h);
+
+  // Without a file the reader builds the map on first use
+  GraphReader reader(pt);
+  if (!reader.AreConnected(tiles.west, GraphId(tiles.east.tileid(), 2, 5)) ||
+      reader.AreConnected(tiles.west, tiles.island))
+    throw std::runtime_error("Unexpected connectivity");
+
+  // Other readers of the tile directory share it rather than build it again
+  boost::filesystem::remove_all(h.tile_dir() + "/2");
+  GraphReader other(pt);
+  if (!other.AreConnected(tiles.west, tiles.east) || other.AreConnected(tiles.east, tiles.island))
+    throw std::runtime_error("Expected the map to be shared");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+}
+
+int main() {
+  test::suite suite("connectivity_map");
+
+  suite.test(TEST_CASE(TestBuild));
+
+  suite.test(TEST_CASE(TestTrustedFile));
+
+  suite.test(TEST_CASE(TestEncodedImage));
+
+  suite.test(TEST_CASE(TestGeoJson));
+
+  suite.test(TEST_CASE(TestInvalidFile));
+
+  suite.test(TEST_CASE(TestAreConnected));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,126 @@
+#include "test.h"
+#include "tiles.h"
+
+#include "baldr/correlate.h"
+
+#include <random>
+#include <boost/filesystem.hpp>
+#include <valhalla/midgard/util.h>
+
+using namespace std;
+using namespace valhalla::baldr;
+using namespace valhalla::midgard;
+
+namespace {
+
+boost::property_tree::ptree test_config() {
+  std::stringstream json; json << "\
+  {\
+    \"tile_dir\": \"test/correlate_tiles\",\
+    \"levels\": [\
+      {\"name\": \"local\", \"level\": 2, \"size\": 0.25},\
+      {\"name\": \"highway\", \"level\": 0, \"size\": 4},\
+      {\"name\": \"arterial\", \"level\": 1, \"size\": 1, \"importance_cutoff\": \"Trunk\"}\
+    ]\
+  }";
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(json, pt);
+  return pt;
+}
+
+// A grid of streets every 0.001 degrees in a tile either side of -76
+void write_grid(const TileHierarchy& h) {
+  for (float west : {-76.25f, -76.f}) {
+    std::vector<std::vector<PointLL> > shapes;
+    for (int i = 1; i < 10; ++i) {
+      float lng = west + 0.124f + i * 0.001f;
+      shapes.push_back({{lng, 40.101f}, {lng, 40.110f}});
+      float lat = 40.100f + i * 0.001f;
+      shapes.push_back({{west + 0.125f, lat}, {west + 0.134f, lat}});
+    }
+    test::write_shape_tile(h, h.GetGraphId(PointLL(west + 0.125f, 40.105f), 2), shapes);
+  }
+}
+
+void TestCorrelate() {
+  auto pt = test_config();
+  TileHierarchy h(pt);
+  boost::filesystem::remove_all(h.tile_dir());
+  write_grid(h);
+  GraphReader reader(pt);
+
+  // At the corner of the grid both directions of both streets are correlated
+  Location intersection({-76.125f, 40.101f}, Location::StopType::BREAK);
+  auto correlated = Correlate(reader, intersection, 50.f);
+  if (!correlated.IsCorrelated() || correlated.edges().size() != 4 || !correlated.IsNode())
+    throw std::runtime_error("Expected the intersection to be correlated to 4 edges");
+
+  // Along a street both directions are correlated
+  Location street({-76.12295f, 40.1025f}, Location::StopType::BREAK);
+  correlated = Correlate(reader, street, 50.f);
+  if (!correlated.IsCorrelated() || correlated.edges().size() != 2 || correlated.IsNode())
+    throw std::runtime_error("Expected the street to be correlated to 2 edges");
+  if (correlated.edges()[0].sos != PathLocation::NONE ||
+      !equal(correlated.vertex().lng(), -76.123f, 2e-5f) ||
+      !equal(correlated.vertex().lat(), 40.1025f, 2e-5f))
+    throw std::runtime_error("Unexpected correlated point");
+
+  // Nothing within the radius
+  Location far({-76.2f, 40.2f}, Location::StopType::BREAK);
+  if (Correlate(reader, far, 50.f).IsCorrelated())
+    throw std::runtime_error("Expected no correlation");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestCorrelateLocations() {
+  auto pt = test_config();
+  TileHierarchy h(pt);
+  boost::filesystem::remove_all(h.tile_dir());
+  write_grid(h);
+
+  // Random locations over both tiles and beyond the streets
+  std::mt19937 generator(17);
+  std::uniform_real_distribution<float> lng(-76.13f, -75.86f);
+  std::uniform_real_distribution<float> lat(40.1f, 40.111f);
+  std::vector<Location> locations;
+  for (int i = 0; i < 500; ++i) {
+    locations.emplace_back(PointLL(lng(generator), lat(generator)), Location::StopType::BREAK);
+  }
+  locations.push_back(locations.front());
+
+  GraphReader reader(pt);
+  for (size_t threads : {1, 4, 0}) {
+    auto batch = CorrelateLocations(pt, locations, 50.f, kAllAccess, threads);
+    if (batch.size() != locations.size())
+      throw std::runtime_error("Expected a result for each location");
+    size_t count = 0;
+    for (size_t i = 0; i < locations.size(); ++i) {
+      auto single = Correlate(reader, locations[i], 50.f);
+      if (!(batch[i] == single) || batch[i].edges().size() != single.edges().size() ||
+          batch[i].IsCorrelated() != single.IsCorrelated() ||
+          !(batch[i].latlng_ == locations[i].latlng_))
+        throw std::runtime_error("Batch correlation differs from single correlation");
+      count += single.IsCorrelated();
+    }
+    if (count == 0 || count == locations.size())
+      throw std::runtime_error("Expected some locations to correlate and some not");
+  }
+
+  if (!CorrelateLocations(pt, {}, 50.f).empty())
+    throw std::runtime_error("Expected no results");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+}
+
+int main() {
+  test::suite suite("correlate");
+
+  suite.test(TEST_CASE(TestCorrelate));
+
+  suite.test(TEST_CASE(TestCorrelateLocations));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,139 @@
+#include "test.h"
+
+#include "baldr/edgefilter.h"
+
+#include <fstream>
+#include <random>
+#include <boost/filesystem.hpp>
+
+using namespace std;
+using namespace valhalla::baldr;
+
+namespace {
+
+// Random edges with a mix of access, use and flags
+std::vector<DirectedEdge> random_edges(const size_t count, std::mt19937& gen) {
+  std::vector<DirectedEdge> edges(count);
+  for (auto& e : edges) {
+    e.set_forwardaccess(gen() & kAllAccess);
+    e.set_reverseaccess(gen() & kAllAccess);
+    e.set_speed(gen() % 100);
+    uint32_t r = gen() % 8;
+    e.set_use(r == 0 ? Use::kRail : (r == 1 ? Use::kBus : Use::kRoad));
+    e.set_unreachable(gen() % 4 == 0);
+    if (gen() % 4 == 0)
+      e.set_shortcut(1);
+  }
+  return edges;
+}
+
+template <uint32_t kAccess, bool kForward>
+void check_filter(const std::vector<DirectedEdge>& edges) {
+  std::vector<uint64_t> mask;
+  EdgeFilter<kAccess, kForward>::Filter(edges.data(), edges.size(), mask);
+  if (mask.size() != (edges.size() + 63) / 64)
+    throw std::runtime_error("Unexpected mask size");
+  for (size_t i = 0; i < mask.size() * 64; ++i) {
+    bool set = (mask[i / 64] >> (i % 64)) & 1;
+    bool allowed = i < edges.size() && EdgeFilter<kAccess, kForward>::Allowed(edges[i]);
+    if (set != allowed)
+      throw std::runtime_error("Mask does not match Allowed for edge " + std::to_string(i));
+  }
+}
+
+void TestFilter() {
+  std::mt19937 gen(5);
+  for (size_t count : {0, 1, 17, 63, 64, 65, 127, 300}) {
+    auto edges = random_edges(count, gen);
+    check_filter<kAutoAccess, true>(edges);
+    check_filter<kAutoAccess, false>(edges);
+    check_filter<kPedestrianAccess, true>(edges);
+    check_filter<kBicycleAccess, false>(edges);
+    check_filter<kTruckAccess | kBusAccess, true>(edges);
+  }
+
+  // The rules themselves
+  DirectedEdge edge;
+  edge.set_forwardaccess(kAutoAccess | kPedestrianAccess);
+  edge.set_reverseaccess(kPedestrianAccess);
+  if (!EdgeFilter<kAutoAccess>::Allowed(edge) || EdgeFilter<kAutoAccess, false>::Allowed(edge) ||
+      !EdgeFilter<kPedestrianAccess, false>::Allowed(edge))
+    throw std::runtime_error("Expected access by direction");
+  edge.set_unreachable(true);
+  if (EdgeFilter<kAutoAccess>::Allowed(edge) || !EdgeFilter<kPedestrianAccess>::Allowed(edge))
+    throw std::runtime_error("Unreachable edges should only be excluded when driving");
+  edge.set_unreachable(false);
+  edge.set_use(Use::kBus);
+  if (EdgeFilter<kAllAccess>::Allowed(edge))
+    throw std::runtime_error("Transit lines should be excluded");
+  edge.set_use(Use::kRoad);
+  edge.set_shortcut(1);
+  if (EdgeFilter<kAllAccess>::Allowed(edge))
+    throw std::runtime_error("Shortcuts should be excluded");
+}
+
+void TestFilterTile() {
+  std::stringstream json;
+  json << "{\"tile_dir\": \"test/edgefilter_tiles\", \"levels\": ["
+          "{\"name\": \"local\", \"level\": 2, \"size\": 0.25}]}";
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(json, pt);
+  TileHierarchy h(pt);
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // Node 0 has 70 edges, node 1 the remaining 80
+  std::mt19937 gen(9);
+  auto edges = random_edges(150, gen);
+  std::vector<NodeInfo> nodes(2);
+  nodes[0].set_edge_index(0);
+  nodes[0].set_edge_count(70);
+  nodes[1].set_edge_index(70);
+  nodes[1].set_edge_count(80);
+  GraphTileHeader header;
+  header.set_graphid({2, 2, 0});
+  header.set_nodecount(nodes.size());
+  header.set_directededgecount(edges.size());
+  uint32_t offset = sizeof(GraphTileHeader) + nodes.size() * sizeof(NodeInfo) +
+                    edges.size() * sizeof(DirectedEdge);
+  header.set_edgeinfo_offset(offset);
+  header.set_textlist_offset(offset);
+  auto fullpath = h.tile_dir() + '/' + GraphTile::FileSuffix(header.graphid(), h);
+  boost::filesystem::create_directories(boost::filesystem::path(fullpath).parent_path());
+  {
+    std::ofstream file(fullpath, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(GraphTileHeader));
+    file.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(NodeInfo));
+    file.write(reinterpret_cast<const char*>(edges.data()), edges.size() * sizeof(DirectedEdge));
+  }
+  GraphTile tile(h, {2, 2, 0});
+
+  typedef EdgeFilter<kAutoAccess, true> AutoFilter;
+  std::vector<uint64_t> tile_mask, node_mask;
+  AutoFilter::FilterTile(tile, tile_mask);
+  if (tile_mask.size() != 3)
+    throw std::runtime_error("Expected a mask word per 64 edges");
+  AutoFilter::FilterNode(tile, 1, node_mask);
+  if (node_mask.size() != 2)
+    throw std::runtime_error("Expected 2 mask words for 80 edges");
+  for (size_t i = 0; i < 80; ++i) {
+    size_t idx = 70 + i;
+    bool in_tile = (tile_mask[idx / 64] >> (idx % 64)) & 1;
+    bool in_node = (node_mask[i / 64] >> (i % 64)) & 1;
+    if (in_tile != in_node || in_node != AutoFilter::Allowed(edges[idx]))
+      throw std::runtime_error("Node mask does not match the tile mask");
+  }
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+}
+
+int main() {
+  test::suite suite("edgefilter");
+
+  suite.test(TEST_CASE(TestFilter));
+
+  suite.test(TEST_CASE(TestFilterTile));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,90 @@
+#include "test.h"
+
+#include <vector>
+#include <string>
+
+#include "baldr/edgeinfo.h"
+
+using namespace std;
+using namespace valhalla::baldr;
+
+namespace {
+
+// Serialize edge info the way a tile stores it
+std::string make_edgeinfo(const uint64_t wayid,
+                          const std::vector<uint32_t>& name_offsets,
+                          const std::string& encoded_shape) {
+  EdgeInfo::PackedItem item{};
+  item.name_count = name_offsets.size();
+  item.encoded_shape_size = encoded_shape.size();
+  std::string data(reinterpret_cast<const char*>(&wayid), sizeof(wayid));
+  data.append(reinterpret_cast<const char*>(&item), sizeof(item));
+  data.append(reinterpret_cast<const char*>(name_offsets.data()),
+              name_offsets.size() * sizeof(uint32_t));
+  data.append(encoded_shape);
+  return data;
+}
+
+void TestView() {
+  const char names[] = "Main Street\0Route 9\0";
+  std::vector<PointLL> shape = {{-76.3f, 40.1f}, {-76.31f, 40.12f}, {-76.305f, 40.2f}};
+  std::string encoded = valhalla::midgard::encode(shape);
+  std::string data = make_edgeinfo(1234, {0, 12}, encoded);
+
+  EdgeInfo ei(data.data(), names, sizeof(names));
+  if (ei.wayid() != 1234 || ei.name_count() != 2)
+    throw runtime_error("EdgeInfo way id or name count incorrect");
+
+  auto n = ei.GetNames();
+  if (n.size() != 2 || n[0] != "Main Street" || n[1] != "Route 9")
+    throw runtime_error("EdgeInfo names incorrect");
+
+  // References into the names list
+  std::vector<boost::string_ref> refs(5);
+  ei.GetNameRefs(refs);
+  if (refs.size() != 2 || refs[0] != "Main Street" || refs[1] != "Route 9" ||
+      refs[1].data() != names + 12)
+    throw runtime_error("EdgeInfo name references incorrect");
+  if (ei.GetNameRef(0) != "Main Street")
+    throw runtime_error("EdgeInfo name reference incorrect");
+
+  // Copies refer to the same tile data
+  EdgeInfo copy = ei;
+  auto span = copy.encoded_shape_span();
+  if (span.size() != encoded.size() || span.begin() != data.data() + data.size() - encoded.size())
+    throw runtime_error("EdgeInfo encoded shape span should point into the tile data");
+  if (copy.encoded_shape() != encoded)
+    throw runtime_error("EdgeInfo encoded shape incorrect");
+}
+
+void TestDecodeShape() {
+  std::vector<PointLL> shape = {{-76.3f, 40.1f}, {-76.31f, 40.12f}, {-76.305f, 40.2f},
+                                {179.999f, -89.5f}};
+  std::string data = make_edgeinfo(1, {}, valhalla::midgard::encode(shape));
+  EdgeInfo ei(data.data(), nullptr, 0);
+
+  // Decode into a buffer that already holds points. It should be replaced.
+  std::vector<PointLL> buffer(10);
+  ei.DecodeShape(buffer);
+  if (buffer.size() != shape.size())
+    throw runtime_error("Decoded shape has the wrong number of points");
+  for (size_t i = 0; i < shape.size(); ++i) {
+    if (!valhalla::midgard::equal(buffer[i].lng(), shape[i].lng(), 1e-5f) ||
+        !valhalla::midgard::equal(buffer[i].lat(), shape[i].lat(), 1e-5f))
+      throw runtime_error("Decoded shape point " + std::to_string(i) + " is incorrect");
+  }
+  if (ei.shape() != buffer)
+    throw runtime_error("shape() should match DecodeShape");
+}
+
+}
+
+int main() {
+  test::suite suite("edgeinfo");
+
+  suite.test(TEST_CASE(TestView));
+
+  suite.test(TEST_CASE(TestDecodeShape));
+
+  return suite.tear_down();
+}
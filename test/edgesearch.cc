@@ -0,0 +1,127 @@
+#include "test.h"
+#include "tiles.h"
+
+#include "baldr/edgesearch.h"
+
+#include <boost/filesystem.hpp>
+#include <valhalla/midgard/util.h>
+
+using namespace std;
+using namespace valhalla::baldr;
+using namespace valhalla::midgard;
+
+namespace {
+
+class test_searcher : public EdgeSearcher {
+ public:
+  using EdgeSearcher::EdgeSearcher;
+  using EdgeSearcher::shapes_;
+};
+
+boost::property_tree::ptree test_config() {
+  std::stringstream json; json << "\
+  {\
+    \"tile_dir\": \"test/edgesearch_tiles\",\
+    \"levels\": [\
+      {\"name\": \"local\", \"level\": 2, \"size\": 0.25},\
+      {\"name\": \"highway\", \"level\": 0, \"size\": 4},\
+      {\"name\": \"arterial\", \"level\": 1, \"size\": 1, \"importance_cutoff\": \"Trunk\"}\
+    ]\
+  }";
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(json, pt);
+  return pt;
+}
+
+void TestNearestAcrossTiles() {
+  auto pt = test_config();
+  TileHierarchy h(pt);
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // The location is just east of the tile boundary at -76. The nearest
+  // edge (8m west) is in the tile to the west, the next in the tile of the
+  // location. Edges run north.
+  PointLL ll(-75.99995f, 40.0002f);
+  GraphId east = h.GetGraphId(ll, 2);
+  GraphId west = h.GetGraphId(PointLL(-76.0001f, 40.0002f), 2);
+  test::write_shape_tile(h, west, {{{-76.00005f, 40.f}, {-76.00005f, 40.001f}}}, {kAllAccess});
+  test::write_shape_tile(h, east, {
+    {{-75.9998f, 40.f}, {-75.9998f, 40.001f}},        // 13m east
+    {{-75.9997f, 40.f}, {-75.9997f, 40.001f}},        // Pedestrian only, 21m
+    {{-75.99995f, 40.001f}, {-75.99995f, 40.002f}},   // 88m north
+    {{-75.9f, 40.f}, {-75.9f, 40.001f}}               // Beyond the radius
+  }, {kAllAccess, kPedestrianAccess, kAllAccess, kAllAccess});
+
+  GraphReader reader(pt);
+  auto nearest = FindNearestEdges(reader, ll, 100.f, 3, kAutoAccess);
+  if (nearest.size() != 3)
+    throw std::runtime_error("Expected 3 nearest edges");
+  if (nearest[0].edge.id != GraphId(west.tileid(), 2, 0) ||
+      nearest[1].edge.id != GraphId(west.tileid(), 2, 1) ||
+      nearest[2].edge.id != GraphId(east.tileid(), 2, 0))
+    throw std::runtime_error("Unexpected nearest edges");
+  // Float longitudes near -76 are only precise to about 0.6m
+  if (!equal(nearest[0].distance, 8.5f, 1.0f) || nearest[0].distance != nearest[1].distance ||
+      !equal(nearest[2].distance, 12.7f, 1.0f))
+    throw std::runtime_error("Unexpected distances");
+
+  // Fraction along and side of street depend on the direction
+  if (!equal(nearest[0].edge.dist, 0.2f, 0.01f) || !equal(nearest[1].edge.dist, 0.8f, 0.01f))
+    throw std::runtime_error("Unexpected distance along the edges");
+  if (nearest[0].edge.sos != PathLocation::RIGHT || nearest[1].edge.sos != PathLocation::LEFT ||
+      nearest[2].edge.sos != PathLocation::LEFT)
+    throw std::runtime_error("Unexpected side of street");
+  if (!equal(nearest[0].point.lng(), -76.00005f, 1e-5f) || !equal(nearest[0].point.lat(), 40.0002f, 1e-5f))
+    throw std::runtime_error("Unexpected closest point");
+
+  // All within the radius
+  nearest = FindNearestEdges(reader, ll, 100.f, 100, kAllAccess);
+  if (nearest.size() != 8 || nearest[6].edge.id != GraphId(east.tileid(), 2, 4) ||
+      !equal(nearest[6].distance, 88.4f, 1.0f))
+    throw std::runtime_error("Expected all edges within 100m");
+  if (nearest[6].edge.dist != 0.f || nearest[7].edge.dist != 1.f ||
+      nearest[6].edge.sos != PathLocation::NONE)
+    throw std::runtime_error("Expected the end of the edge north of the location");
+
+  // A searcher finds the same edges, the second time with the shapes it kept
+  test_searcher searcher(reader);
+  for (int i = 0; i < 2; ++i) {
+    auto found = searcher.Find(ll, 100.f, 100, kAllAccess);
+    for (size_t j = 0; j < nearest.size(); ++j) {
+      if (found.size() != nearest.size() || found[j].edge.id != nearest[j].edge.id ||
+          found[j].distance != nearest[j].distance || found[j].edge.dist != nearest[j].edge.dist)
+        throw std::runtime_error("Expected the searcher to find the same edges");
+    }
+  }
+  if (searcher.shapes_.size() != 2)
+    throw std::runtime_error("Expected the shapes of both tiles to be kept");
+  searcher.Clear();
+  if (searcher.Find(ll, 100.f, 3, kAutoAccess)[2].edge.id != GraphId(east.tileid(), 2, 0))
+    throw std::runtime_error("Expected the same edges after clearing the searcher");
+
+  // Only the shapes of the tiles searched for the last location are kept
+  if (searcher.Find(PointLL(-75.9f, 40.0002f), 10.f, 1, kAllAccess).size() != 1 ||
+      searcher.shapes_.size() != 1 || searcher.shapes_.count(east) != 1)
+    throw std::runtime_error("Expected only the shapes of the east tile to be kept");
+  if (!searcher.Find(PointLL(-70.f, 40.f), 10.f, 1, kAllAccess).empty() || !searcher.shapes_.empty())
+    throw std::runtime_error("Expected no shapes to be kept away from the tiles");
+
+  if (FindNearestEdges(reader, ll, 100.f, 100, kAutoAccess).size() != 6 ||
+      FindNearestEdges(reader, ll, 100.f, 100, kPedestrianAccess).size() != 8)
+    throw std::runtime_error("Only pedestrians should find the pedestrian edge");
+
+  if (!FindNearestEdges(reader, ll, 1.f, 10).empty() || !FindNearestEdges(reader, ll, 100.f, 0).empty())
+    throw std::runtime_error("Expected no edges");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+}
+
+int main() {
+  test::suite suite("edgesearch");
+
+  suite.test(TEST_CASE(TestNearestAcrossTiles));
+
+  return suite.tear_down();
+}
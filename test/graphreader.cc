@@ -1,4 +1,5 @@
 #include "test.h"
+#include "tiles.h"
 
 #include "baldr/graphreader.h"
 
@@ -136,6 +137,108 @@ void TestConnectivityMap() {
   boost::filesystem::remove_all(th.tile_dir());
 }
 
+DirectedEdge make_edge(const GraphId& endnode, const uint32_t opp_index, const bool leaves_tile) {
+  DirectedEdge edge;
+  edge.set_endnode(endnode);
+  edge.set_opp_index(opp_index);
+  edge.set_leaves_tile(leaves_tile);
+  return edge;
+}
+
+void TestOpposingEdgeTables() {
+  std::stringstream json; json << "\
+  {\
+    \"tile_dir\": \"test/graphreader_tiles\",\
+    \"levels\": [\
+      {\"name\": \"local\", \"level\": 2, \"size\": 0.25},\
+      {\"name\": \"highway\", \"level\": 0, \"size\": 4},\
+      {\"name\": \"arterial\", \"level\": 1, \"size\": 1, \"importance_cutoff\": \"Trunk\"}\
+    ]\
+  }";
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(json, pt);
+  TileHierarchy h(pt);
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // West nodes w0 and w1 and east node e0 in the next tile: w0 - w1 - e0
+  GraphId west = h.GetGraphId({-76.2f, 40.1f}, 2);
+  GraphId east = h.GetGraphId({-75.9f, 40.1f}, 2);
+  GraphId w0(west.tileid(), 2, 0), w1(west.tileid(), 2, 1), e0(east.tileid(), 2, 0);
+  test::write_tile(h, west, {{make_edge(w1, 0, false)},
+                             {make_edge(w0, 0, false), make_edge(e0, 0, true)}});
+  test::write_tile(h, east, {{make_edge(w1, 1, true)}});
+
+  // The tables give the same opposing edges as reading the end nodes
+  GraphReader reader(pt);
+  pt.put("opposing_edge_tables", true);
+  GraphReader table_reader(pt);
+  std::vector<GraphId> edges = {{west.tileid(), 2, 0}, {west.tileid(), 2, 1},
+                                {west.tileid(), 2, 2}, {east.tileid(), 2, 0}};
+  for (const auto& edgeid : edges) {
+    const GraphTile* tile = nullptr;
+    const GraphTile* table_tile = nullptr;
+    GraphId opposing = reader.GetOpposingEdgeId(edgeid, tile);
+    GraphId table_opposing = table_reader.GetOpposingEdgeId(edgeid, table_tile);
+    if (!opposing.Is_Valid() || opposing != table_opposing ||
+        tile->id() != table_tile->id() || table_reader.GetOpposingEdgeId(opposing) != edgeid)
+      throw std::runtime_error("Unexpected opposing edge in the table");
+  }
+
+  // Edges into w1 are the opposing edges of the edges leaving it
+  uint32_t count;
+  const GraphId* incoming = table_reader.GetGraphTile(west)->GetIncomingEdgeIds(table_reader, 1, count);
+  if (count != 2 || incoming[0] != edges[0] || incoming[1] != edges[3])
+    throw std::runtime_error("Unexpected incoming edges");
+
+  // Opposing edges within the west tile do not load the east tile
+  GraphReader west_reader(pt);
+  if (west_reader.GetOpposingEdgeId(edges[1]) != edges[0])
+    throw std::runtime_error("Unexpected opposing edge within the tile");
+
+  // Without the east tile its opposing edges are invalid
+  boost::filesystem::remove(h.tile_dir() + '/' + GraphTile::FileSuffix(east, h));
+  GraphReader missing_reader(pt);
+  const GraphTile* tile = nullptr;
+  if (missing_reader.GetOpposingEdgeId(edges[2], tile).Is_Valid() || tile != nullptr ||
+      missing_reader.GetOpposingEdgeId(edges[1]) != edges[0])
+    throw std::runtime_error("Expected no opposing edge in a missing tile");
+  if (west_reader.GetOpposingEdgeId(edges[2]).Is_Valid())
+    throw std::runtime_error("Expected the east tile to be loaded on first use");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+
+void TestAddGraphTile() {
+  std::stringstream json; json << "\
+  {\
+    \"tile_dir\": \"test/graphreader_tiles\",\
+    \"levels\": [\
+      {\"name\": \"local\", \"level\": 2, \"size\": 0.25},\
+      {\"name\": \"highway\", \"level\": 0, \"size\": 4},\
+      {\"name\": \"arterial\", \"level\": 1, \"size\": 1, \"importance_cutoff\": \"Trunk\"}\
+    ]\
+  }";
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(json, pt);
+  TileHierarchy h(pt);
+  boost::filesystem::remove_all(h.tile_dir());
+  GraphId west = h.GetGraphId({-76.2f, 40.1f}, 2);
+  test::write_tile(h, west, {{}});
+  GraphReader reader(pt);
+  const GraphTile* tile = reader.GetGraphTile(west);
+
+  // Another reader shares the tile memory without reading the tile again
+  boost::filesystem::remove_all(h.tile_dir());
+  test_reader other(pt);
+  other.AddGraphTile(*tile);
+  other.AddGraphTile(*tile);
+  other.AddGraphTile(GraphTile());
+  const GraphTile* shared = other.GetGraphTile(west);
+  if (shared == nullptr || shared->header() != tile->header() || other.cache_size_ != tile->size())
+    throw std::runtime_error("Expected the tile to be shared");
+}
+
 }
 
 int main() {
@@ -145,5 +248,9 @@ int main() {
 
   suite.test(TEST_CASE(TestConnectivityMap));
 
+  suite.test(TEST_CASE(TestOpposingEdgeTables));
+
+  suite.test(TEST_CASE(TestAddGraphTile));
+
   return suite.tear_down();
 }
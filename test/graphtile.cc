@@ -1,6 +1,14 @@
 #include "test.h"
 
+#include "baldr/graphreader.h"
 #include "baldr/graphtile.h"
+#include "baldr/tilesection.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <thread>
+#include <boost/filesystem.hpp>
 
 using namespace std;
 using namespace valhalla::baldr;
@@ -38,6 +46,715 @@ void TestFileSuffix() {
     throw std::runtime_error("Unexpected graphtile suffix");
 }
 
+boost::property_tree::ptree test_config() {
+  std::stringstream json; json << "\
+  {\
+    \"tile_dir\": \"test/graphtile_tiles\",\
+    \"levels\": [\
+      {\"name\": \"local\", \"level\": 2, \"size\": 0.25},\
+      {\"name\": \"highway\", \"level\": 0, \"size\": 4},\
+      {\"name\": \"arterial\", \"level\": 1, \"size\": 1, \"importance_cutoff\": \"Trunk\"}\
+    ]\
+  }";
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(json, pt);
+  return pt;
+}
+
+// Get the raw bytes of a list of fixed size records
+template <class T>
+std::string to_bytes(const std::vector<T>& records) {
+  return std::string(reinterpret_cast<const char*>(records.data()),
+                     records.size() * sizeof(T));
+}
+
+// Write a tile made up of the header followed by the given record data,
+// edge info, text list and (optional) quantized shape section
+void write_tile(const TileHierarchy& h, GraphTileHeader header,
+                const std::string& data, const std::string& edgeinfo = "",
+                const std::string& textlist = "",
+                const std::string& quantized = "") {
+  auto fullpath = h.tile_dir() + '/' + GraphTile::FileSuffix(header.graphid(), h);
+  boost::filesystem::create_directories(boost::filesystem::path(fullpath).parent_path());
+  uint32_t size = sizeof(GraphTileHeader) + data.size();
+  header.set_edgeinfo_offset(size);
+  header.set_textlist_offset(size + edgeinfo.size());
+  size += edgeinfo.size() + textlist.size();
+  std::string padding((4 - size % 4) % 4, '\0');
+  if (!quantized.empty())
+    header.set_quantized_shape_offset(size + padding.size());
+  std::ofstream file(fullpath, std::ios::out | std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(GraphTileHeader));
+  file.write(data.data(), data.size());
+  file.write(edgeinfo.data(), edgeinfo.size());
+  file.write(textlist.data(), textlist.size());
+  if (!quantized.empty()) {
+    file.write(padding.data(), padding.size());
+    file.write(quantized.data(), quantized.size());
+  }
+}
+
+// Write the bytes of a serialized tile
+void write_bytes(const TileHierarchy& h, const GraphId& id, const std::string& bytes) {
+  auto fullpath = h.tile_dir() + '/' + GraphTile::FileSuffix(id, h);
+  boost::filesystem::create_directories(boost::filesystem::path(fullpath).parent_path());
+  std::ofstream file(fullpath, std::ios::out | std::ios::binary | std::ios::trunc);
+  file.write(bytes.data(), bytes.size());
+}
+
+// Serialize edge info the way a tile stores it
+std::string make_edgeinfo(const uint64_t wayid, const std::string& encoded_shape,
+                          const std::vector<uint32_t>& name_offsets = {}) {
+  EdgeInfo::PackedItem item{};
+  item.name_count = name_offsets.size();
+  item.encoded_shape_size = encoded_shape.size();
+  std::string data(reinterpret_cast<const char*>(&wayid), sizeof(wayid));
+  data.append(reinterpret_cast<const char*>(&item), sizeof(item));
+  data.append(to_bytes(name_offsets));
+  data.append(encoded_shape);
+  return data;
+}
+
+void TestTransfers() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // Stop 1 has no transfers. The transfers are out of order and one is
+  // from a stop Id past the 5 stops of the tile
+  std::vector<TransitStop> stops(5, TransitStop(0, 0));
+  std::vector<TransitTransfer> transfers = {
+    {2, 3, TransferType::kMinTime, 120}, {0, 2, TransferType::kRecommended, 0},
+    {9, 1, TransferType::kTimed, 0}, {0, 3, TransferType::kMinTime, 60},
+    {2, 0, TransferType::kTimed, 0}, {4, 0, TransferType::kNotPossible, 0},
+    {2, 1, TransferType::kTimed, 0}
+  };
+  GraphTileHeader header;
+  header.set_graphid({2, 2, 0});
+  header.set_stopcount(stops.size());
+  header.set_transfercount(transfers.size());
+  write_tile(h, header, to_bytes(stops) + to_bytes(transfers));
+  auto path = h.tile_dir() + '/' + GraphTile::FileSuffix(header.graphid(), h);
+  std::ifstream in(path, std::ios::in | std::ios::binary);
+  std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  GraphTile tile(h, {2, 2, 0});
+  auto from0 = tile.GetTransfers(0);
+  if (from0.second != 2 || from0.first->to_stopid() != 2)
+    throw std::runtime_error("Expected 2 transfers from stop 0");
+  auto from2 = tile.GetTransfers(2);
+  if (from2.second != 3 || from2.first->from_stopid() != 2 ||
+      from2.first[2].to_stopid() != 3)
+    throw std::runtime_error("Expected 3 transfers from stop 2");
+  if (tile.GetTransfers(1).second != 0 || tile.GetTransfers(1).first != nullptr)
+    throw std::runtime_error("Expected no transfers from stop 1");
+  if (tile.GetTransfers(4).second != 1 || tile.GetTransfers(5).second != 0)
+    throw std::runtime_error("Unexpected transfers from stops 4 and 5");
+
+  auto transfer = tile.GetTransfer(2, 3);
+  if (transfer == nullptr || transfer->mintime() != 120)
+    throw std::runtime_error("Expected transfer from stop 2 to stop 3");
+  if (tile.GetTransfer(2, 2) != nullptr || tile.GetTransfer(1, 0) != nullptr ||
+      tile.GetTransfer(9, 1) != nullptr)
+    throw std::runtime_error("Unexpected transfer found");
+
+  // The transfers are sorted in a copy, the tile data is left as it was
+  const char* data = reinterpret_cast<const char*>(tile.header());
+  if (std::string(data, data + bytes.size()) != bytes)
+    throw std::runtime_error("Expected the tile data not to be modified");
+
+  // So they can be indexed in a read only mapping of the tile
+  GraphTile lazy(h, {2, 2, 0}, true);
+  if (lazy.GetTransfers(2).second != 3 || lazy.GetTransfer(0, 3)->mintime() != 60)
+    throw std::runtime_error("Expected the transfers of the mapped tile");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestDepartures() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // A transit stop node with 2 lines and a road edge leaving it
+  std::vector<NodeInfo> nodes(1);
+  nodes[0].set_edge_index(0);
+  nodes[0].set_edge_count(3);
+  std::vector<DirectedEdge> edges(3);
+  edges[0].set_use(Use::kRail);
+  edges[0].set_lineid(7);
+  edges[1].set_use(Use::kRoad);
+  edges[2].set_use(Use::kBus);
+  edges[2].set_lineid(3);
+
+  // Day 2 is set in the days mask for all but the 3rd departure on line 7.
+  // The last departure on line 7 ends before day 2 so it uses the dow mask.
+  uint64_t day2 = 1ULL << 2;
+  std::vector<TransitDeparture> departures = {
+    {3, 1, 0, 0, 0, 28800, 60, 10, kMonday, day2},
+    {3, 2, 0, 0, 0, 36000, 60, 10, kMonday, day2},
+    {7, 3, 1, 0, 0, 25200, 60, 10, kMonday, day2},
+    {7, 4, 1, 0, 0, 28800, 60, 10, kMonday, day2},
+    {7, 5, 1, 0, 0, 30000, 60, 10, kMonday, 0},
+    {7, 6, 1, 0, 0, 32400, 60, 10, kMonday, day2},
+    {7, 7, 1, 0, 0, 32500, 60, 1, kTuesday, 0},
+    {9, 8, 2, 0, 0, 28800, 60, 10, kMonday, day2}
+  };
+  GraphTileHeader header;
+  header.set_graphid({2, 2, 0});
+  header.set_nodecount(nodes.size());
+  header.set_directededgecount(edges.size());
+  header.set_departurecount(departures.size());
+  write_tile(h, header, to_bytes(nodes) + to_bytes(edges) + to_bytes(departures));
+  GraphTile tile(h, {2, 2, 0});
+
+  // Time window only
+  auto range = tile.GetDepartures(7, 28800, 32400);
+  if (range.size() != 3 || range.begin()->tripid() != 4)
+    throw std::runtime_error("Expected 3 departures on line 7 in the window");
+  if (tile.GetDepartures(7, 32600, 40000).size() != 0 ||
+      tile.GetDepartures(5, 0, 86400).size() != 0)
+    throw std::runtime_error("Expected no departures");
+
+  // Service day filtering
+  std::vector<const TransitDeparture*> valid;
+  if (tile.GetDepartures(7, 0, 86400, 2, kTuesday, false, valid) != 4 ||
+      valid[0]->tripid() != 3 || valid[1]->tripid() != 4 ||
+      valid[2]->tripid() != 6 || valid[3]->tripid() != 7)
+    throw std::runtime_error("Unexpected valid departures on line 7");
+  for (const auto& dep : valid) {
+    if (tile.GetNextDeparture(7, dep->departure_time(), 2, kTuesday, false) != dep)
+      throw std::runtime_error("Bulk query does not match GetNextDeparture");
+  }
+
+  // Dates before the tile use the day of week mask
+  valid.clear();
+  if (tile.GetDepartures(7, 0, 86400, 2, kMonday, true, valid) != 4 ||
+      valid[2]->tripid() != 5)
+    throw std::runtime_error("Unexpected valid departures before the tile date");
+
+  // All departures from the stop
+  valid.clear();
+  if (tile.GetStopDepartures(0, 28000, 30000, 2, kTuesday, false, valid) != 2 ||
+      valid[0]->lineid() != 7 || valid[1]->lineid() != 3)
+    throw std::runtime_error("Unexpected departures from the stop");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestQuantizedShapes() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // 2 edge infos. Only the first has a quantized shape.
+  std::vector<PointLL> shape1 = {{-76.3f, 40.1f}, {-76.31f, 40.12f}, {-76.305f, 40.2f}};
+  std::vector<PointLL> shape2 = {{5.5f, 52.1f}, {5.6f, 52.2f}};
+  std::string edgeinfo = make_edgeinfo(1, valhalla::midgard::encode(shape1));
+  uint32_t offset2 = edgeinfo.size();
+  edgeinfo += make_edgeinfo(2, valhalla::midgard::encode(shape2));
+  std::string textlist(3, 'x');
+  GraphTileHeader header;
+  header.set_graphid({2, 2, 0});
+  write_tile(h, header, "", edgeinfo, textlist,
+             QuantizedShapes::Serialize({{0, shape1}}));
+  GraphTile tile(h, {2, 2, 0});
+
+  auto ei1 = tile.edgeinfo(0);
+  if (ei1.quantized_shape().size() != 6 || std::abs(ei1.quantized_shape().begin()[0] + 76300000) > 4)
+    throw std::runtime_error("Expected a quantized shape for the first edge info");
+  if (tile.edgeinfo(offset2).quantized_shape().size() != 0)
+    throw std::runtime_error("Expected no quantized shape for the second edge info");
+  if (tile.edgeinfo(offset2).wayid() != 2)
+    throw std::runtime_error("Quantized shapes should not affect the edge info");
+
+  // Both decode the same as the encoded shapes
+  std::vector<PointLL> shapes;
+  std::vector<uint32_t> offsets;
+  tile.DecodeShapes({0, offset2}, shapes, offsets);
+  if (offsets != std::vector<uint32_t>{0, 3, 5})
+    throw std::runtime_error("Unexpected shape offsets");
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    const auto& expected = i < 3 ? shape1[i] : shape2[i - 3];
+    if (!valhalla::midgard::equal(shapes[i].lng(), expected.lng(), 1e-5f) ||
+        !valhalla::midgard::equal(shapes[i].lat(), expected.lat(), 1e-5f))
+      throw std::runtime_error("Decoded shape point " + std::to_string(i) + " is incorrect");
+  }
+  if (tile.edgeinfo(0).shape() != std::vector<PointLL>(shapes.begin(), shapes.begin() + 3))
+    throw std::runtime_error("EdgeInfo shape should match the batch decode");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestEdgesByName() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // Edge info 0 is "Main St." and "Route 9", edge info 1 is "MAIN  ST"
+  std::string textlist("Main St.\0Route 9\0MAIN  ST\0Elm Street\0", 37);
+  std::string edgeinfo = make_edgeinfo(1, "", {0, 9});
+  uint32_t offset1 = edgeinfo.size();
+  edgeinfo += make_edgeinfo(2, "", {17});
+  uint32_t offset2 = edgeinfo.size();
+  edgeinfo += make_edgeinfo(3, "", {26});
+
+  // Edges 0 and 1 are the 2 directions of edge info 0. Edge 3 is a
+  // transition edge (its edge info offset is not used).
+  std::vector<DirectedEdge> edges(5);
+  edges[0].set_edgeinfo_offset(0);
+  edges[1].set_edgeinfo_offset(0);
+  edges[2].set_edgeinfo_offset(offset1);
+  edges[3].set_trans_up(true);
+  edges[4].set_edgeinfo_offset(offset2);
+  GraphTileHeader header;
+  header.set_graphid({2, 2, 0});
+  header.set_directededgecount(edges.size());
+  write_tile(h, header, to_bytes(edges), edgeinfo, textlist);
+  GraphTile tile(h, {2, 2, 0});
+
+  if (tile.GetEdgesByName("main st") != std::vector<uint32_t>{0, 1, 2})
+    throw std::runtime_error("Unexpected edges named Main St");
+  if (tile.GetEdgesByName(" Route-9 ") != std::vector<uint32_t>{0, 1})
+    throw std::runtime_error("Unexpected edges named Route 9");
+  if (tile.GetEdgesByName("elm street") != std::vector<uint32_t>{4})
+    throw std::runtime_error("Unexpected edges named Elm Street");
+  if (!tile.GetEdgesByName("Oak Street").empty() || !GraphTile().GetEdgesByName("Main St").empty())
+    throw std::runtime_error("Expected no edges");
+
+  // Copies of the tile share the index
+  GraphTile copy = tile;
+  if (&copy.GetEdgesByName("Main St") != &tile.GetEdgesByName("Main St"))
+    throw std::runtime_error("Copies of the tile should share the name index");
+
+  if (GraphTile::NormalizeName("  Rue de l'\xc3\x89glise ") != "rue de l \xc3\x89glise")
+    throw std::runtime_error("Unexpected normalized name");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestFindEdges() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // A grid of 10x10 short edges, each with 2 directed edges. Every 3rd
+  // pair is followed by a transition edge that is not indexed.
+  std::string edgeinfo;
+  std::vector<DirectedEdge> edges;
+  std::vector<std::vector<PointLL> > shapes;
+  for (int i = 0; i < 100; ++i) {
+    PointLL start(-76.f + (i % 10) * 0.001f, 40.f + (i / 10) * 0.001f);
+    shapes.push_back({start, PointLL(start.lng() + 0.0005f, start.lat()),
+                      PointLL(start.lng() + 0.0005f, start.lat() + 0.0005f)});
+    DirectedEdge edge;
+    edge.set_edgeinfo_offset(edgeinfo.size());
+    edge.set_forwardaccess(kAllAccess);
+    edges.push_back(edge);
+    edges.push_back(edge);
+    if (i % 3 == 0) {
+      edges.emplace_back();
+      edges.back().set_trans_down(true);
+    }
+    edgeinfo += make_edgeinfo(i, valhalla::midgard::encode(shapes.back()));
+  }
+  GraphTileHeader header;
+  header.set_graphid({2, 2, 0});
+  header.set_directededgecount(edges.size());
+  write_tile(h, header, to_bytes(edges), edgeinfo);
+  GraphTile tile(h, {2, 2, 0});
+
+  // Box search against a scan of the edges
+  AABB2<PointLL> box(PointLL(-75.9975f, 40.0025f), PointLL(-75.9955f, 40.0035f));
+  std::vector<GraphId> found;
+  tile.FindEdges(box, found);
+  std::vector<uint32_t> found_idx, expected_idx;
+  for (const auto& id : found)
+    found_idx.push_back(id.id());
+  std::sort(found_idx.begin(), found_idx.end());
+  for (uint32_t idx = 0; idx < edges.size(); ++idx) {
+    if (edges[idx].trans_down())
+      continue;
+    auto shape = tile.edgeinfo(edges[idx].edgeinfo_offset()).shape();
+    AABB2<PointLL> edge_box(shape[0], shape[2]);
+    if (edge_box.Intersects(box))
+      expected_idx.push_back(idx);
+  }
+  if (found_idx.empty() || found_idx != expected_idx)
+    throw std::runtime_error("FindEdges does not match a scan of the edges");
+
+  // The nearest edge to a point on edge 25 (both directions), then the
+  // edges either side of it
+  PointLL ll(-76.f + 5 * 0.001f + 0.0005f, 40.f + 2 * 0.001f + 0.0002f);
+  std::vector<std::pair<float, GraphId> > nearest;
+  tile.FindNearestEdges(ll, 4, 1000.f, nearest);
+  if (nearest.size() != 4 || nearest[0].first > 0.1f || nearest[1].first > 0.1f ||
+      tile.directededge(nearest[0].second)->edgeinfo_offset() !=
+      tile.directededge(nearest[1].second)->edgeinfo_offset())
+    throw std::runtime_error("Expected both directions of the edge under the point");
+  if (tile.edgeinfo(tile.directededge(nearest[0].second)->edgeinfo_offset()).wayid() != 25)
+    throw std::runtime_error("Expected edge 25 to be nearest");
+  if (nearest[2].first < 20.f || nearest[2].first > 60.f ||
+      nearest[0].second.tileid() != 2 || nearest[0].second.level() != 2)
+    throw std::runtime_error("Unexpected nearest edges");
+
+  // Nothing within the distance
+  tile.FindNearestEdges(PointLL(-75.f, 41.f), 4, 1000.f, nearest);
+  if (!nearest.empty())
+    throw std::runtime_error("Expected no edges within 1km");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestEdgeCores() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // Node 0 has 2 edges, node 1 has 1 edge
+  std::vector<NodeInfo> nodes(2);
+  nodes[0].set_edge_index(0);
+  nodes[0].set_edge_count(2);
+  nodes[1].set_edge_index(2);
+  nodes[1].set_edge_count(1);
+  std::vector<DirectedEdge> edges(3);
+  edges[0].set_endnode({2, 2, 1});
+  edges[0].set_length(1234);
+  edges[0].set_speed(88);
+  edges[0].set_forwardaccess(kAutoAccess | kTruckAccess);
+  edges[0].set_opp_index(5);
+  edges[0].set_use(Use::kRamp);
+  edges[0].set_not_thru(true);
+  edges[1].set_endnode({3, 1, 7});
+  edges[1].set_shortcut(1);
+  edges[1].set_trans_up(true);
+  edges[1].set_leaves_tile(true);
+  edges[2].set_endnode({2, 2, 0});
+  edges[2].set_trans_down(true);
+  edges[2].set_dest_only(true);
+  edges[2].set_unreachable(true);
+  GraphTileHeader header;
+  header.set_graphid({2, 2, 0});
+  header.set_nodecount(nodes.size());
+  header.set_directededgecount(edges.size());
+  write_tile(h, header, to_bytes(nodes) + to_bytes(edges));
+  GraphTile tile(h, {2, 2, 0});
+
+  if (sizeof(EdgeCore) != 16)
+    throw std::runtime_error("EdgeCore should be 16 bytes");
+  auto cores = tile.GetEdgeCores();
+  if (cores.size() != edges.size())
+    throw std::runtime_error("Expected an edge core per directed edge");
+  size_t idx = 0;
+  for (const auto& core : cores) {
+    const DirectedEdge& edge = edges[idx++];
+    if (core.endnode() != edge.endnode() || core.length() != edge.length() ||
+        core.speed() != edge.speed() || core.forwardaccess() != edge.forwardaccess() ||
+        core.opp_index() != edge.opp_index() || core.use() != edge.use() ||
+        core.trans_up() != edge.trans_up() || core.trans_down() != edge.trans_down() ||
+        core.is_shortcut() != edge.is_shortcut() || core.leaves_tile() != edge.leaves_tile() ||
+        core.not_thru() != edge.not_thru() || core.destonly() != edge.destonly() ||
+        core.unreachable() != edge.unreachable())
+      throw std::runtime_error("Edge core does not match the directed edge");
+  }
+
+  // Edge cores of a node are the same as its directed edges
+  uint32_t count, edge_index;
+  const EdgeCore* core = tile.GetEdgeCores(1, count, edge_index);
+  if (count != 1 || edge_index != 2 || core != cores.begin() + 2 || !core->destonly())
+    throw std::runtime_error("Unexpected edge cores of node 1");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestNodeCores() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+
+  std::vector<NodeInfo> nodes = {
+    {{-76.5f, 40.25f}, RoadClass::kPrimary, kAutoAccess, NodeType::kStreetIntersection, false},
+    {{-76.75f, 40.5f}, RoadClass::kServiceOther, kAllAccess, NodeType::kMultiUseTransitStop, true}
+  };
+  nodes[0].set_edge_index(0);
+  nodes[0].set_edge_count(100);
+  nodes[0].set_parent(true);
+  nodes[1].set_edge_index(100);
+  nodes[1].set_edge_count(2);
+  nodes[1].set_child(true);
+  nodes[1].set_mode_change(true);
+  GraphTileHeader header;
+  header.set_graphid({2, 2, 0});
+  header.set_nodecount(nodes.size());
+  write_tile(h, header, to_bytes(nodes));
+  GraphTile tile(h, {2, 2, 0});
+
+  if (sizeof(NodeCore) != 16)
+    throw std::runtime_error("NodeCore should be 16 bytes");
+  if (tile.GetNodeCores().size() != nodes.size())
+    throw std::runtime_error("Expected a node core per node");
+  for (uint32_t idx = 0; idx < nodes.size(); ++idx) {
+    const NodeCore* core = tile.nodecore(idx);
+    const NodeInfo* node = tile.node(idx);
+    if (core != tile.nodecore(GraphId(2, 2, idx)) || core->latlng() != node->latlng() ||
+        core->edge_index() != node->edge_index() || core->edge_count() != node->edge_count() ||
+        core->access() != node->access() || core->type() != node->type() ||
+        core->parent() != node->parent() || core->child() != node->child() ||
+        core->mode_change() != node->mode_change())
+      throw std::runtime_error("Node core does not match the node");
+  }
+
+  try {
+    tile.nodecore(2);
+    throw std::logic_error("Expected an out of bounds node core to throw");
+  } catch (const std::runtime_error&) {
+  }
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestEdgeCosts() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // Not a multiple of the 4 edges the SSE2 loop takes, so there is a tail
+  std::vector<DirectedEdge> edges(19);
+  for (size_t i = 0; i < edges.size(); ++i) {
+    edges[i].set_length(100 * (i + 1));
+    edges[i].set_speed(36);
+    edges[i].set_forwardaccess(kAutoAccess | kTruckAccess);
+  }
+  edges[1].set_truck_speed(18);
+  edges[2].set_forwardaccess(kPedestrianAccess);
+  edges[3].set_speed(0);
+  GraphTileHeader header;
+  header.set_graphid({2, 2, 0});
+  header.set_directededgecount(edges.size());
+  write_tile(h, header, to_bytes(edges));
+  GraphTile tile(h, {2, 2, 0});
+
+  const EdgeCosts& costs = tile.GetEdgeCosts(kAutoAccess);
+  if (costs.size() != edges.size() || costs.access() != kAutoAccess)
+    throw std::runtime_error("Expected a cost per directed edge");
+  for (size_t i = 0; i < edges.size(); ++i) {
+    bool accessible = (i != 2 && i != 3);
+    float seconds = accessible ? 10.f * (i + 1) : 0.f;
+    if (costs.accessible(i) != accessible || !equal(costs.seconds(i), seconds, 0.001f))
+      throw std::runtime_error("Unexpected auto cost of edge " + std::to_string(i));
+  }
+
+  // Trucks use the truck speed where there is one. Pedestrians only have
+  // access to one edge.
+  const EdgeCosts& truck = tile.GetEdgeCosts(kTruckAccess);
+  if (!equal(truck.seconds(1), 40.f, 0.001f) || !equal(truck.seconds(4), 50.f, 0.001f) ||
+      truck.accessible(2))
+    throw std::runtime_error("Unexpected truck costs");
+  const EdgeCosts& pedestrian = tile.GetEdgeCosts(kPedestrianAccess);
+  if (std::count(pedestrian.accessible().begin(), pedestrian.accessible().end(), 1) != 1 ||
+      !pedestrian.accessible(2))
+    throw std::runtime_error("Unexpected pedestrian costs");
+
+  // Repeated requests for the same mode return the cached costs
+  if (&tile.GetEdgeCosts(kAutoAccess) != &costs || &tile.GetEdgeCosts(kTruckAccess) != &truck)
+    throw std::runtime_error("Expected the costs to be cached");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestTileFormatV2() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // 1 node with 2 edges sharing an edge info with a name and a quantized
+  // shape. An unknown section type is stored between known ones.
+  std::vector<NodeInfo> nodes(1);
+  nodes[0].set_edge_count(2);
+  std::vector<DirectedEdge> edges(2);
+  edges[0].set_length(100);
+  edges[1].set_length(200);
+  std::vector<PointLL> shape = {{-76.3f, 40.1f}, {-76.31f, 40.12f}};
+  std::string textlist("Main Street\0", 12);
+  std::string edgeinfo = make_edgeinfo(7, valhalla::midgard::encode(shape), {0});
+  GraphTileHeader header;
+  header.set_graphid({2, 2, 0});
+  header.set_nodecount(nodes.size());
+  header.set_directededgecount(edges.size());
+  std::vector<std::pair<TileSection::Type, std::string> > sections = {
+    {TileSection::Type::kTextList, textlist},
+    {TileSection::Type::kDirectedEdges, to_bytes(edges)},
+    {static_cast<TileSection::Type>(1000), std::string(5, 'z')},
+    {TileSection::Type::kNodes, to_bytes(nodes)},
+    {TileSection::Type::kEdgeInfo, edgeinfo},
+    {TileSection::Type::kQuantizedShapes, QuantizedShapes::Serialize({{0, shape}})}
+  };
+  write_bytes(h, {2, 2, 0}, SerializeTile(header, sections));
+  GraphTile tile(h, {2, 2, 0});
+
+  if (tile.size() == 0 || tile.header()->format_version() != kTileFormatV2 ||
+      tile.header()->section_count() != sections.size())
+    throw std::runtime_error("Expected a version 2 tile to load");
+  uint32_t count, edge_index;
+  const DirectedEdge* edge = tile.GetDirectedEdges(0, count, edge_index);
+  if (count != 2 || edge[1].length() != 200 || tile.node(size_t(0))->edge_count() != 2)
+    throw std::runtime_error("Unexpected nodes or edges in the version 2 tile");
+  if (reinterpret_cast<uintptr_t>(edge) % kTileSectionAlignment != 0 ||
+      reinterpret_cast<uintptr_t>(tile.node(size_t(0))) % kTileSectionAlignment != 0)
+    throw std::runtime_error("Sections should be aligned to cache lines");
+  if (tile.GetNames(0) != std::vector<std::string>{"Main Street"} ||
+      tile.edgeinfo(0).wayid() != 7 || tile.edgeinfo(0).quantized_shape().size() != 4)
+    throw std::runtime_error("Unexpected edge info in the version 2 tile");
+
+  // Version 1 tiles (format version 0 in the header) still load
+  GraphTileHeader v1;
+  v1.set_graphid({2, 2, 0});
+  v1.set_nodecount(nodes.size());
+  v1.set_directededgecount(edges.size());
+  if (v1.format_version() != kTileFormatV1)
+    throw std::runtime_error("Headers should default to version 1");
+  write_tile(h, v1, to_bytes(nodes) + to_bytes(edges), edgeinfo, textlist);
+  GraphTile tile_v1(h, {2, 2, 0});
+  if (tile_v1.size() == 0 || tile_v1.directededge(size_t(1))->length() != 200 ||
+      tile_v1.GetNames(0) != std::vector<std::string>{"Main Street"})
+    throw std::runtime_error("Expected a version 1 tile to load");
+
+  // The edge info and text list sections are required, even if empty
+  for (const auto type : {TileSection::Type::kEdgeInfo, TileSection::Type::kTextList}) {
+    auto missing = sections;
+    missing.erase(std::remove_if(missing.begin(), missing.end(),
+        [type](const std::pair<TileSection::Type, std::string>& section) {
+          return section.first == type;
+        }), missing.end());
+    write_bytes(h, {2, 2, 0}, SerializeTile(header, missing));
+    if (GraphTile(h, {2, 2, 0}).size() != 0)
+      throw std::runtime_error("Expected a tile without edge info or text list to fail to load");
+  }
+
+  // A record section that does not match its count, and an unknown version
+  sections[1].second = to_bytes(std::vector<DirectedEdge>(1));
+  write_bytes(h, {2, 2, 0}, SerializeTile(header, sections));
+  if (GraphTile(h, {2, 2, 0}).size() != 0)
+    throw std::runtime_error("Expected a mismatched section to fail to load");
+  header.set_format_version(3);
+  write_bytes(h, {2, 2, 0}, std::string(reinterpret_cast<const char*>(&header), sizeof(header)));
+  if (GraphTile(h, {2, 2, 0}).size() != 0)
+    throw std::runtime_error("Expected an unknown format version to fail to load");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestLazyLoading() {
+  auto pt = test_config();
+  TileHierarchy h(pt);
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // 2 nodes with an edge each, both with a named and shaped edge info
+  std::vector<NodeInfo> nodes(2);
+  nodes[0].set_edge_count(1);
+  nodes[1].set_edge_index(1);
+  nodes[1].set_edge_count(1);
+  std::vector<DirectedEdge> edges(2);
+  edges[0].set_length(100);
+  edges[1].set_length(200);
+  std::vector<PointLL> shape = {{-76.3f, 40.1f}, {-76.31f, 40.12f}};
+  std::string textlist("Main Street\0", 12);
+  std::string edgeinfo = make_edgeinfo(7, valhalla::midgard::encode(shape), {0});
+  GraphTileHeader header;
+  header.set_graphid({2, 2, 0});
+  header.set_nodecount(nodes.size());
+  header.set_directededgecount(edges.size());
+
+  // Lazily loaded tiles match fully read tiles for both tile layouts
+  for (auto version : {kTileFormatV1, kTileFormatV2}) {
+    if (version == kTileFormatV1) {
+      write_tile(h, header, to_bytes(nodes) + to_bytes(edges), edgeinfo, textlist,
+                 QuantizedShapes::Serialize({{0, shape}}));
+    } else {
+      write_bytes(h, {2, 2, 0}, SerializeTile(header, {
+        {TileSection::Type::kNodes, to_bytes(nodes)},
+        {TileSection::Type::kDirectedEdges, to_bytes(edges)},
+        {TileSection::Type::kEdgeInfo, edgeinfo},
+        {TileSection::Type::kTextList, textlist},
+        {TileSection::Type::kQuantizedShapes, QuantizedShapes::Serialize({{0, shape}})}}));
+    }
+    GraphTile eager(h, {2, 2, 0});
+    GraphTile lazy(h, {2, 2, 0}, true);
+    if (lazy.size() == 0 || lazy.size() != eager.size() ||
+        lazy.header()->nodecount() != 2 || lazy.node(size_t(1))->edge_index() != 1 ||
+        lazy.directededge(size_t(1))->length() != 200)
+      throw std::runtime_error("Unexpected routing core in a lazily loaded tile");
+
+    // Names and shapes are read on demand, from several threads at once
+    std::vector<std::thread> threads;
+    std::atomic<size_t> mismatches(0);
+    for (size_t i = 0; i < 4; ++i) {
+      threads.emplace_back([&lazy, &eager, &mismatches]() {
+        if (lazy.GetNames(0) != eager.GetNames(0) ||
+            lazy.edgeinfo(0).wayid() != 7 ||
+            lazy.edgeinfo(0).shape() != eager.edgeinfo(0).shape() ||
+            lazy.edgeinfo(0).quantized_shape().size() != 4) {
+          ++mismatches;
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    if (mismatches != 0 || lazy.GetNames(0) != std::vector<std::string>{"Main Street"})
+      throw std::runtime_error("Unexpected edge info in a lazily loaded tile");
+  }
+
+  // The reader loads tiles lazily when configured to
+  pt.put("lazy_tiles", true);
+  GraphReader reader(pt);
+  const GraphTile* tile = reader.GetGraphTile({2, 2, 0});
+  if (tile == nullptr || tile->GetNames(0) != std::vector<std::string>{"Main Street"})
+    throw std::runtime_error("Expected the reader to load the tile lazily");
+
+  // Missing and truncated tiles fail to load
+  if (GraphTile(h, {3, 2, 0}, true).size() != 0)
+    throw std::runtime_error("Expected a missing tile to fail to load");
+  write_bytes(h, {2, 2, 0}, std::string(10, '\0'));
+  if (GraphTile(h, {2, 2, 0}, true).size() != 0)
+    throw std::runtime_error("Expected a truncated tile to fail to load");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestBoundaryEdges() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // Edges into the east and north neighbors, a transition up a level and
+  // edges within the tile, interleaved
+  GraphId tile_id = h.GetGraphId({-76.2f, 40.1f}, 2);
+  GraphId east = h.GetGraphId({-75.9f, 40.1f}, 2);
+  GraphId north = h.GetGraphId({-76.2f, 40.3f}, 2);
+  GraphId arterial = h.GetGraphId({-76.2f, 40.1f}, 1);
+  std::vector<GraphId> endnodes = {{east.tileid(), 2, 3}, {tile_id.tileid(), 2, 0},
+                                   {north.tileid(), 2, 0}, {east.tileid(), 2, 1},
+                                   {arterial.tileid(), 1, 5}, {tile_id.tileid(), 2, 1}};
+  std::vector<DirectedEdge> edges(endnodes.size());
+  for (size_t i = 0; i < edges.size(); ++i) {
+    edges[i].set_endnode(endnodes[i]);
+    edges[i].set_leaves_tile(endnodes[i].Tile_Base() != tile_id);
+  }
+  GraphTileHeader header;
+  header.set_graphid(tile_id);
+  header.set_directededgecount(edges.size());
+  write_tile(h, header, to_bytes(edges));
+  GraphTile tile(h, tile_id);
+
+  auto tiles = tile.GetBoundaryTiles();
+  std::vector<GraphId> expected = {east, north, arterial};
+  std::sort(expected.begin(), expected.end());
+  if (tiles != expected)
+    throw std::runtime_error("Unexpected boundary tiles");
+  auto to_vector = [](const valhalla::midgard::iterable_t<const uint32_t>& edges) {
+    return std::vector<uint32_t>(edges.begin(), edges.end());
+  };
+  if (to_vector(tile.GetBoundaryEdges(east)) != std::vector<uint32_t>{0, 3} ||
+      to_vector(tile.GetBoundaryEdges({north.tileid(), 2, 7})) != std::vector<uint32_t>{2} ||
+      to_vector(tile.GetBoundaryEdges(arterial)) != std::vector<uint32_t>{4})
+    throw std::runtime_error("Unexpected boundary edges");
+  if (tile.GetBoundaryEdges(tile_id).size() != 0 || GraphTile().GetBoundaryTiles().size() != 0)
+    throw std::runtime_error("Expected no boundary edges");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
 }
 
 int main() {
@@ -45,5 +762,27 @@ int main() {
 
   suite.test(TEST_CASE(TestFileSuffix));
 
+  suite.test(TEST_CASE(TestTransfers));
+
+  suite.test(TEST_CASE(TestDepartures));
+
+  suite.test(TEST_CASE(TestQuantizedShapes));
+
+  suite.test(TEST_CASE(TestEdgesByName));
+
+  suite.test(TEST_CASE(TestFindEdges));
+
+  suite.test(TEST_CASE(TestEdgeCores));
+
+  suite.test(TEST_CASE(TestNodeCores));
+
+  suite.test(TEST_CASE(TestEdgeCosts));
+
+  suite.test(TEST_CASE(TestTileFormatV2));
+
+  suite.test(TEST_CASE(TestLazyLoading));
+
+  suite.test(TEST_CASE(TestBoundaryEdges));
+
   return suite.tear_down();
 }
@@ -0,0 +1,68 @@
+#include "test.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "baldr/nameinterner.h"
+
+using namespace std;
+using namespace valhalla::baldr;
+
+namespace {
+
+void TestIntern() {
+  NameInterner interner;
+  if (interner.Find("Main Street") != kInvalidNameId)
+    throw runtime_error("Name should not be interned yet");
+
+  // Names from different buffers (e.g. tiles) map to the same id
+  std::string a("Main Street"), b("Main Street Extension");
+  uint32_t id = interner.Intern(a);
+  if (interner.Intern(boost::string_ref(b.data(), 11)) != id ||
+      interner.Find("Main Street") != id)
+    throw runtime_error("Identical names should have the same id");
+  if (interner.Intern(b) == id || interner.size() != 2)
+    throw runtime_error("Different names should have different ids");
+
+  // The interner owns a copy of the name
+  a = "Changed";
+  if (interner.name(id) != "Main Street")
+    throw runtime_error("Unexpected interned name");
+}
+
+void TestThreads() {
+  NameInterner interner;
+  std::vector<std::thread> threads;
+  std::vector<std::vector<uint32_t> > ids(4);
+  for (size_t t = 0; t < ids.size(); ++t) {
+    threads.emplace_back([&interner, &ids, t]() {
+      for (int i = 0; i < 1000; ++i) {
+        ids[t].push_back(interner.Intern("Name " + std::to_string(i)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (interner.size() != 1000)
+    throw runtime_error("Expected 1000 names");
+  for (const auto& thread_ids : ids) {
+    if (thread_ids != ids.front())
+      throw runtime_error("All threads should get the same ids");
+  }
+  if (interner.name(ids[0][999]) != "Name 999")
+    throw runtime_error("Unexpected interned name");
+}
+
+}
+
+int main() {
+  test::suite suite("nameinterner");
+
+  suite.test(TEST_CASE(TestIntern));
+
+  suite.test(TEST_CASE(TestThreads));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,246 @@
+#include "test.h"
+#include "tiles.h"
+
+#include "baldr/graphreader.h"
+#include "baldr/nodecomponents.h"
+
+#include <boost/filesystem.hpp>
+
+using namespace std;
+using namespace valhalla::baldr;
+
+namespace {
+
+boost::property_tree::ptree test_config() {
+  std::stringstream json; json << "\
+  {\
+    \"tile_dir\": \"test/nodecomponents_tiles\",\
+    \"levels\": [\
+      {\"name\": \"local\", \"level\": 2, \"size\": 0.25},\
+      {\"name\": \"highway\", \"level\": 0, \"size\": 4},\
+      {\"name\": \"arterial\", \"level\": 1, \"size\": 1, \"importance_cutoff\": \"Trunk\"}\
+    ]\
+  }";
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(json, pt);
+  return pt;
+}
+
+DirectedEdge make_edge(const GraphId& endnode, const uint32_t access = kAllAccess,
+                       const uint32_t length = 100) {
+  DirectedEdge edge;
+  edge.set_endnode(endnode);
+  edge.set_length(length);
+  edge.set_speed(50);
+  edge.set_forwardaccess(access);
+  return edge;
+}
+
+// West nodes w0..w5 and east node e0:
+//   w0 <-> w1 <-> e0   the main component, across the tiles
+//   w2 <-> w3          an island
+//   w4  -> w0          a one way street onto the main component
+//   w5 <-> w1          a footpath
+struct TestGraph {
+  GraphId west, east;
+  std::vector<GraphId> w;
+  GraphId e0;
+};
+
+TestGraph write_graph(const TileHierarchy& h, const bool extra_node = false,
+                      const uint32_t length = 100) {
+  TestGraph g;
+  g.west = h.GetGraphId({-76.2f, 40.1f}, 2);
+  g.east = h.GetGraphId({-75.9f, 40.1f}, 2);
+  for (uint32_t i = 0; i < 6; ++i) {
+    g.w.emplace_back(g.west.tileid(), 2, i);
+  }
+  g.e0 = GraphId(g.east.tileid(), 2, 0);
+  std::vector<std::vector<DirectedEdge> > west = {
+    {make_edge(g.w[1], kAllAccess, length)},
+    {make_edge(g.w[0], kAllAccess, length), make_edge(g.e0, kAllAccess, length),
+     make_edge(g.w[5], kPedestrianAccess, length)},
+    {make_edge(g.w[3], kAllAccess, length)},
+    {make_edge(g.w[2], kAllAccess, length)},
+    {make_edge(g.w[0], kAllAccess, length)},
+    {make_edge(g.w[1], kPedestrianAccess, length)}
+  };
+  if (extra_node) {
+    west.push_back({});
+  }
+  test::write_tile(h, g.west, west);
+  test::write_tile(h, g.east, {{make_edge(g.w[1], kAllAccess, length)}});
+  return g;
+}
+
+void TestBuildComponents() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+  auto g = write_graph(h);
+  if (BuildComponents(h) != 2)
+    throw std::runtime_error("Expected labels for 2 tiles");
+
+  NodeComponents west(NodeComponents::FileName(g.west, h));
+  NodeComponents east(NodeComponents::FileName(g.east, h));
+  if (west.tile() != g.west || west.nodecount() != 6 || east.nodecount() != 1)
+    throw std::runtime_error("Unexpected labels file");
+
+  // Strong components
+  auto main = west.strong(0, kAutoAccess);
+  if (main == kNoComponent || west.strong(1, kAutoAccess) != main ||
+      east.strong(0, kAutoAccess) != main)
+    throw std::runtime_error("Expected the main component across the tiles");
+  if (west.strong(2, kAutoAccess) != west.strong(3, kAutoAccess) ||
+      west.strong(2, kAutoAccess) == main)
+    throw std::runtime_error("Expected the island to be a component");
+  if (west.strong(4, kAutoAccess) == main || west.strong(5, kAutoAccess) == main ||
+      west.strong(4, kAutoAccess) == west.strong(5, kAutoAccess))
+    throw std::runtime_error("Expected the one way and footpath ends on their own");
+  if (west.strong(5, kPedestrianAccess) != west.strong(0, kPedestrianAccess))
+    throw std::runtime_error("Expected the footpath to join the main component on foot");
+
+  // Weak components
+  auto weak = west.weak(0, kAutoAccess);
+  if (west.weak(4, kAutoAccess) != weak || east.weak(0, kAutoAccess) != weak ||
+      west.weak(2, kAutoAccess) == weak || west.weak(5, kAutoAccess) == weak ||
+      west.weak(5, kPedestrianAccess) != west.weak(0, kPedestrianAccess))
+    throw std::runtime_error("Unexpected weak components");
+  if (west.strong(6, kAutoAccess) != kNoComponent || west.weak(0, kTruckAccess) != kNoComponent)
+    throw std::runtime_error("Expected no label");
+
+  // Round trip through a file
+  west.Write("test/nodecomponents.scc");
+  NodeComponents read("test/nodecomponents.scc");
+  boost::filesystem::remove("test/nodecomponents.scc");
+  for (uint32_t n = 0; n < 6; ++n) {
+    for (auto access : kComponentModes) {
+      if (read.strong(n, access) != west.strong(n, access) || read.weak(n, access) != west.weak(n, access))
+        throw std::runtime_error("Labels do not round trip");
+    }
+  }
+  if (NodeComponents("test/missing.scc").tile().Is_Valid())
+    throw std::runtime_error("Expected empty labels");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestLongCycle() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // A one way loop deep enough to overflow a recursive search
+  GraphId tile_id = h.GetGraphId({-76.2f, 40.1f}, 2);
+  const uint32_t count = 200000;
+  std::vector<std::vector<DirectedEdge> > nodes(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    nodes[i].push_back(make_edge(GraphId(tile_id.tileid(), 2, (i + 1) % count)));
+  }
+  test::write_tile(h, tile_id, nodes);
+  BuildComponents(h, {kAutoAccess});
+
+  NodeComponents components(NodeComponents::FileName(tile_id, h));
+  for (uint32_t i = 0; i < count; ++i) {
+    if (components.strong(i, kAutoAccess) != 0)
+      throw std::runtime_error("Expected the loop to be one strong component");
+  }
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+// Transition edges carry no access of their own
+DirectedEdge make_transition(const GraphId& endnode, const bool up) {
+  DirectedEdge edge = make_edge(endnode, 0, 0);
+  if (up) {
+    edge.set_trans_up(true);
+  } else {
+    edge.set_trans_down(true);
+  }
+  return edge;
+}
+
+void TestAcrossLevels() {
+  auto pt = test_config();
+  TileHierarchy h(pt);
+  boost::filesystem::remove_all(h.tile_dir());
+
+  // Arterial nodes a0 and a1 are only joined through the local level, a2
+  // is on its own
+  GraphId arterial = h.GetGraphId({-76.2f, 40.1f}, 1);
+  GraphId local = h.GetGraphId({-76.2f, 40.1f}, 2);
+  GraphId a0(arterial.tileid(), 1, 0), a1(arterial.tileid(), 1, 1), a2(arterial.tileid(), 1, 2);
+  GraphId w0(local.tileid(), 2, 0), w1(local.tileid(), 2, 1);
+  test::write_tile(h, arterial, {{make_transition(w0, false)}, {make_transition(w1, false)}, {}});
+  test::write_tile(h, local, {{make_edge(w1), make_transition(a0, true)},
+                              {make_edge(w0), make_transition(a1, true)}});
+  if (BuildComponents(h) != 2)
+    throw std::runtime_error("Expected labels for the tiles of both levels");
+
+  NodeComponents upper(NodeComponents::FileName(arterial, h));
+  NodeComponents lower(NodeComponents::FileName(local, h));
+  if (upper.strong(0, kAutoAccess) != upper.strong(1, kAutoAccess) ||
+      upper.weak(0, kAutoAccess) != lower.weak(1, kAutoAccess) ||
+      upper.weak(2, kAutoAccess) == upper.weak(0, kAutoAccess))
+    throw std::runtime_error("Expected the levels to be joined by the transitions");
+
+  GraphReader reader(pt);
+  if (!reader.AreConnected(a0, a1, kAutoAccess) || !reader.AreConnected(a1, w0, kAutoAccess) ||
+      reader.AreConnected(a0, a2, kAutoAccess))
+    throw std::runtime_error("Expected the arterial nodes to be connected through the local level");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+void TestAreNodesConnected() {
+  auto pt = test_config();
+  TileHierarchy h(pt);
+  boost::filesystem::remove_all(h.tile_dir());
+  auto g = write_graph(h);
+
+  // Without labels the tiles are compared
+  {
+    GraphReader reader(pt);
+    if (reader.GetComponents(g.west) != nullptr || !reader.AreConnected(g.w[2], g.w[0], kAutoAccess))
+      throw std::runtime_error("Expected the tile connectivity without labels");
+  }
+
+  BuildComponents(h);
+  GraphReader reader(pt);
+  if (reader.AreConnected(g.w[2], g.w[0], kAutoAccess) || reader.AreConnected(g.e0, g.w[3], kAutoAccess))
+    throw std::runtime_error("Expected the island to be rejected");
+  if (!reader.AreConnected(g.w[4], g.e0, kAutoAccess) || !reader.AreConnected(g.e0, g.w[1], kAutoAccess))
+    throw std::runtime_error("Expected the main component to be connected");
+  if (reader.AreConnected(g.w[5], g.w[0], kAutoAccess) || !reader.AreConnected(g.w[5], g.e0, kPedestrianAccess))
+    throw std::runtime_error("Expected the footpath to be connected on foot only");
+
+  // Labels of a tile that changed since are not used
+  write_graph(h, true);
+  GraphReader changed(pt);
+  if (changed.GetComponents(g.west) != nullptr || changed.GetComponents(g.east) == nullptr ||
+      !changed.AreConnected(g.w[2], g.w[0], kAutoAccess))
+    throw std::runtime_error("Expected stale labels to be ignored");
+
+  // So are labels of a tile rebuilt with the same node count
+  BuildComponents(h);
+  write_graph(h, false, 200);
+  GraphReader rebuilt(pt);
+  if (rebuilt.GetComponents(g.west) != nullptr || !rebuilt.AreConnected(g.w[2], g.w[0], kAutoAccess))
+    throw std::runtime_error("Expected labels of a rebuilt tile to be ignored");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+}
+
+int main() {
+  test::suite suite("nodecomponents");
+
+  suite.test(TEST_CASE(TestBuildComponents));
+
+  suite.test(TEST_CASE(TestLongCycle));
+
+  suite.test(TEST_CASE(TestAcrossLevels));
+
+  suite.test(TEST_CASE(TestAreNodesConnected));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,118 @@
+#include "test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "baldr/packedrtree.h"
+
+using namespace std;
+using namespace valhalla::baldr;
+
+namespace {
+
+bool intersects(const PackedRTree::Box& a, const PackedRTree::Box& b) {
+  return !(a.minx > b.maxx || a.maxx < b.minx || a.miny > b.maxy || a.maxy < b.miny);
+}
+
+// Distance from a point to a box
+struct BoxDistance {
+  float operator()(const PackedRTree::Box& b) const {
+    float dx = std::max(std::max(b.minx - x, x - b.maxx), 0.0f);
+    float dy = std::max(std::max(b.miny - y, y - b.maxy), 0.0f);
+    return std::sqrt(dx * dx + dy * dy);
+  }
+  float x, y;
+};
+
+std::vector<PackedRTree::Box> random_boxes(const size_t count) {
+  std::mt19937 generator(17);
+  std::uniform_real_distribution<float> position(-76.f, -75.f);
+  std::uniform_real_distribution<float> size(0.f, 0.01f);
+  std::vector<PackedRTree::Box> boxes;
+  for (size_t i = 0; i < count; ++i) {
+    float x = position(generator), y = position(generator) + 116.f;
+    boxes.push_back({x, y, x + size(generator), y + size(generator)});
+  }
+  return boxes;
+}
+
+void TestQuery() {
+  for (size_t count : {0, 1, 16, 17, 1000}) {
+    auto boxes = random_boxes(count);
+    PackedRTree tree;
+    tree.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      tree.Add(boxes[i], i * 2);
+    }
+    tree.Build();
+    if (tree.size() != count)
+      throw runtime_error("Unexpected tree size");
+
+    for (const auto& query : random_boxes(20)) {
+      PackedRTree::Box q{query.minx, query.miny, query.minx + 0.1f, query.miny + 0.1f};
+      std::vector<uint32_t> expected, found;
+      for (size_t i = 0; i < count; ++i) {
+        if (intersects(boxes[i], q))
+          expected.push_back(i * 2);
+      }
+      tree.Query(q, found);
+      std::sort(found.begin(), found.end());
+      if (found != expected)
+        throw runtime_error("Query does not match a linear scan");
+    }
+  }
+}
+
+void TestNearest() {
+  auto boxes = random_boxes(1000);
+  PackedRTree tree;
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    tree.Add(boxes[i], i);
+  }
+  tree.Build();
+
+  // Exact distance is to the center of each box
+  for (const auto& query : random_boxes(20)) {
+    BoxDistance box_distance{query.minx, query.miny};
+    auto distance = [&boxes, &box_distance](const uint32_t id) {
+      PackedRTree::Box center{(boxes[id].minx + boxes[id].maxx) * 0.5f,
+                              (boxes[id].miny + boxes[id].maxy) * 0.5f, 0.f, 0.f};
+      center.maxx = center.minx;
+      center.maxy = center.miny;
+      return box_distance(center);
+    };
+    std::vector<float> expected;
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      expected.push_back(distance(i));
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<std::pair<float, uint32_t> > nearest;
+    tree.Nearest(10, std::numeric_limits<float>::max(), box_distance, distance, nearest);
+    if (nearest.size() != 10)
+      throw runtime_error("Expected 10 nearest items");
+    for (size_t i = 0; i < nearest.size(); ++i) {
+      if (nearest[i].first != expected[i] || distance(nearest[i].second) != nearest[i].first)
+        throw runtime_error("Nearest does not match a linear scan");
+    }
+
+    // Limit the distance
+    tree.Nearest(10, expected[2], box_distance, distance, nearest);
+    if (nearest.size() != 3)
+      throw runtime_error("Expected 3 items within the distance");
+  }
+}
+
+}
+
+int main() {
+  test::suite suite("packedrtree");
+
+  suite.test(TEST_CASE(TestQuery));
+
+  suite.test(TEST_CASE(TestNearest));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,89 @@
+#include "test.h"
+
+#include "baldr/parallel.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace valhalla::baldr;
+
+namespace {
+
+void TestThreadCount() {
+  if (ThreadCount(4, 10) != 4 || ThreadCount(4, 2) != 2 || ThreadCount(4, 0) != 1)
+    throw runtime_error("Expected at most one thread per item and at least 1");
+  if (ThreadCount(0, 1000000) != max(thread::hardware_concurrency(), 1u))
+    throw runtime_error("Expected the hardware concurrency");
+}
+
+void TestRunThreads() {
+  // Each thread runs once, the first on the calling thread
+  vector<int> runs(3, 0);
+  thread::id caller;
+  RunThreads(3, [&](const size_t thread) {
+    ++runs[thread];
+    if (thread == 0)
+      caller = this_thread::get_id();
+  });
+  if (runs != vector<int>(3, 1) || caller != this_thread::get_id())
+    throw runtime_error("Expected each thread to run once");
+
+  // The error of the first thread that threw is rethrown after all finished
+  atomic<int> finished(0);
+  try {
+    RunThreads(3, [&](const size_t thread) {
+      ++finished;
+      if (thread > 0)
+        throw runtime_error("thread " + to_string(thread));
+    });
+    throw logic_error("Expected an error");
+  }
+  catch (const runtime_error& e) {
+    if (string(e.what()) != "thread 1" || finished != 3)
+      throw runtime_error("Expected the error of the first thread");
+  }
+}
+
+void TestParallelFor() {
+  // Every item is worked on once, whatever the number of threads
+  for (size_t threads : {0, 1, 3, 100}) {
+    vector<atomic<int> > items(1000);
+    for (auto& item : items)
+      item = 0;
+    ParallelFor(items.size(), threads, [&](const size_t i) { ++items[i]; });
+    for (const auto& item : items)
+      if (item != 1)
+        throw runtime_error("Expected each item to be worked on once");
+  }
+  ParallelFor(0, 4, [](const size_t) { throw runtime_error("Expected no items"); });
+
+  bool thrown = false;
+  try {
+    ParallelFor(10, 2, [](const size_t i) {
+      if (i == 5)
+        throw runtime_error("item 5");
+    });
+  }
+  catch (const runtime_error& e) {
+    thrown = string(e.what()) == "item 5";
+  }
+  if (!thrown)
+    throw runtime_error("Expected the error of the item");
+}
+
+}
+
+int main() {
+  test::suite suite("parallel");
+
+  suite.test(TEST_CASE(TestThreadCount));
+
+  suite.test(TEST_CASE(TestRunThreads));
+
+  suite.test(TEST_CASE(TestParallelFor));
+
+  return suite.tear_down();
+}
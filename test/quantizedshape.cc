@@ -0,0 +1,90 @@
+#include "test.h"
+
+#include <cstdlib>
+#include <map>
+#include <vector>
+#include <string>
+
+#include "baldr/quantizedshape.h"
+
+using namespace std;
+using namespace valhalla::baldr;
+using namespace valhalla::midgard;
+
+namespace {
+
+void TestRoundTrip() {
+  std::map<uint32_t, std::vector<PointLL> > shapes = {
+    {40, {{-76.3f, 40.1f}, {-76.31f, 40.12f}}},
+    {0, {{179.999999f, -89.5f}, {-180.f, 90.f}, {0.f, 0.f}}},
+    {96, {{5.5f, 52.1f}}}
+  };
+  std::string section = QuantizedShapes::Serialize(shapes);
+  QuantizedShapes q(section.data(), section.size());
+  if (q.empty())
+    throw runtime_error("Expected quantized shapes");
+
+  for (const auto& shape : shapes) {
+    auto coords = q.find(shape.first);
+    if (coords.size() != shape.second.size() * 2)
+      throw runtime_error("Wrong number of coordinates for " + std::to_string(shape.first));
+    std::vector<PointLL> points(1);
+    QuantizedShapes::Dequantize(coords.begin(), coords.size() / 2, points);
+    if (points.size() != shape.second.size() + 1)
+      throw runtime_error("Dequantize should append to the list");
+    for (size_t i = 0; i < shape.second.size(); ++i) {
+      if (!equal(points[i + 1].lng(), shape.second[i].lng(), 1e-5f) ||
+          !equal(points[i + 1].lat(), shape.second[i].lat(), 1e-5f))
+        throw runtime_error("Dequantized point is incorrect");
+    }
+  }
+
+  // Coordinates can be read directly in 1e-6 degrees (to within float
+  // precision of the input)
+  if (q.find(96).begin()[0] != 5500000 || std::abs(q.find(96).begin()[1] - 52100000) > 4)
+    throw runtime_error("Unexpected quantized coordinates");
+
+  if (q.find(1).size() != 0 || q.find(200).size() != 0)
+    throw runtime_error("Expected no shape for unknown edge info offsets");
+}
+
+void TestInvalid() {
+  if (!QuantizedShapes().empty() || !QuantizedShapes(nullptr, 0).empty())
+    throw runtime_error("Expected no quantized shapes");
+
+  // A truncated section is ignored
+  std::string section = QuantizedShapes::Serialize({{0, {{1.f, 2.f}, {3.f, 4.f}}}});
+  QuantizedShapes q(section.data(), section.size() - 4);
+  if (!q.empty() || q.find(0).size() != 0)
+    throw runtime_error("Truncated section should be ignored");
+
+  // A point count that wraps around 32 bits is still truncated
+  QuantizedShapes::Entry* entries = reinterpret_cast<QuantizedShapes::Entry*>(&section[sizeof(uint32_t)]);
+  entries[1].point_offset = 0x80000000;
+  if (!QuantizedShapes(section.data(), section.size()).empty())
+    throw runtime_error("Section with a wrapping point count should be ignored");
+
+  // Point offsets past the end of the shapes, or out of order edge info
+  // offsets, are ignored
+  section = QuantizedShapes::Serialize({{0, {{1.f, 2.f}}}, {8, {{3.f, 4.f}}}});
+  entries = reinterpret_cast<QuantizedShapes::Entry*>(&section[sizeof(uint32_t)]);
+  entries[1].point_offset = 5;
+  if (!QuantizedShapes(section.data(), section.size()).empty())
+    throw runtime_error("Section with a shape past the coordinates should be ignored");
+  entries[1].point_offset = 1;
+  entries[1].edgeinfo_offset = 0;
+  if (!QuantizedShapes(section.data(), section.size()).empty())
+    throw runtime_error("Section with an unsorted index should be ignored");
+}
+
+}
+
+int main() {
+  test::suite suite("quantizedshape");
+
+  suite.test(TEST_CASE(TestRoundTrip));
+
+  suite.test(TEST_CASE(TestInvalid));
+
+  return suite.tear_down();
+}
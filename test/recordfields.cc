@@ -0,0 +1,197 @@
+#include "test.h"
+
+#include "baldr/recordfields.h"
+
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace valhalla::baldr;
+
+namespace {
+
+// Turn types, stop impacts and edge to left/right flags of all local
+// indexes packed as they are stored
+uint32_t turntypes(const DirectedEdge& e) {
+  uint32_t v = 0;
+  for (uint32_t i = 0; i <= kMaxLocalEdgeIndex; ++i)
+    v |= static_cast<uint32_t>(e.turntype(i)) << (3 * i);
+  return v;
+}
+uint32_t stopimpacts(const DirectedEdge& e) {
+  uint32_t v = 0;
+  for (uint32_t i = 0; i <= kMaxLocalEdgeIndex; ++i)
+    v |= e.stopimpact(i) << (3 * i);
+  return v;
+}
+uint32_t edges_to_left(const DirectedEdge& e) {
+  uint32_t v = 0;
+  for (uint32_t i = 0; i <= kMaxLocalEdgeIndex; ++i)
+    v |= static_cast<uint32_t>(e.edge_to_left(i)) << i;
+  return v;
+}
+uint32_t edges_to_right(const DirectedEdge& e) {
+  uint32_t v = 0;
+  for (uint32_t i = 0; i <= kMaxLocalEdgeIndex; ++i)
+    v |= static_cast<uint32_t>(e.edge_to_right(i)) << i;
+  return v;
+}
+
+// Each field read through its accessor, in the order of DirectedEdgeField
+std::vector<uint32_t> edge_fields(const DirectedEdge& e) {
+  return {
+    static_cast<uint32_t>(e.edgeinfo_offset()), static_cast<uint32_t>(e.access_restriction()),
+    e.exitsign(),
+    e.speed(), e.truck_speed(), e.restrictions(), e.lanecount(), e.bike_network(),
+    static_cast<uint32_t>(e.use()), static_cast<uint32_t>(e.speed_type()), e.opp_index(),
+    e.drive_on_right(), e.toll(), e.seasonal(), e.destonly(), e.tunnel(), e.bridge(),
+    e.roundabout(), e.unreachable(), e.traffic_signal(), e.forward(), e.not_thru(),
+    static_cast<uint32_t>(e.cyclelane()), e.truck_route(), e.ctry_crossing(),
+    e.forwardaccess(), e.reverseaccess(), static_cast<uint32_t>(e.classification()),
+    static_cast<uint32_t>(e.surface()), e.link(), e.internal(),
+    turntypes(e), edges_to_left(e), e.length(), e.weighted_grade(), e.curvature(),
+    stopimpacts(e), edges_to_right(e), e.lineid(),
+    e.localedgeidx(), e.opp_local_idx(), e.shortcut(), e.superseded(), e.trans_up(),
+    e.trans_down(), e.is_shortcut(), e.leaves_tile()
+  };
+}
+
+// Each field read through its accessor, in the order of NodeInfoField
+std::vector<uint32_t> node_fields(const NodeInfo& n) {
+  uint32_t driveability = 0;
+  for (uint32_t i = 0; i <= kMaxLocalEdgeIndex; ++i)
+    driveability |= static_cast<uint32_t>(n.local_driveability(i)) << (2 * i);
+  return {
+    n.edge_index(), n.access(), n.edge_count(), static_cast<uint32_t>(n.bestrc()),
+    n.admin_index(), n.timezone(), static_cast<uint32_t>(n.intersection()),
+    driveability, n.density(), static_cast<uint32_t>(n.type()), n.local_edge_count() - 1,
+    n.parent(), n.child(), n.mode_change(), n.traffic_signal(), n.stop_index()
+  };
+}
+
+void TestDirectedEdgeFields() {
+  // Random values in every field, set through the setters
+  std::mt19937 gen(7);
+  auto bits = [&gen](uint32_t width) {
+    return static_cast<uint32_t>(gen() & ((uint64_t(1) << width) - 1));
+  };
+  std::vector<DirectedEdge> edges(37);
+  for (size_t j = 0; j < edges.size(); ++j) {
+    auto& e = edges[j];
+    e.set_endnode(GraphId(bits(22), bits(3), bits(21)));
+    e.set_edgeinfo_offset(bits(25));
+    e.set_access_restriction(bits(12));
+    e.set_exitsign(bits(1));
+    e.set_speed(bits(8));
+    e.set_truck_speed(bits(8));
+    e.set_restrictions(bits(8));
+    e.set_lanecount(bits(4));
+    e.set_bike_network(bits(4));
+    e.set_use(static_cast<Use>(bits(5)));
+    e.set_speed_type(static_cast<SpeedType>(bits(1)));
+    e.set_opp_index(bits(7));
+    e.set_drive_on_right(bits(1));
+    e.set_toll(bits(1));
+    e.set_seasonal(bits(1));
+    e.set_dest_only(bits(1));
+    e.set_tunnel(bits(1));
+    e.set_bridge(bits(1));
+    e.set_roundabout(bits(1));
+    e.set_unreachable(bits(1));
+    e.set_traffic_signal(bits(1));
+    e.set_forward(bits(1));
+    e.set_not_thru(bits(1));
+    e.set_cyclelane(static_cast<CycleLane>(bits(2)));
+    e.set_truck_route(bits(1));
+    e.set_ctry_crossing(bits(1));
+    e.set_forwardaccess(bits(8));
+    e.set_reverseaccess(bits(8));
+    e.set_classification(static_cast<RoadClass>(bits(3)));
+    e.set_surface(static_cast<Surface>(bits(3)));
+    e.set_link(bits(1));
+    e.set_internal(bits(1));
+    e.set_length(bits(20));
+    e.set_weighted_grade(bits(4));
+    e.set_curvature(bits(4));
+    for (uint32_t i = 0; i <= kMaxLocalEdgeIndex; ++i) {
+      e.set_turntype(i, static_cast<Turn::Type>(bits(3)));
+      e.set_edge_to_left(i, bits(1));
+      e.set_edge_to_right(i, bits(1));
+      if (j % 2)
+        e.set_stopimpact(i, bits(3));
+    }
+    if (j % 2 == 0)
+      e.set_lineid(gen());
+    e.set_localedgeidx(bits(7));
+    e.set_opp_local_idx(bits(7));
+    if (bits(1))
+      e.set_shortcut(1 + bits(2));
+    else
+      e.set_superseded(1 + bits(2));
+    e.set_trans_up(bits(1));
+    e.set_trans_down(bits(1));
+    e.set_leaves_tile(bits(1));
+  }
+
+  std::vector<uint32_t> values(edges.size());
+  for (size_t f = 0; f < static_cast<size_t>(DirectedEdgeField::kCount); ++f) {
+    ExtractField(edges.data(), edges.size(), static_cast<DirectedEdgeField>(f), values.data());
+    for (size_t j = 0; j < edges.size(); ++j) {
+      if (values[j] != edge_fields(edges[j])[f])
+        throw std::runtime_error("DirectedEdge field " + std::to_string(f) +
+                                 " does not match its accessor");
+    }
+  }
+}
+
+void TestNodeInfoFields() {
+  std::mt19937 gen(11);
+  auto bits = [&gen](uint32_t width) {
+    return static_cast<uint32_t>(gen() & ((uint64_t(1) << width) - 1));
+  };
+  std::vector<NodeInfo> nodes(29);
+  for (size_t j = 0; j < nodes.size(); ++j) {
+    auto& n = nodes[j];
+    n.set_latlng(std::make_pair(-76.5f, 40.5f));
+    n.set_edge_index(bits(22));
+    n.set_access(bits(12));
+    n.set_edge_count(bits(7));
+    n.set_bestrc(static_cast<RoadClass>(bits(3)));
+    n.set_admin_index(bits(6));
+    n.set_timezone(bits(9));
+    n.set_intersection(static_cast<IntersectionType>(bits(2)));
+    for (uint32_t i = 0; i <= kMaxLocalEdgeIndex; ++i)
+      n.set_local_driveability(i, static_cast<Traversability>(bits(2)));
+    n.set_density(bits(4));
+    n.set_type(static_cast<NodeType>(bits(3)));
+    n.set_local_edge_count(1 + bits(3));
+    n.set_parent(bits(1));
+    n.set_child(bits(1));
+    n.set_mode_change(bits(1));
+    n.set_traffic_signal(bits(1));
+    n.set_stop_index(gen());
+    n.set_heading(0, 90);
+  }
+
+  std::vector<uint32_t> values(nodes.size());
+  for (size_t f = 0; f < static_cast<size_t>(NodeInfoField::kCount); ++f) {
+    ExtractField(nodes.data(), nodes.size(), static_cast<NodeInfoField>(f), values.data());
+    for (size_t j = 0; j < nodes.size(); ++j) {
+      if (values[j] != node_fields(nodes[j])[f])
+        throw std::runtime_error("NodeInfo field " + std::to_string(f) +
+                                 " does not match its accessor");
+    }
+  }
+}
+
+}
+
+int main() {
+  test::suite suite("recordfields");
+
+  suite.test(TEST_CASE(TestDirectedEdgeFields));
+
+  suite.test(TEST_CASE(TestNodeInfoFields));
+
+  return suite.tear_down();
+}
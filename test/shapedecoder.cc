@@ -0,0 +1,86 @@
+#include "test.h"
+
+#include <vector>
+#include <string>
+#include <random>
+
+#include "baldr/shapedecoder.h"
+#include <valhalla/midgard/util.h>
+
+using namespace std;
+using namespace valhalla::baldr;
+using namespace valhalla::midgard;
+
+namespace {
+
+void check(const std::string& encoded, const std::vector<PointLL>& shape) {
+  auto expected = decode<std::vector<PointLL> >(encoded);
+  if (shape.size() != expected.size())
+    throw runtime_error("Expected " + std::to_string(expected.size()) +
+                        " points but got " + std::to_string(shape.size()));
+  // Allow for float rounding differences at large longitudes
+  for (size_t i = 0; i < shape.size(); ++i) {
+    if (!equal(shape[i].lng(), expected[i].lng(), 5e-5f) ||
+        !equal(shape[i].lat(), expected[i].lat(), 5e-5f))
+      throw runtime_error("Point " + std::to_string(i) + " decoded incorrectly");
+  }
+}
+
+void TestDecode() {
+  // Long shapes make values straddle the internal chunks. Large jumps
+  // make long varints.
+  std::mt19937 generator(17);
+  std::uniform_real_distribution<float> lng(-180.f, 180.f), lat(-90.f, 90.f);
+  std::uniform_real_distribution<float> small(-0.001f, 0.001f);
+  for (size_t count : {1, 2, 5, 33, 100, 1000}) {
+    std::vector<PointLL> shape;
+    for (size_t i = 0; i < count; ++i) {
+      if (i % 3 == 0 || shape.empty())
+        shape.emplace_back(lng(generator), lat(generator));
+      else
+        shape.emplace_back(shape.back().lng() + small(generator),
+                           shape.back().lat() + small(generator));
+    }
+    auto encoded = encode(shape);
+    std::vector<PointLL> decoded;
+    if (DecodePolyline(encoded.data(), encoded.size(), decoded) != count)
+      throw runtime_error("Wrong number of points decoded");
+    check(encoded, decoded);
+  }
+}
+
+void TestAppend() {
+  std::vector<PointLL> a = {{-76.3f, 40.1f}, {-76.31f, 40.12f}};
+  std::vector<PointLL> b = {{2.35f, 48.85f}, {2.36f, 48.86f}, {2.37f, 48.80f}};
+  auto ea = encode(a), eb = encode(b);
+
+  // The buffer is appended to so many shapes can share it
+  std::vector<PointLL> buffer;
+  DecodePolyline(ea.data(), ea.size(), buffer);
+  DecodePolyline(eb.data(), eb.size(), buffer);
+  if (buffer.size() != 5)
+    throw runtime_error("Expected both shapes in the buffer");
+  check(eb, std::vector<PointLL>(buffer.begin() + 2, buffer.end()));
+
+  // Nothing to decode
+  if (DecodePolyline(ea.data(), 0, buffer) != 0 || buffer.size() != 5)
+    throw runtime_error("Empty input should not decode anything");
+
+  // Truncated input decodes the complete points only
+  std::vector<PointLL> truncated;
+  DecodePolyline(eb.data(), eb.size() - 1, truncated);
+  if (truncated.size() != 2)
+    throw runtime_error("Expected only the complete points of truncated input");
+}
+
+}
+
+int main() {
+  test::suite suite("shapedecoder");
+
+  suite.test(TEST_CASE(TestDecode));
+
+  suite.test(TEST_CASE(TestAppend));
+
+  return suite.tear_down();
+}
@@ -80,6 +80,25 @@ void TestFindCommonBaseNames() {
 
 }
 
+void TestFindCommonInternedStreetNames() {
+  // Interned names compare by id and keep their ids in the result
+  StreetNames lhs({ "Hershey Road", "PA 743 North" }, true);
+  StreetNames rhs({ "Fishburn Road", "PA 743 North" }, true);
+  TryFindCommonStreetNames(lhs, rhs, StreetNames( { "PA 743 North" }));
+  auto common = lhs.FindCommonStreetNames(rhs);
+  if (common->front()->id() != NameInterner::Get().Find("PA 743 North") ||
+      common->front()->id() == kInvalidNameId)
+    throw std::runtime_error("Common street name should keep its interned id");
+  if (lhs.clone()->back()->id() != lhs.back()->id())
+    throw std::runtime_error("Cloned street name should keep its interned id");
+
+  // Interned names still match names that are not interned
+  TryFindCommonStreetNames(lhs, StreetNames( { "PA 743 North" }),
+                           StreetNames( { "PA 743 North" }));
+  TryFindCommonStreetNames(StreetNames( { "PA 743" }, true), rhs,
+                           StreetNames());
+}
+
 }
 
 int main() {
@@ -91,6 +110,9 @@ int main() {
   // FindCommonStreetNames
   suite.test(TEST_CASE(TestFindCommonStreetNames));
 
+  // FindCommonStreetNames with interned names
+  suite.test(TEST_CASE(TestFindCommonInternedStreetNames));
+
   // FindCommonBaseNames
   suite.test(TEST_CASE(TestFindCommonBaseNames));
 
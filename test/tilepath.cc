@@ -0,0 +1,134 @@
+#include "test.h"
+
+#include "baldr/graphtile.h"
+#include "baldr/tilehierarchy.h"
+#include "baldr/tilepath.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <boost/filesystem.hpp>
+
+using namespace std;
+using namespace valhalla::baldr;
+
+namespace {
+
+boost::property_tree::ptree test_config() {
+  std::stringstream json; json << "\
+  {\
+    \"tile_dir\": \"test/tilepath_tiles\",\
+    \"levels\": [\
+      {\"name\": \"local\", \"level\": 2, \"size\": 0.25},\
+      {\"name\": \"highway\", \"level\": 0, \"size\": 4},\
+      {\"name\": \"arterial\", \"level\": 1, \"size\": 1, \"importance_cutoff\": \"Trunk\"}\
+    ]\
+  }";
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(json, pt);
+  return pt;
+}
+
+GraphId parse(const TilePath& tile_path, const std::string& path) {
+  return tile_path.Parse(path.data(), path.size());
+}
+
+void touch(const std::string& path) {
+  boost::filesystem::create_directories(boost::filesystem::path(path).parent_path());
+  std::ofstream file(path);
+}
+
+void TestRoundTrip() {
+  TileHierarchy h(test_config());
+  const auto& tile_path = h.tile_path();
+  for (const auto& level : h.levels()) {
+    uint32_t count = level.second.tiles.TileCount();
+    for (uint32_t id : {0u, 1u, 999u, 1000u, count / 2, count - 1}) {
+      GraphId tile(id, level.first, 0);
+      char buffer[TilePath::kMaxLength];
+      size_t length = tile_path.Format(tile, buffer);
+      if (length != std::strlen(buffer) || tile_path.Path(tile) != std::string(buffer, length))
+        throw std::runtime_error("Unexpected path length");
+      if (parse(tile_path, buffer) != tile || parse(tile_path, h.tile_dir() + '/' + buffer) != tile)
+        throw std::runtime_error("Path does not round trip: " + std::string(buffer));
+    }
+  }
+  if (tile_path.Path({1036799, 2, 0}) != "2/001/036/799.gph" ||
+      tile_path.Path({4049, 0, 0}) != "0/004/049.gph")
+    throw std::runtime_error("Unexpected path");
+  if (tile_path.FullPath("tiles", {4049, 0, 7}) != "tiles/0/004/049.gph" ||
+      tile_path.FullPath("tiles", {4049, 0, 7}, ".ovl") != "tiles/0/004/049.ovl")
+    throw std::runtime_error("Unexpected full path");
+
+  try {
+    tile_path.Path({0, 3, 0});
+    throw std::logic_error("Expected an unknown level to throw");
+  } catch (const std::runtime_error&) {
+  }
+}
+
+void TestParse() {
+  TileHierarchy h(test_config());
+  const auto& tile_path = h.tile_path();
+
+  // Numeric directories before the tile path are not part of it
+  if (parse(tile_path, "/data/2/1/064/799.gph") != GraphId(64799, 1, 0) ||
+      parse(tile_path, "2/000/000/002.gph") != GraphId(2, 2, 0))
+    throw std::runtime_error("Expected a tile path");
+
+  for (const auto& path : {"000/000/002.gph", "2/000/002.gph", "1/000/064/799.gph",
+                           "02/000/000/002.gph", "2/000/00/002.gph", "2/000/000/002.ovl",
+                           "2/000/000/0a2.gph", "3/000/002.gph", ".gph", "002.gph"}) {
+    if (parse(tile_path, path).Is_Valid())
+      throw std::runtime_error("Expected an invalid tile path: " + std::string(path));
+  }
+
+  try {
+    GraphTile::GetTileId(h.tile_dir() + "/2/000/002.gph", h);
+    throw std::logic_error("Expected an invalid tile path to throw");
+  } catch (const std::runtime_error&) {
+  }
+}
+
+void TestFindTiles() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+  std::vector<GraphId> expected = {{2, 2, 0}, {6897, 2, 0}, {64799, 1, 0}, {49, 0, 0}};
+  for (const auto& tile : expected) {
+    touch(h.tile_dir() + '/' + GraphTile::FileSuffix(tile, h));
+  }
+  touch(h.tile_dir() + "/2/000/000/002.scc");
+  touch(h.tile_dir() + "/2/000/000/2.gph");
+  touch(h.tile_dir() + "/connectivity.bin");
+  boost::filesystem::create_directories(h.tile_dir() + "/2/000/001.gph");
+
+  auto tiles = h.tile_path().FindTiles(h.tile_dir());
+  std::sort(tiles.begin(), tiles.end());
+  std::sort(expected.begin(), expected.end());
+  if (tiles != expected)
+    throw std::runtime_error("Unexpected tiles found");
+
+  if (!h.tile_path().FindTiles(h.tile_dir(), false).empty() ||
+      !h.tile_path().FindTiles(h.tile_dir() + "/missing").empty())
+    throw std::runtime_error("Expected no tiles");
+
+  auto level = h.tile_path().FindTiles(h.tile_dir() + "/1/");
+  if (level.size() != 1 || level.front() != GraphId(64799, 1, 0))
+    throw std::runtime_error("Expected the tile of the level");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+}
+
+int main() {
+  test::suite suite("tilepath");
+
+  suite.test(TEST_CASE(TestRoundTrip));
+
+  suite.test(TEST_CASE(TestParse));
+
+  suite.test(TEST_CASE(TestFindTiles));
+
+  return suite.tear_down();
+}
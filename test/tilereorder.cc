@@ -0,0 +1,292 @@
+#include "test.h"
+
+#include "baldr/celloverlay.h"
+#include "baldr/graphreader.h"
+#include "baldr/nodecomponents.h"
+#include "baldr/tilereorder.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include <boost/filesystem.hpp>
+
+using namespace std;
+using namespace valhalla::baldr;
+using namespace valhalla::midgard;
+
+namespace {
+
+boost::property_tree::ptree test_config() {
+  std::stringstream json; json << "\
+  {\
+    \"tile_dir\": \"test/tilereorder_tiles\",\
+    \"levels\": [\
+      {\"name\": \"local\", \"level\": 2, \"size\": 0.25},\
+      {\"name\": \"highway\", \"level\": 0, \"size\": 4},\
+      {\"name\": \"arterial\", \"level\": 1, \"size\": 1, \"importance_cutoff\": \"Trunk\"}\
+    ]\
+  }";
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(json, pt);
+  return pt;
+}
+
+// Get the raw bytes of a list of fixed size records
+template <class T>
+std::string to_bytes(const std::vector<T>& records) {
+  return std::string(reinterpret_cast<const char*>(records.data()),
+                     records.size() * sizeof(T));
+}
+
+// A small graph over 2 neighboring tiles. Nodes are listed out of order
+// and each edge is a pair of directed edges with a distinct length.
+struct TestGraph {
+  GraphId west, east;
+  std::vector<std::pair<GraphId, PointLL> > nodes;
+  std::vector<std::pair<size_t, size_t> > edges;
+};
+
+TestGraph make_graph(const TileHierarchy& h) {
+  TestGraph graph;
+  graph.west = h.GetGraphId({-76.2f, 40.1f}, 2);
+  graph.east = h.GetGraphId({-75.9f, 40.1f}, 2);
+  std::vector<PointLL> west = {{-76.01f, 40.24f}, {-76.24f, 40.01f}, {-76.01f, 40.01f},
+                               {-76.24f, 40.24f}, {-76.12f, 40.13f}};
+  std::vector<PointLL> east = {{-75.99f, 40.01f}, {-75.76f, 40.24f}};
+  for (size_t i = 0; i < west.size(); ++i) {
+    graph.nodes.emplace_back(GraphId(graph.west.tileid(), 2, i), west[i]);
+  }
+  for (size_t i = 0; i < east.size(); ++i) {
+    graph.nodes.emplace_back(GraphId(graph.east.tileid(), 2, i), east[i]);
+  }
+  // Node 4 has no edges, edge 2-5 crosses into the east tile
+  graph.edges = {{0, 1}, {1, 2}, {2, 5}, {5, 6}, {3, 0}, {2, 3}};
+  return graph;
+}
+
+// Write the tiles of the graph. The first directed edge of the west tile
+// has a sign and an access restriction, edge cell 0 holds the directed
+// edges of the first edge.
+void write_graph(const TileHierarchy& h, const TestGraph& graph) {
+  // Directed edges of each node, in order: (edge, forward)
+  std::vector<std::vector<std::pair<size_t, bool> > > node_edges(graph.nodes.size());
+  for (size_t i = 0; i < graph.edges.size(); ++i) {
+    node_edges[graph.edges[i].first].emplace_back(i, true);
+    node_edges[graph.edges[i].second].emplace_back(i, false);
+  }
+  auto local_index = [&node_edges](const size_t node, const size_t edge) {
+    for (size_t i = 0; i < node_edges[node].size(); ++i) {
+      if (node_edges[node][i].first == edge)
+        return i;
+    }
+    throw std::runtime_error("Missing opposing edge");
+  };
+
+  for (const auto& tile_id : {graph.west, graph.east}) {
+    std::vector<NodeInfo> nodes;
+    std::vector<DirectedEdge> edges;
+    for (size_t n = 0; n < graph.nodes.size(); ++n) {
+      if (graph.nodes[n].first.Tile_Base() != tile_id)
+        continue;
+      NodeInfo node;
+      node.set_latlng(graph.nodes[n].second);
+      node.set_edge_index(edges.size());
+      node.set_edge_count(node_edges[n].size());
+      nodes.push_back(node);
+      for (const auto& node_edge : node_edges[n]) {
+        const auto& edge = graph.edges[node_edge.first];
+        size_t end = node_edge.second ? edge.second : edge.first;
+        DirectedEdge directededge;
+        directededge.set_endnode(graph.nodes[end].first);
+        directededge.set_length(100 * (node_edge.first + 1) + node_edge.second);
+        directededge.set_opp_index(local_index(end, node_edge.first));
+        directededge.set_leaves_tile(graph.nodes[end].first.Tile_Base() != tile_id);
+        edges.push_back(directededge);
+      }
+    }
+
+    std::vector<Sign> signs;
+    std::vector<AccessRestriction> restrictions;
+    std::vector<GraphId> cells;
+    uint32_t cell_offsets[kCellCount];
+    std::string textlist("Exit 1\0", 7);
+    if (tile_id == graph.west) {
+      signs.emplace_back(0, Sign::Type::kExitNumber, 0);
+      restrictions.emplace_back(0, AccessType::kMaxHeight, kAllAccess, 127, 4);
+      for (size_t i = 0; i < edges.size(); ++i) {
+        if (edges[i].length() / 100 == 1)
+          cells.push_back(GraphId(tile_id.tileid(), 2, i));
+      }
+    }
+    std::fill(cell_offsets, cell_offsets + kCellCount, cells.size());
+
+    GraphTileHeader header;
+    header.set_graphid(tile_id);
+    header.set_nodecount(nodes.size());
+    header.set_directededgecount(edges.size());
+    header.set_signcount(signs.size());
+    header.set_access_restriction_count(restrictions.size());
+    header.set_edge_cell_offsets(cell_offsets);
+    std::string data = to_bytes(nodes) + to_bytes(edges) + to_bytes(restrictions) +
+                       to_bytes(signs) + to_bytes(cells);
+    header.set_edgeinfo_offset(sizeof(GraphTileHeader) + data.size());
+    header.set_textlist_offset(sizeof(GraphTileHeader) + data.size());
+
+    auto fullpath = h.tile_dir() + '/' + GraphTile::FileSuffix(tile_id, h);
+    boost::filesystem::create_directories(boost::filesystem::path(fullpath).parent_path());
+    std::ofstream file(fullpath, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(GraphTileHeader));
+    file.write(data.data(), data.size());
+    file.write(textlist.data(), textlist.size());
+  }
+}
+
+// Read a whole file
+std::string read_file(const std::string& path) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void TestHilbertIndex() {
+  // The 4x4 corner of the grid is the start of the curve, in steps to
+  // neighboring cells
+  std::map<uint32_t, std::pair<int, int> > cells;
+  for (int x = 0; x < 4; ++x) {
+    for (int y = 0; y < 4; ++y) {
+      cells[HilbertIndex(x, y)] = std::make_pair(x, y);
+    }
+  }
+  if (cells.size() != 16 || cells.rbegin()->first != 15)
+    throw std::runtime_error("Expected the corner to be the start of the curve");
+  for (auto cell = std::next(cells.begin()); cell != cells.end(); ++cell) {
+    const auto& previous = std::prev(cell)->second;
+    if (std::abs(cell->second.first - previous.first) + std::abs(cell->second.second - previous.second) != 1)
+      throw std::runtime_error("Expected the curve to step to neighboring cells");
+  }
+  if (HilbertIndex(65535, 0) != 0xFFFFFFFF)
+    throw std::runtime_error("Expected the curve to end at the other corner");
+}
+
+void TestReorderTiles() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+  auto graph = make_graph(h);
+  write_graph(h, graph);
+
+  // The original edges of each node: end node location and length
+  auto node_edges = [&graph]() {
+    std::map<std::pair<float, float>, std::set<std::pair<std::pair<float, float>, uint32_t> > > result;
+    GraphReader reader(test_config());
+    for (const auto& tile_id : {graph.west, graph.east}) {
+      const GraphTile* tile = reader.GetGraphTile(tile_id);
+      for (size_t n = 0; n < tile->header()->nodecount(); ++n) {
+        const NodeInfo* node = tile->node(n);
+        auto& edges = result[std::make_pair(node->latlng().lng(), node->latlng().lat())];
+        for (size_t e = 0; e < node->edge_count(); ++e) {
+          GraphId edgeid(tile_id.tileid(), 2, node->edge_index() + e);
+          const DirectedEdge* edge = tile->directededge(edgeid);
+          const auto& end = reader.GetGraphTile(edge->endnode())->node(edge->endnode())->latlng();
+          edges.emplace(std::make_pair(end.lng(), end.lat()), edge->length());
+
+          // The opposing edge leads back to the node
+          const GraphTile* end_tile = nullptr;
+          const DirectedEdge* opposing = reader.GetOpposingEdge(edgeid, end_tile);
+          if (opposing == nullptr || opposing->endnode() != GraphId(tile_id.tileid(), 2, n))
+            throw std::runtime_error("Opposing edge does not lead back to the node");
+        }
+      }
+    }
+    return result;
+  };
+  auto before = node_edges();
+
+  // A tile that cannot be written leaves every tile as it was
+  auto west_path = h.tile_dir() + '/' + GraphTile::FileSuffix(graph.west, h);
+  auto east_temp = h.tile_dir() + '/' + GraphTile::FileSuffix(graph.east, h) + ".tmp";
+  auto west_bytes = read_file(west_path);
+  boost::filesystem::create_directories(east_temp + "/blocked");
+  try {
+    ReorderTiles(h);
+    throw std::logic_error("Expected the reordering to fail");
+  }
+  catch (const std::runtime_error&) {
+  }
+  boost::filesystem::remove_all(east_temp);
+  if (read_file(west_path) != west_bytes || boost::filesystem::exists(west_path + ".tmp"))
+    throw std::runtime_error("Expected no tile to be replaced");
+
+  // A tile that cannot be replaced puts back the tiles replaced before it
+  auto east_backup = h.tile_dir() + '/' + GraphTile::FileSuffix(graph.east, h) + ".bak";
+  boost::filesystem::create_directories(east_backup + "/blocked");
+  try {
+    ReorderTiles(h);
+    throw std::logic_error("Expected the reordering to fail");
+  }
+  catch (const std::runtime_error&) {
+  }
+  boost::filesystem::remove_all(east_backup);
+  if (read_file(west_path) != west_bytes || boost::filesystem::exists(west_path + ".tmp") ||
+      boost::filesystem::exists(west_path + ".bak") || boost::filesystem::exists(east_temp))
+    throw std::runtime_error("Expected the replaced tile to be restored");
+
+  // Component labels and overlays of the old order are removed
+  for (const auto& file : {NodeComponents::FileName(graph.west, h), CellOverlay::FileName(graph.west, h)}) {
+    std::ofstream(file, std::ios::out | std::ios::binary | std::ios::trunc);
+  }
+  if (ReorderTiles(h) != 2)
+    throw std::runtime_error("Expected 2 tiles to be reordered");
+  if (node_edges() != before)
+    throw std::runtime_error("Reordering should not change the graph");
+  if (boost::filesystem::exists(NodeComponents::FileName(graph.west, h)) ||
+      boost::filesystem::exists(CellOverlay::FileName(graph.west, h)))
+    throw std::runtime_error("Expected the labels and overlays to be removed");
+
+  // The west tile nodes are now in Hilbert order
+  GraphTile west(h, graph.west);
+  std::vector<PointLL> lls;
+  for (size_t n = 0; n < west.header()->nodecount(); ++n) {
+    lls.push_back(west.node(n)->latlng());
+  }
+  if (lls != std::vector<PointLL>{{-76.24f, 40.01f}, {-76.24f, 40.24f}, {-76.12f, 40.13f},
+                                  {-76.01f, 40.24f}, {-76.01f, 40.01f}})
+    throw std::runtime_error("Unexpected node order");
+
+  // The sign, access restriction and edge cells follow their edges
+  uint32_t sign_edge = 0;
+  while (west.directededge(sign_edge)->length() != 101) {
+    ++sign_edge;
+  }
+  if (west.GetSigns(sign_edge).size() != 1 ||
+      west.GetAccessRestrictions(sign_edge, kAllAccess).size() != 1)
+    throw std::runtime_error("Expected the sign and restriction to follow their edge");
+  auto cell = west.GetCell(0, 0);
+  if (cell.size() != 2)
+    throw std::runtime_error("Unexpected edge cell size");
+  for (const auto& edgeid : cell) {
+    if (west.directededge(edgeid)->length() / 100 != 1)
+      throw std::runtime_error("Expected the edge cells to follow their edges");
+  }
+
+  // Reordering again changes nothing
+  auto path = h.tile_dir() + '/' + GraphTile::FileSuffix(graph.west, h);
+  auto bytes = read_file(path);
+  ReorderTiles(h);
+  if (read_file(path) != bytes || boost::filesystem::exists(path + ".tmp") ||
+      boost::filesystem::exists(path + ".bak"))
+    throw std::runtime_error("Expected reordering to be idempotent");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+}
+
+int main() {
+  test::suite suite("tilereorder");
+
+  suite.test(TEST_CASE(TestHilbertIndex));
+
+  suite.test(TEST_CASE(TestReorderTiles));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,84 @@
+#include "tiles.h"
+
+#include <fstream>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <valhalla/midgard/util.h>
+
+using namespace valhalla::baldr;
+using namespace valhalla::midgard;
+
+namespace {
+
+//writes the header and the sections that follow it to the file of the tile
+void write_file(const TileHierarchy& h, const GraphTileHeader& header, const std::string& body) {
+  auto fullpath = h.tile_dir() + '/' + GraphTile::FileSuffix(header.graphid(), h);
+  boost::filesystem::create_directories(boost::filesystem::path(fullpath).parent_path());
+  std::ofstream file(fullpath, std::ios::out | std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(GraphTileHeader));
+  file.write(body.data(), body.size());
+}
+
+template <class T>
+std::string to_bytes(const std::vector<T>& records) {
+  return std::string(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(T));
+}
+
+}
+
+namespace test {
+
+void write_tile(const TileHierarchy& h, const GraphId& tile_id,
+                const std::vector<std::vector<DirectedEdge> >& node_edges) {
+  std::vector<NodeInfo> nodes;
+  std::vector<DirectedEdge> edges;
+  for (const auto& outbound : node_edges) {
+    NodeInfo node;
+    node.set_edge_index(edges.size());
+    node.set_edge_count(outbound.size());
+    nodes.push_back(node);
+    edges.insert(edges.end(), outbound.begin(), outbound.end());
+  }
+  GraphTileHeader header;
+  header.set_graphid(tile_id);
+  header.set_nodecount(nodes.size());
+  header.set_directededgecount(edges.size());
+  uint32_t offset = sizeof(GraphTileHeader) + nodes.size() * sizeof(NodeInfo) +
+                    edges.size() * sizeof(DirectedEdge);
+  header.set_edgeinfo_offset(offset);
+  header.set_textlist_offset(offset);
+  write_file(h, header, to_bytes(nodes) + to_bytes(edges));
+}
+
+void write_shape_tile(const TileHierarchy& h, const GraphId& tile_id,
+                      const std::vector<std::vector<PointLL> >& shapes,
+                      const std::vector<uint32_t>& access) {
+  std::vector<DirectedEdge> edges;
+  std::string edgeinfo;
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    for (bool forward : {true, false}) {
+      DirectedEdge edge;
+      edge.set_edgeinfo_offset(edgeinfo.size());
+      edge.set_forward(forward);
+      edge.set_forwardaccess(access.empty() ? kAllAccess : access[i]);
+      edges.push_back(edge);
+    }
+    std::string encoded = encode(shapes[i]);
+    uint64_t wayid = i;
+    EdgeInfo::PackedItem item{};
+    item.encoded_shape_size = encoded.size();
+    edgeinfo.append(reinterpret_cast<const char*>(&wayid), sizeof(wayid));
+    edgeinfo.append(reinterpret_cast<const char*>(&item), sizeof(item));
+    edgeinfo.append(encoded);
+  }
+
+  GraphTileHeader header;
+  header.set_graphid(tile_id);
+  header.set_directededgecount(edges.size());
+  uint32_t offset = sizeof(GraphTileHeader) + edges.size() * sizeof(DirectedEdge);
+  header.set_edgeinfo_offset(offset);
+  header.set_textlist_offset(offset + edgeinfo.size());
+  write_file(h, header, to_bytes(edges) + edgeinfo);
+}
+
+}
@@ -0,0 +1,26 @@
+#ifndef TEST_TILES_HPP
+#define TEST_TILES_HPP
+
+#include "baldr/graphtile.h"
+#include "baldr/tilehierarchy.h"
+
+#include <cstdint>
+#include <vector>
+#include <valhalla/midgard/pointll.h>
+
+namespace test{
+
+  //writes a tile with the given nodes, each with the given outbound directed edges
+  void write_tile(const valhalla::baldr::TileHierarchy& h, const valhalla::baldr::GraphId& tile_id,
+                  const std::vector<std::vector<valhalla::baldr::DirectedEdge> >& node_edges);
+
+  //writes a tile without nodes with a pair of directed edges (forward then
+  //reverse) per shape. the forward access of each pair is given per shape,
+  //all access if none is given
+  void write_shape_tile(const valhalla::baldr::TileHierarchy& h, const valhalla::baldr::GraphId& tile_id,
+                        const std::vector<std::vector<valhalla::midgard::PointLL> >& shapes,
+                        const std::vector<uint32_t>& access = {});
+
+}
+
+#endif
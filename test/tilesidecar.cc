@@ -0,0 +1,95 @@
+#include "test.h"
+#include "tiles.h"
+
+#include "baldr/tilesidecar.h"
+
+#include <fstream>
+#include <boost/filesystem.hpp>
+
+using namespace std;
+using namespace valhalla::baldr;
+
+namespace {
+
+boost::property_tree::ptree test_config() {
+  std::stringstream json; json << "\
+  {\
+    \"tile_dir\": \"test/tilesidecar_tiles\",\
+    \"levels\": [\
+      {\"name\": \"local\", \"level\": 2, \"size\": 0.25},\
+      {\"name\": \"highway\", \"level\": 0, \"size\": 4},\
+      {\"name\": \"arterial\", \"level\": 1, \"size\": 1, \"importance_cutoff\": \"Trunk\"}\
+    ]\
+  }";
+  boost::property_tree::ptree pt;
+  boost::property_tree::read_json(json, pt);
+  return pt;
+}
+
+// A sidecar holding a value per node
+class test_sidecar : public TileSidecar {
+ public:
+  test_sidecar(const GraphTile& tile)
+      : TileSidecar(tile), values(nodecount_, 7) {
+  }
+  test_sidecar(const std::string& file, const uint32_t version = 1) {
+    std::vector<uint32_t> read_values;
+    if (Read(file, version, [&read_values](std::istream& in, const uint32_t nodecount) {
+          read_values.resize(nodecount);
+          in.read(reinterpret_cast<char*>(read_values.data()), read_values.size() * sizeof(uint32_t));
+        })) {
+      values = std::move(read_values);
+    }
+  }
+  bool Write(const std::string& file) const {
+    return TileSidecar::Write(file, 1, [this](std::ostream& out) {
+      out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(uint32_t));
+    });
+  }
+  std::vector<uint32_t> values;
+};
+
+void TestReadWrite() {
+  TileHierarchy h(test_config());
+  boost::filesystem::remove_all(h.tile_dir());
+  GraphId tile_id = h.GetGraphId({-76.2f, 40.1f}, 2);
+  test::write_tile(h, tile_id, {{}, {}, {}});
+  GraphTile tile(h, tile_id);
+
+  // Round trip, leaving no temporary file behind
+  std::string file = h.tile_dir() + "/sidecar";
+  if (!test_sidecar(tile).Write(file) || boost::filesystem::exists(file + ".tmp"))
+    throw std::runtime_error("Expected the sidecar to be written");
+  test_sidecar read(file);
+  if (read.tile() != tile_id || read.nodecount() != 3 || read.fingerprint() != tile.fingerprint() ||
+      read.values != std::vector<uint32_t>(3, 7) || !read.Matches(tile))
+    throw std::runtime_error("Sidecar does not round trip");
+
+  // Missing files, other versions and truncated files read as no data
+  if (test_sidecar(file + ".missing").tile().Is_Valid() || test_sidecar(file, 2).tile().Is_Valid())
+    throw std::runtime_error("Expected no data for a missing file or another version");
+  boost::filesystem::resize_file(file, boost::filesystem::file_size(file) - 4);
+  test_sidecar truncated(file);
+  if (truncated.tile().Is_Valid() || truncated.nodecount() != 0 || !truncated.values.empty() ||
+      truncated.Matches(tile))
+    throw std::runtime_error("Expected no data for a truncated file");
+
+  // A rebuilt tile with the same node count no longer matches
+  DirectedEdge edge;
+  edge.set_endnode(tile_id);
+  test::write_tile(h, tile_id, {{}, {}, {edge}});
+  if (read.Matches(GraphTile(h, tile_id)))
+    throw std::runtime_error("Expected the sidecar not to match the rebuilt tile");
+
+  boost::filesystem::remove_all(h.tile_dir());
+}
+
+}
+
+int main() {
+  test::suite suite("tilesidecar");
+
+  suite.test(TEST_CASE(TestReadWrite));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,157 @@
+#ifndef VALHALLA_BALDR_CELLOVERLAY_H_
+#define VALHALLA_BALDR_CELLOVERLAY_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/baldr/graphreader.h>
+#include <valhalla/baldr/graphtile.h>
+#include <valhalla/baldr/tilehierarchy.h>
+#include <valhalla/baldr/tilesidecar.h>
+
+namespace valhalla {
+namespace baldr {
+
+// Travel time between boundary nodes that cannot reach each other
+constexpr float kUnreachable = std::numeric_limits<float>::infinity();
+
+/**
+ * Overlay of one tile (a cell): the travel times between its boundary
+ * nodes through the inside of the tile, for one or more travel modes.
+ * Boundary nodes are the nodes with a directed edge to another tile on the
+ * same level; every path through the cell enters and leaves it at one.
+ * Overlays are stored next to their tile (see FileName) and used by
+ * OverlayGraph to cross cells without expanding their edges.
+ */
+class CellOverlay : public TileSidecar {
+ public:
+  /**
+   * Constructor for an empty overlay.
+   */
+  CellOverlay();
+
+  /**
+   * Constructor. Computes the overlay of a tile with a shortest path
+   * search from each boundary node over the edges inside the tile.
+   * Edge times are those of GraphTile::GetEdgeCosts.
+   * @param  tile          Graph tile.
+   * @param  access_modes  Access masks of the travel modes.
+   */
+  CellOverlay(const GraphTile& tile, const std::vector<uint32_t>& access_modes);
+
+  /**
+   * Constructor. Reads an overlay written by Write.
+   * @param  file  Overlay file.
+   */
+  CellOverlay(const std::string& file);
+
+  /**
+   * Write the overlay to a file (see TileSidecar::Write).
+   * @param  file  Overlay file.
+   * @return  Returns true if the file was written.
+   */
+  bool Write(const std::string& file) const;
+
+  /**
+   * Gets the overlay file name of a tile: the tile file name with an
+   * .ovl extension.
+   * @param  graphid    Tile (base) Id.
+   * @param  hierarchy  Tile hierarchy.
+   * @return  Returns the path of the overlay file.
+   */
+  static std::string FileName(const GraphId& graphid, const TileHierarchy& hierarchy);
+
+  /**
+   * Get the boundary nodes.
+   * @return  Returns the indexes of the boundary nodes within the tile,
+   *          in increasing order.
+   */
+  const std::vector<uint32_t>& boundary_nodes() const;
+
+  /**
+   * Get the position of a node among the boundary nodes.
+   * @param  node_index  Index of the node within the tile.
+   * @return  Returns the position or -1 if it is not a boundary node.
+   */
+  int32_t boundary_index(const uint32_t node_index) const;
+
+  /**
+   * Get the travel times between the boundary nodes for a travel mode.
+   * @param  access  Access mask of the travel mode.
+   * @return  Returns a row major matrix of times in seconds from each
+   *          boundary node (row) to each boundary node (column), or
+   *          nullptr if the overlay was not computed for the mode.
+   */
+  const float* times(const uint32_t access) const;
+
+ protected:
+  std::vector<uint32_t> boundary_nodes_;
+
+  // Boundary node times by access mask
+  std::unordered_map<uint32_t, std::vector<float> > times_;
+};
+
+/**
+ * Computes the overlays of all tiles of a level in parallel and writes
+ * them next to the tiles.
+ * @param  hierarchy     Tile hierarchy.
+ * @param  level         Hierarchy level.
+ * @param  access_modes  Access masks of the travel modes.
+ * @param  threads       Number of threads, 0 for the hardware concurrency.
+ * @return  Returns the number of overlays written.
+ */
+size_t BuildOverlays(const TileHierarchy& hierarchy, const uint8_t level,
+                     const std::vector<uint32_t>& access_modes, size_t threads = 0);
+
+/**
+ * Shortest travel times over the overlay of a level for one travel mode.
+ * The cells of the origin and destination are expanded edge by edge. Any
+ * other cell is crossed in one step from the boundary node where the path
+ * enters it to each of its boundary nodes. Cells without a matching
+ * overlay file are expanded edge by edge. Like GraphReader it is NOT
+ * thread-safe, it caches the overlays it reads.
+ */
+class OverlayGraph {
+ public:
+  /**
+   * Constructor
+   * @param  hierarchy  Tile hierarchy.
+   * @param  access     Access mask of the travel mode.
+   */
+  OverlayGraph(const TileHierarchy& hierarchy, const uint32_t access);
+
+  /**
+   * Get the shortest travel time between 2 nodes on the same level.
+   * @param  reader       Graph reader used to get the tiles.
+   * @param  origin       Origin node.
+   * @param  destination  Destination node.
+   * @return  Returns the time in seconds, kUnreachable if there is no path.
+   */
+  float TravelTime(GraphReader& reader, const GraphId& origin,
+                   const GraphId& destination);
+
+ protected:
+  /**
+   * Get the overlay of a tile if there is one that matches the tile.
+   * @param  tile  Graph tile.
+   * @return  Returns the overlay or nullptr.
+   */
+  const CellOverlay* GetOverlay(const GraphTile& tile);
+
+  const TileHierarchy hierarchy_;
+  uint32_t access_;
+
+  // Overlays read so far by tile, nullptr if the tile has none
+  std::unordered_map<GraphId, std::unique_ptr<CellOverlay> > overlays_;
+};
+
+}
+}
+
+#endif  // VALHALLA_BALDR_CELLOVERLAY_H_
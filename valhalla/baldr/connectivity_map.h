@@ -6,17 +6,73 @@
 #include <vector>
 #include <unordered_map>
 #include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
 
 namespace valhalla {
   namespace baldr {
+    /**
+     * The colors of the tiles of a level (see connectivity_map_t::to_image),
+     * palette and run length encoded so its size follows the number of
+     * tiles and colors rather than the size of the grid
+     */
+    struct connectivity_image_t {
+      uint32_t columns;
+      uint32_t rows;
+      //the distinct colors, 0 (no tile) first
+      std::vector<uint32_t> palette;
+      //runs of cells of one color as the palette index and the run length,
+      //they cover the whole grid a row at a time starting at cell 0 (tile id 0).
+      //cells without a tile are runs of index 0, so unless tile 0 exists the
+      //first run is the empty cells before the first tile
+      std::vector<std::pair<uint32_t, uint32_t> > runs;
+
+      /**
+       * Returns the vector of colors, one per tile, as to_image does
+       *
+       * @return vector  the vector of colors per tile
+       */
+      std::vector<size_t> decode() const;
+    };
+
     //TODO: maintain consistent coloring of regions despite the connectivity changing
+    /**
+     * Colors the tiles of each level so that neighboring tiles have the same
+     * color. The colors are stored in a binary file next to the tiles (see
+     * file_name) which is mapped into memory rather than read.
+     */
     class connectivity_map_t {
      public:
       /**
-       * Constructus the connectivity map
+       * Constructs the connectivity map. Maps the connectivity file if there
+       * is a valid one, without looking at the tiles, otherwise lists the
+       * tiles on disk and builds the map from them in memory. The file is
+       * trusted to match the tiles and is never written here, see build
        *
+       * @param tile_hierarchy  the tile hierarchy
+       * @param threads         threads to build with, 0 for the hardware concurrency
        */
-      connectivity_map_t(const TileHierarchy& tile_hierarchy);
+      connectivity_map_t(const TileHierarchy& tile_hierarchy, size_t threads = 0);
+
+      /**
+       * Builds the connectivity map from the tiles on disk and saves it to the
+       * connectivity file. Run it whenever the tiles change, until then maps
+       * are made from the file and keep the colors of the old tiles
+       *
+       * @param tile_hierarchy  the tile hierarchy
+       * @param threads         threads to build with, 0 for the hardware concurrency
+       * @return size_t         the number of tiles in the map
+       */
+      static size_t build(const TileHierarchy& tile_hierarchy, size_t threads = 0);
+
+      /**
+       * Returns the path of the connectivity file of a tile hierarchy
+       *
+       * @param tile_hierarchy  the tile hierarchy
+       * @return string         the path
+       */
+      static std::string file_name(const TileHierarchy& tile_hierarchy);
 
       /**
        * Returns the color for the given graphid
@@ -34,6 +90,15 @@ namespace valhalla {
        */
       std::string to_geojson(const uint32_t hierarchy_level) const;
 
+      /**
+       * Writes the geojson representing the connectivity map as it goes. Only
+       * the tiles that exist are visited, the biggest regions come first
+       *
+       * @param out             the stream to write to
+       * @param hierarchy_level the hierarchy level whos connectivity you want to see
+       */
+      void to_geojson(std::ostream& out, const uint32_t hierarchy_level) const;
+
       /**
        * Returns the vector of colors (one per tile) representing the connectivity map
        *
@@ -42,8 +107,27 @@ namespace valhalla {
        */
       std::vector<size_t> to_image(const uint32_t hierarchy_level) const;
 
+      /**
+       * Returns the colors of the tiles as a palette and run length encoded
+       * image. Only the tiles that exist are visited
+       *
+       * @param hierarchy_level the hierarchy level whos connectivity you want to see
+       * @return image          the encoded image
+       */
+      connectivity_image_t to_encoded_image(const uint32_t hierarchy_level) const;
+
      private:
-      std::unordered_map<uint32_t, std::unordered_map<uint32_t, size_t> > colors;
+      //sets the levels from the bytes of a connectivity file, false if they are not valid
+      bool set_data(const std::shared_ptr<const char>& bytes, const size_t size);
+
+      //the tile ids of a level in increasing order and the color of each
+      struct level_colors_t {
+        const uint32_t* tiles;
+        const uint32_t* colors;
+        size_t count;
+      };
+      std::unordered_map<uint32_t, level_colors_t> colors;
+      std::shared_ptr<const char> data;
       TileHierarchy tile_hierarchy;
     };
   }
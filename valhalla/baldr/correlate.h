@@ -0,0 +1,79 @@
+#ifndef VALHALLA_BALDR_CORRELATE_H_
+#define VALHALLA_BALDR_CORRELATE_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <valhalla/baldr/edgesearch.h>
+#include <valhalla/baldr/graphconstants.h>
+#include <valhalla/baldr/graphreader.h>
+#include <valhalla/baldr/location.h>
+#include <valhalla/baldr/pathlocation.h>
+
+namespace valhalla {
+namespace baldr {
+
+// Maximum number of directed edges a location is correlated to (a
+// location at an intersection is correlated to all edges meeting there)
+constexpr size_t kMaxCorrelatedEdges = 32;
+
+// Edges within this distance (meters) of the nearest edge are correlated
+// along with it
+constexpr float kCorrelationTolerance = 0.5f;
+
+/**
+ * Correlate a location to the graph. The location is correlated to the
+ * nearest directed edge (see FindNearestEdges) and to every other edge that
+ * is as near, within kCorrelationTolerance (the other direction of the
+ * edge and, at an intersection, the other edges meeting there). The
+ * correlated vertex is the closest point on the nearest edge.
+ * @param  reader    Graph reader used to get the tiles.
+ * @param  location  Location to correlate.
+ * @param  radius    Maximum distance (meters) to search for edges.
+ * @param  access    Access mask (see graphconstants.h).
+ * @return  Returns the path location. It has no edges and is not
+ *          correlated (see PathLocation::IsCorrelated) if there are no
+ *          edges within the radius.
+ */
+PathLocation Correlate(GraphReader& reader, const Location& location,
+                       const float radius, const uint32_t access = kAllAccess);
+
+/**
+ * Correlate a location to the graph (see above), reusing the edge shapes
+ * the searcher decoded for nearby locations.
+ * @param  searcher  Edge searcher used to find the nearest edges.
+ * @param  location  Location to correlate.
+ * @param  radius    Maximum distance (meters) to search for edges.
+ * @param  access    Access mask (see graphconstants.h).
+ * @return  Returns the path location.
+ */
+PathLocation Correlate(EdgeSearcher& searcher, const Location& location,
+                       const float radius, const uint32_t access = kAllAccess);
+
+/**
+ * Correlate many locations to the graph. The locations are sorted by the
+ * tile they are in and split into contiguous slices, one per thread. The
+ * tiles of the locations are read once and shared by the GraphReader of
+ * each thread, and the edge shapes decoded for a run of locations in the
+ * same tile are reused within the run. The results are identical to
+ * calling Correlate for each location.
+ * @param  config     Configuration used to create the graph readers.
+ * @param  locations  Locations to correlate.
+ * @param  radius     Maximum distance (meters) to search for edges.
+ * @param  access     Access mask (see graphconstants.h).
+ * @param  threads    Number of threads to use. 0 uses the number of
+ *                    hardware threads.
+ * @return  Returns a path location for each location, in the same order.
+ */
+std::vector<PathLocation> CorrelateLocations(
+    const boost::property_tree::ptree& config,
+    const std::vector<Location>& locations, const float radius,
+    const uint32_t access = kAllAccess, size_t threads = 0);
+
+}
+}
+
+#endif  // VALHALLA_BALDR_CORRELATE_H_
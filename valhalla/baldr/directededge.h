@@ -9,6 +9,89 @@
 namespace valhalla {
 namespace baldr {
 
+/**
+ * Bit fields of a directed edge, in storage order. The members of
+ * DirectedEdge and the field table of recordfields.h are both generated
+ * from these lists, so the table cannot drift from the layout. Entries are
+ * FIELD(field, type, member, width) for the fields that can be extracted in
+ * bulk (field names the DirectedEdgeField) and OTHER(type, member, width)
+ * for the rest.
+ */
+
+// Words 1 - 4, after the end node
+#define VALHALLA_DIRECTEDEDGE_WORDS(FIELD, OTHER) \
+  /* Data offsets and flags for extended data. Where a flag exists the */ \
+  /* actual data can be indexed by the directed edge Id within the tile. */ \
+  FIELD(kEdgeInfoOffset, uint64_t, edgeinfo_offset_, 25) /* Offset to edge data */ \
+  FIELD(kAccessRestriction, uint64_t, access_restriction_, 12) /* General restriction or access condition (per mode) */ \
+  OTHER(uint64_t, start_complex_restriction_, 12) /* Complex restriction (per mode) starts on this directed edge */ \
+  OTHER(uint64_t, end_complex_restriction_, 12) /* Complex restriction (per mode) ends on this directed edge */ \
+  FIELD(kExitSign, uint64_t, exitsign_, 1) /* Exit signs exist for this edge */ \
+  OTHER(uint64_t, spare1_, 2) \
+  \
+  /* Attributes. Can be used in edge costing methods to favor or avoid */ \
+  /* edges. Speed values above 250 used for special cases (closures, */ \
+  /* construction) */ \
+  FIELD(kSpeed, uint64_t, speed_, 8) /* Speed (kph) */ \
+  FIELD(kTruckSpeed, uint64_t, truck_speed_, 8) /* Truck speed (kph) */ \
+  FIELD(kRestrictions, uint64_t, restrictions_, 8) /* Restrictions - mask of local edge indexes at the end node that are restricted. */ \
+  FIELD(kLaneCount, uint64_t, lanecount_, 4) /* Number of lanes */ \
+  FIELD(kBikeNetwork, uint64_t, bike_network_, 4) /* Edge that is part of a bicycle network */ \
+  FIELD(kUse, uint64_t, use_, 6) /* Specific use types */ \
+  FIELD(kSpeedType, uint64_t, speed_type_, 2) /* Speed type (tagged vs. categorized) */ \
+  FIELD(kOppIndex, uint64_t, opp_index_, 7) /* Opposing directed edge index */ \
+  FIELD(kDriveOnRight, uint64_t, drive_on_right_, 1) /* Driving side. Right if true (false=left) */ \
+  OTHER(uint64_t, spare2_, 1) \
+  OTHER(uint64_t, spare3_, 1) \
+  FIELD(kToll, uint64_t, toll_, 1) /* Edge is part of a toll road. */ \
+  FIELD(kSeasonal, uint64_t, seasonal_, 1) /* Seasonal access (ex. no access in winter) */ \
+  FIELD(kDestOnly, uint64_t, dest_only_, 1) /* Access allowed to destination only (private or no through traffic) */ \
+  FIELD(kTunnel, uint64_t, tunnel_, 1) /* Is this edge part of a tunnel */ \
+  FIELD(kBridge, uint64_t, bridge_, 1) /* Is this edge part of a bridge? */ \
+  FIELD(kRoundabout, uint64_t, roundabout_, 1) /* Edge is part of a roundabout */ \
+  FIELD(kUnreachable, uint64_t, unreachable_, 1) /* Edge that is unreachable by driving */ \
+  FIELD(kTrafficSignal, uint64_t, traffic_signal_, 1) /* Traffic signal at end of the directed edge */ \
+  FIELD(kForward, uint64_t, forward_, 1) /* Is the edge info forward or reverse */ \
+  FIELD(kNotThru, uint64_t, not_thru_, 1) /* Edge leads to "no-through" region */ \
+  FIELD(kCycleLane, uint64_t, cycle_lane_, 2) /* Does this edge have bicycle lanes? */ \
+  FIELD(kTruckRoute, uint64_t, truck_route_, 1) /* Edge that is part of a truck route/network */ \
+  FIELD(kCtryCrossing, uint64_t, ctry_crossing_, 1) /* Does the edge cross into new country */ \
+  \
+  /* Legal access to the directed link (also include reverse direction */ \
+  /* access). See graphconstants.h. */ \
+  FIELD(kForwardAccess, uint64_t, forwardaccess_, 12) \
+  FIELD(kReverseAccess, uint64_t, reverseaccess_, 12) \
+  FIELD(kClassification, uint64_t, classification_, 3) /* Classification/importance of the road/path */ \
+  FIELD(kSurface, uint64_t, surface_, 3) /* representation of smoothness */ \
+  FIELD(kLink, uint64_t, link_, 1) /* *link tag - Ramp or turn channel */ \
+  FIELD(kInternal, uint64_t, internal_, 1) /* Edge that is internal to an intersection */ \
+  OTHER(uint64_t, spare1, 32) \
+  \
+  /* Geometric attributes: length, weighted grade, curvature factor. */ \
+  /* Turn types between edges. */ \
+  FIELD(kTurnType, uint64_t, turntype_, 24) /* Turn type (see graphconstants.h) */ \
+  FIELD(kEdgeToLeft, uint64_t, edge_to_left_, 8) /* Is there an edge to the left (between the "from edge" and this edge) */ \
+  FIELD(kLength, uint64_t, length_, 24) /* Length in meters */ \
+  FIELD(kWeightedGrade, uint64_t, weighted_grade_, 4) /* Weighted estimate of grade */ \
+  FIELD(kCurvature, uint64_t, curvature_, 4) /* Curvature factor */
+
+// Stop impact among edges, the low half of word 5 unless the edge is a
+// transit line (see StopOrLine)
+#define VALHALLA_DIRECTEDEDGE_STOPIMPACT(FIELD, OTHER) \
+  FIELD(kStopImpact, uint32_t, stopimpact, 24) /* Stop impact between edges */ \
+  FIELD(kEdgeToRight, uint32_t, edge_to_right, 8) /* Is there an edge to the right (between "from edge" and this edge) */
+
+// Hierarchy transitions and shortcut information, the high half of word 5
+#define VALHALLA_DIRECTEDEDGE_TRANSITIONS(FIELD, OTHER) \
+  FIELD(kLocalEdgeIdx, uint32_t, localedgeidx_, 7) /* Index of the edge on the local level */ \
+  FIELD(kOppLocalIdx, uint32_t, opp_local_idx_, 7) /* Opposing local edge index (for costing and Uturn detection) */ \
+  FIELD(kShortcut, uint32_t, shortcut_, 7) /* Shortcut edge (mask) */ \
+  FIELD(kSuperseded, uint32_t, superseded_, 7) /* Edge is superseded by a shortcut (mask) */ \
+  FIELD(kTransUp, uint32_t, trans_up_, 1) /* Edge represents a transition up one level in the hierarchy */ \
+  FIELD(kTransDown, uint32_t, trans_down_, 1) /* Transition down one level */ \
+  FIELD(kIsShortcut, uint32_t, is_shortcut_, 1) /* True if this edge is a shortcut. */ \
+  FIELD(kLeavesTile, uint32_t, leaves_tile_, 1) /* True if the end node of this directed edge is in a different tile. */
+
 /**
  * Directed edge within the graph.
  */
@@ -717,71 +800,14 @@ class DirectedEdge {
   // End node
   GraphId endnode_;
 
-  // Data offsets and flags for extended data. Where a flag exists the actual
-  // data can be indexed by the directed edge Id within the tile.
-  uint64_t edgeinfo_offset_           : 25; // Offset to edge data.
-  uint64_t access_restriction_        : 12; // General restriction or access
-                                            // condition (per mode)
-  uint64_t start_complex_restriction_ : 12; // Complex restriction (per mode)
-                                            // starts on this directed edge
-  uint64_t end_complex_restriction_   : 12; // Complex restriction (per mode)
-                                            // ends on this directed edge
-  uint64_t exitsign_                  : 1;  // Exit signs exist for this edge
-  uint64_t spare1_                    : 2;
-
-  // Attributes. Can be used in edge costing methods to favor or avoid edges.
-  // Speed values above 250 used for special cases (closures, construction)
-  uint64_t speed_          : 8; // Speed (kph)
-  uint64_t truck_speed_    : 8; // Truck speed (kph)
-  uint64_t restrictions_   : 8; // Restrictions - mask of local edge indexes
-                                // at the end node that are restricted.
-  uint64_t lanecount_      : 4; // Number of lanes
-  uint64_t bike_network_   : 4; // Edge that is part of a bicycle network
-  uint64_t use_            : 6; // Specific use types
-  uint64_t speed_type_     : 2; // Speed type (tagged vs. categorized)
-  uint64_t opp_index_      : 7; // Opposing directed edge index
-  uint64_t drive_on_right_ : 1; // Driving side. Right if true (false=left)
-  uint64_t spare2_         : 1;
-  uint64_t spare3_         : 1;
-  uint64_t toll_           : 1; // Edge is part of a toll road.
-  uint64_t seasonal_       : 1; // Seasonal access (ex. no access in winter)
-  uint64_t dest_only_      : 1; // Access allowed to destination only
-                                //  (private or no through traffic)
-  uint64_t tunnel_         : 1; // Is this edge part of a tunnel
-  uint64_t bridge_         : 1; // Is this edge part of a bridge?
-  uint64_t roundabout_     : 1; // Edge is part of a roundabout
-  uint64_t unreachable_    : 1; // Edge that is unreachable by driving
-  uint64_t traffic_signal_ : 1; // Traffic signal at end of the directed edge
-  uint64_t forward_        : 1; // Is the edge info forward or reverse
-  uint64_t not_thru_       : 1; // Edge leads to "no-through" region
-  uint64_t cycle_lane_     : 2; // Does this edge have bicycle lanes?
-  uint64_t truck_route_    : 1; // Edge that is part of a truck route/network
-  uint64_t ctry_crossing_  : 1; // Does the edge cross into new country
-
-  // Legal access to the directed link (also include reverse direction access).
-  // See graphconstants.h.
-  uint64_t forwardaccess_  : 12;
-  uint64_t reverseaccess_  : 12;
-  uint64_t classification_ : 3;  // Classification/importance of the road/path
-  uint64_t surface_        : 3;  // representation of smoothness
-  uint64_t link_           : 1;  // *link tag - Ramp or turn channel
-  uint64_t internal_       : 1;  // Edge that is internal to an intersection
-  uint64_t spare1          : 32;
-
-  // Geometric attributes: length, weighted grade, curvature factor.
-  // Turn types between edges.
-  uint64_t turntype_        : 24;   // Turn type (see graphconstants.h)
-  uint64_t edge_to_left_    :  8;   // Is there an edge to the left (between
-                                    // the "from edge" and this edge)
-  uint64_t length_          : 24;   // Length in meters
-  uint64_t weighted_grade_  :  4;   // Weighted estimate of grade
-  uint64_t curvature_       :  4;   // Curvature factor
+  // Bit fields generated from the lists above
+#define VALHALLA_DECLARE_FIELD(field, type, member, width) type member : width;
+#define VALHALLA_DECLARE_OTHER(type, member, width) type member : width;
+  VALHALLA_DIRECTEDEDGE_WORDS(VALHALLA_DECLARE_FIELD, VALHALLA_DECLARE_OTHER)
 
   // Stop impact among edges
   struct StopImpact {
-    uint32_t stopimpact      : 24; // Stop impact between edges
-    uint32_t edge_to_right   :  8; // Is there an edge to the right (between
-                                   // "from edge" and this edge)
+    VALHALLA_DIRECTEDEDGE_STOPIMPACT(VALHALLA_DECLARE_FIELD, VALHALLA_DECLARE_OTHER)
   };
 
   // Store either the stop impact or the transit line identifier. Since
@@ -793,18 +819,13 @@ class DirectedEdge {
   };
   StopOrLine stopimpact_;
 
-  // Hierarchy transitions and shortcut information
-  uint32_t localedgeidx_  : 7;  // Index of the edge on the local level
-  uint32_t opp_local_idx_ : 7;  // Opposing local edge index (for costing
-                                // and Uturn detection)
-  uint32_t shortcut_      : 7;  // Shortcut edge (mask)
-  uint32_t superseded_    : 7;  // Edge is superseded by a shortcut (mask)
-  uint32_t trans_up_      : 1;  // Edge represents a transition up one
-                                // level in the hierarchy
-  uint32_t trans_down_    : 1;  // Transition down one level
-  uint32_t is_shortcut_   : 1;  // True if this edge is a shortcut.
-  uint32_t leaves_tile_   : 1;  // True if the end node of this directed edge
-                                // is in a different tile.
+  VALHALLA_DIRECTEDEDGE_TRANSITIONS(VALHALLA_DECLARE_FIELD, VALHALLA_DECLARE_OTHER)
+#undef VALHALLA_DECLARE_FIELD
+#undef VALHALLA_DECLARE_OTHER
+
+  // The members recordfields.h places by hand rather than from the lists
+  static_assert(sizeof(GraphId) == 8, "The end node must be the first word");
+  static_assert(sizeof(StopOrLine) == 4, "The line id must overlay the stop impact");
 };
 
 }
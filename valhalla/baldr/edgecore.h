@@ -0,0 +1,122 @@
+#ifndef VALHALLA_BALDR_EDGECORE_H_
+#define VALHALLA_BALDR_EDGECORE_H_
+
+#include <cstdint>
+
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/baldr/graphconstants.h>
+#include <valhalla/baldr/directededge.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * The attributes of a directed edge read while expanding a path (the
+ * "routing core"), packed into 16 bytes instead of the 48 bytes of a
+ * DirectedEdge. Four fit in a cache line, so a path expansion that only
+ * needs these fields touches a third of the memory. Built from the directed
+ * edges of a tile (see GraphTile::GetEdgeCores) and indexed the same way.
+ * Accessors are defined here so they inline into the expansion loop.
+ */
+class EdgeCore {
+ public:
+  /**
+   * Constructor
+   * @param  edge  Directed edge to copy the routing attributes from.
+   */
+  EdgeCore(const DirectedEdge& edge);
+
+  /**
+   * Gets the end node of this directed edge.
+   * @return  Returns the end node.
+   */
+  GraphId endnode() const {
+    return GraphId(endnode_);
+  }
+
+  /**
+   * Gets the length of the edge in meters.
+   * @return  Returns the length in meters.
+   */
+  uint32_t length() const {
+    return length_;
+  }
+
+  /**
+   * Gets the speed in KPH.
+   * @return  Returns the speed in KPH.
+   */
+  uint32_t speed() const {
+    return speed_;
+  }
+
+  /**
+   * Get the access modes in the forward direction (bit field).
+   * @return  Returns the access modes (see graphconstants.h).
+   */
+  uint32_t forwardaccess() const {
+    return forwardaccess_;
+  }
+
+  /**
+   * Gets the index of the opposing directed edge at the end node of this
+   * directed edge.
+   * @return  Returns the index of the opposing directed edge.
+   */
+  uint32_t opp_index() const {
+    return opp_index_;
+  }
+
+  /**
+   * Gets the specialized use of the edge.
+   * @return  Returns the use.
+   */
+  Use use() const {
+    return static_cast<Use>(use_);
+  }
+
+  // Flags, see the accessors of the same name in DirectedEdge
+  bool trans_up() const {
+    return trans_up_;
+  }
+  bool trans_down() const {
+    return trans_down_;
+  }
+  bool is_shortcut() const {
+    return is_shortcut_;
+  }
+  bool leaves_tile() const {
+    return leaves_tile_;
+  }
+  bool not_thru() const {
+    return not_thru_;
+  }
+  bool destonly() const {
+    return dest_only_;
+  }
+  bool unreachable() const {
+    return unreachable_;
+  }
+
+ protected:
+  // End node (GraphId value)
+  uint64_t endnode_;
+
+  uint64_t length_        : 24; // Length in meters
+  uint64_t speed_         : 8;  // Speed (kph)
+  uint64_t forwardaccess_ : 12; // Access in the forward direction
+  uint64_t opp_index_     : 7;  // Opposing directed edge index
+  uint64_t use_           : 6;  // Specific use types
+  uint64_t trans_up_      : 1;  // Transition up one level
+  uint64_t trans_down_    : 1;  // Transition down one level
+  uint64_t is_shortcut_   : 1;  // Shortcut edge
+  uint64_t leaves_tile_   : 1;  // End node is in a different tile
+  uint64_t not_thru_      : 1;  // Edge leads to "no-through" region
+  uint64_t dest_only_     : 1;  // Access allowed to destination only
+  uint64_t unreachable_   : 1;  // Edge that is unreachable by driving
+};
+
+}
+}
+
+#endif  // VALHALLA_BALDR_EDGECORE_H_
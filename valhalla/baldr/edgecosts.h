@@ -0,0 +1,85 @@
+#ifndef VALHALLA_BALDR_EDGECOSTS_H_
+#define VALHALLA_BALDR_EDGECOSTS_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include <valhalla/baldr/directededge.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * Travel time and accessibility of every directed edge of a tile for one
+ * travel mode, computed up front so a path expansion reads them from dense
+ * arrays instead of extracting and dividing bit fields on every relaxation.
+ * See GraphTile::GetEdgeCosts, which caches them with the tile.
+ */
+class EdgeCosts {
+ public:
+  /**
+   * Constructor. Computes the costs of the given directed edges. An edge is
+   * accessible if it allows one of the access modes in its forward direction
+   * and has a speed. The time is the length divided by the speed, using the
+   * truck speed (where there is one) if the mode is kTruckAccess.
+   * @param  edges   Directed edges.
+   * @param  count   Number of directed edges.
+   * @param  access  Access mask of the travel mode (see graphconstants.h).
+   */
+  EdgeCosts(const DirectedEdge* edges, const size_t count,
+            const uint32_t access);
+
+  /**
+   * Get the access mask the costs were computed for.
+   * @return  Returns the access mask.
+   */
+  uint32_t access() const;
+
+  /**
+   * Get the number of directed edges.
+   * @return  Returns the number of directed edges.
+   */
+  size_t size() const;
+
+  /**
+   * Get the travel time along a directed edge.
+   * @param  idx  Index of the directed edge within the tile.
+   * @return  Returns the time in seconds (0 if not accessible).
+   */
+  float seconds(const size_t idx) const {
+    return seconds_[idx];
+  }
+
+  /**
+   * Can the travel mode use a directed edge.
+   * @param  idx  Index of the directed edge within the tile.
+   * @return  Returns true if the edge is accessible.
+   */
+  bool accessible(const size_t idx) const {
+    return accessible_[idx] != 0;
+  }
+
+  /**
+   * Get the travel times of all the directed edges.
+   * @return  Returns the times in seconds, indexed like the directed edges.
+   */
+  const std::vector<float>& seconds() const;
+
+  /**
+   * Get the accessibility flags of all the directed edges.
+   * @return  Returns 1 for accessible edges and 0 for others, indexed like
+   *          the directed edges.
+   */
+  const std::vector<uint8_t>& accessible() const;
+
+ protected:
+  uint32_t access_;
+  std::vector<float> seconds_;
+  std::vector<uint8_t> accessible_;
+};
+
+}
+}
+
+#endif  // VALHALLA_BALDR_EDGECOSTS_H_
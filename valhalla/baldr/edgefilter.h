@@ -0,0 +1,153 @@
+#ifndef VALHALLA_BALDR_EDGEFILTER_H_
+#define VALHALLA_BALDR_EDGEFILTER_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include <valhalla/baldr/graphconstants.h>
+#include <valhalla/baldr/directededge.h>
+#include <valhalla/baldr/graphtile.h>
+#include <valhalla/baldr/recordfields.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * Filters directed edges down to those a travel mode can traverse in a
+ * search direction, producing a bit mask rather than testing edges one at a
+ * time. An edge is traversable if:
+ *   - it allows one of the kAccess modes in the search direction (forward
+ *     access for forward searches, reverse access for reverse searches),
+ *   - it is not a shortcut,
+ *   - it is not a transit line (see DirectedEdge::IsTransitLine), and
+ *   - it is not marked unreachable, if the mode is a driving mode (does not
+ *     include pedestrian or bicycle access).
+ * The mode and direction are template parameters so each filter compiles
+ * to a branch free loop with the fields and masks as constants. The loop
+ * reads the packed edge words directly (see recordfields.h). With SSE2 it
+ * tests 4 edges at a time, one per 32 bit lane, and movemask gives their
+ * bits of the mask.
+ */
+template <uint32_t kAccess, bool kForward = true>
+class EdgeFilter {
+ public:
+  /**
+   * Is a directed edge traversable (one edge at a time, the reference the
+   * bulk filters match).
+   * @param  edge  Directed edge.
+   * @return  Returns true if the edge is traversable.
+   */
+  static bool Allowed(const DirectedEdge& edge) {
+    uint32_t access = kForward ? edge.forwardaccess() : edge.reverseaccess();
+    return (access & kAccess) && !edge.is_shortcut() && !edge.IsTransitLine() &&
+           !(kDriving && edge.unreachable());
+  }
+
+  /**
+   * Filter consecutive directed edges.
+   * @param  edges  First directed edge.
+   * @param  count  Number of directed edges.
+   * @param  mask   (OUT) Bit i of word i / 64 is set if edge i is
+   *                traversable. Resized to (count + 63) / 64 words.
+   */
+  static void Filter(const DirectedEdge* edges, const size_t count,
+                     std::vector<uint64_t>& mask) {
+    static_assert(InHalfWord(kAccessField) && InHalfWord(kUseField) &&
+                  InHalfWord(kUnreachableField) && InHalfWord(kShortcutField),
+                  "Edge filter fields must fit 32 bit lanes");
+    mask.assign((count + 63) / 64, 0);
+    const uint64_t* words = reinterpret_cast<const uint64_t*>(edges);
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i modes = _mm_set1_epi32(static_cast<int>(kAccess));
+    const __m128i rail = _mm_set1_epi32(static_cast<int>(Use::kRail));
+    const __m128i bus = _mm_set1_epi32(static_cast<int>(Use::kBus));
+    for (; i + 4 <= count; i += 4) {
+      const uint64_t* w = words + i * kWords;
+      __m128i type = LoadField4<kWords>(w, kUseField);
+      __m128i excluded = LoadField4<kWords>(w, kShortcutField);
+      if (kDriving) {
+        excluded = _mm_or_si128(excluded, LoadField4<kWords>(w, kUnreachableField));
+      }
+      __m128i blocked = _mm_or_si128(
+          _mm_cmpeq_epi32(_mm_and_si128(LoadField4<kWords>(w, kAccessField), modes), zero),
+          _mm_or_si128(_mm_cmpeq_epi32(type, rail), _mm_cmpeq_epi32(type, bus)));
+      __m128i ok = _mm_andnot_si128(blocked, _mm_cmpeq_epi32(excluded, zero));
+      uint64_t bits = static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(ok)));
+      mask[i / 64] |= bits << (i % 64);
+    }
+#endif
+    // Scalar fallback and tail
+    for (; i < count; ++i) {
+      mask[i / 64] |= Traversable(words + i * kWords) << (i % 64);
+    }
+  }
+
+  /**
+   * Filter the outbound directed edges of a node.
+   * @param  tile        Tile of the node.
+   * @param  node_index  Node Id within the tile.
+   * @param  mask        (OUT) Bit i is set if the node's i-th outbound edge
+   *                     is traversable (see Filter).
+   */
+  static void FilterNode(const GraphTile& tile, const uint32_t node_index,
+                         std::vector<uint64_t>& mask) {
+    uint32_t count, edge_index;
+    const DirectedEdge* edges = tile.GetDirectedEdges(node_index, count, edge_index);
+    Filter(edges, count, mask);
+  }
+
+  /**
+   * Filter all directed edges of a tile.
+   * @param  tile  Tile.
+   * @param  mask  (OUT) Bit i is set if directed edge i of the tile is
+   *               traversable (see Filter).
+   */
+  static void FilterTile(const GraphTile& tile, std::vector<uint64_t>& mask) {
+    size_t count = tile.header()->directededgecount();
+    Filter(count ? tile.directededge(size_t(0)) : nullptr, count, mask);
+  }
+
+ protected:
+  // Unreachable edges are only excluded for driving modes
+  static constexpr bool kDriving =
+      (kAccess & (kPedestrianAccess | kBicycleAccess)) == 0;
+
+  // Words of a directed edge and the fields the filter reads
+  static constexpr size_t kWords = sizeof(DirectedEdge) / sizeof(uint64_t);
+  static constexpr BitField kAccessField = GetBitField(kForward ?
+      DirectedEdgeField::kForwardAccess : DirectedEdgeField::kReverseAccess);
+  static constexpr BitField kUseField = GetBitField(DirectedEdgeField::kUse);
+  static constexpr BitField kUnreachableField = GetBitField(DirectedEdgeField::kUnreachable);
+  static constexpr BitField kShortcutField = GetBitField(DirectedEdgeField::kIsShortcut);
+
+  // Is the directed edge starting at a word traversable (1 or 0)
+  static uint64_t Traversable(const uint64_t* w) {
+    uint64_t modes = (w[kAccessField.word] >> kAccessField.shift) & ((1 << kAccessField.width) - 1);
+    uint64_t type = (w[kUseField.word] >> kUseField.shift) & ((1 << kUseField.width) - 1);
+    uint64_t is_shortcut = (w[kShortcutField.word] >> kShortcutField.shift) & 1;
+    uint64_t is_unreachable = (w[kUnreachableField.word] >> kUnreachableField.shift) & 1;
+    return ((modes & kAccess) != 0) & (is_shortcut ^ 1) &
+           (type != static_cast<uint64_t>(Use::kRail)) &
+           (type != static_cast<uint64_t>(Use::kBus)) &
+           (kDriving ? is_unreachable ^ 1 : 1);
+  }
+};
+
+template <uint32_t kAccess, bool kForward>
+constexpr bool EdgeFilter<kAccess, kForward>::kDriving;
+template <uint32_t kAccess, bool kForward>
+constexpr BitField EdgeFilter<kAccess, kForward>::kAccessField;
+template <uint32_t kAccess, bool kForward>
+constexpr BitField EdgeFilter<kAccess, kForward>::kUseField;
+template <uint32_t kAccess, bool kForward>
+constexpr BitField EdgeFilter<kAccess, kForward>::kUnreachableField;
+template <uint32_t kAccess, bool kForward>
+constexpr BitField EdgeFilter<kAccess, kForward>::kShortcutField;
+
+}
+}
+
+#endif  // VALHALLA_BALDR_EDGEFILTER_H_
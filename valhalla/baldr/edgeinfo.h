@@ -6,6 +6,8 @@
 #include <ostream>
 #include <iostream>
 
+#include <boost/utility/string_ref.hpp>
+
 #include <valhalla/midgard/pointll.h>
 #include <valhalla/midgard/util.h>
 #include <valhalla/baldr/graphid.h>
@@ -21,25 +23,28 @@ constexpr size_t kMaxEncodedShapeSize = 65535;
 
 /**
  * Edge information not required in shortest path algorithm and is
- * common among the 2 directions.
+ * common among the 2 directions. This is a lightweight view onto the
+ * edge info within a graph tile. It holds only pointers into the tile
+ * data so it is cheap to copy and is returned by value. It is only valid
+ * while the tile it was obtained from is alive.
  */
 class EdgeInfo {
  public:
   EdgeInfo() = delete;
-  EdgeInfo(const EdgeInfo& other) = delete;
 
   /**
    * Constructor
    * @param  ptr  Pointer to a bit of memory that has the info for this edge
    * @param  names_list  Pointer to the start of the text/names list.
    * @param  names_list_length  Length (bytes) of the text/names list.
+   * @param  quantized_shape  Quantized lng,lat coordinates of the shape
+   *                          within the tile, if the tile has them.
+   * @param  quantized_count  Number of quantized points (0 if none).
    */
-  EdgeInfo(char* ptr, const char* names_list, const size_t names_list_length);
-
-  /**
-   * Destructor
-   */
-  virtual ~EdgeInfo();
+  EdgeInfo(const char* ptr, const char* names_list,
+           const size_t names_list_length,
+           const int32_t* quantized_shape = nullptr,
+           const uint32_t quantized_count = 0);
 
   /**
    * Gets the OSM way Id.
@@ -73,11 +78,51 @@ class EdgeInfo {
   const std::vector<std::string> GetNames() const;
 
   /**
-   * Get the shape of the edge.
+   * Get the name at the specified index without copying it out of the tile.
+   * @param  index  Index into the name list.
+   * @return  Returns a reference to the name within the text/name list.
+   *          Only valid while the tile is alive.
+   */
+  boost::string_ref GetNameRef(uint8_t index) const;
+
+  /**
+   * Get the names for an edge without copying them out of the tile.
+   * @param  names  (OUT) References to the names within the text/name list.
+   *                Cleared first so it can be reused across edges.
+   */
+  void GetNameRefs(std::vector<boost::string_ref>& names) const;
+
+  /**
+   * Get the encoded shape bytes within the tile. No copy is made.
+   * @return  Returns an iterable range over the encoded shape.
+   */
+  midgard::iterable_t<const char> encoded_shape_span() const;
+
+  /**
+   * Get the quantized shape within the tile (see QuantizedShapes). No copy
+   * is made. Only present if the tile has the optional quantized shape
+   * section.
+   * @return  Returns interleaved lng,lat coordinates in 1e-6 degrees. Empty
+   *          if there is no quantized shape.
+   */
+  midgard::iterable_t<const int32_t> quantized_shape() const;
+
+  /**
+   * Decode the shape of the edge into a caller provided buffer. The buffer
+   * is cleared first so it can be reused across edges without allocating.
+   * Uses the quantized shape when present, else decodes the encoded shape.
+   * @param  shape  (OUT) List of lat,lng points describing the shape of
+   *                the edge.
+   */
+  void DecodeShape(std::vector<PointLL>& shape) const;
+
+  /**
+   * Get the shape of the edge. Convenience method that decodes the shape
+   * into a new list each call. Prefer DecodeShape in loops.
    * @return  Returns the the list of lat,lng points describing the
    *          shape of the edge.
    */
-  const std::vector<PointLL>& shape() const;
+  std::vector<PointLL> shape() const;
 
   /**
    * Returns the encoded shape string.
@@ -105,22 +150,25 @@ class EdgeInfo {
   uint64_t wayid_;
 
   // Where we keep the statistics about how large the vectors below are
-  PackedItem* item_;
+  const PackedItem* item_;
 
   // List of roadname indexes
-  uint32_t* street_name_offset_list_;
+  const uint32_t* street_name_offset_list_;
 
   // The encoded shape of the edge
-  mutable char* encoded_shape_;
-
-  // Lng, lat shape of the edge
-  mutable std::vector<PointLL> shape_;
+  const char* encoded_shape_;
 
   // The list of names within the tile
   const char* names_list_;
 
   // The size of the names list
-  const size_t names_list_length_;
+  size_t names_list_length_;
+
+  // The quantized shape of the edge (optional, nullptr if none)
+  const int32_t* quantized_shape_;
+
+  // Number of points in the quantized shape
+  uint32_t quantized_count_;
 
 };
 
@@ -0,0 +1,103 @@
+#ifndef VALHALLA_BALDR_EDGESEARCH_H_
+#define VALHALLA_BALDR_EDGESEARCH_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include <valhalla/midgard/pointll.h>
+#include <valhalla/baldr/graphconstants.h>
+#include <valhalla/baldr/graphreader.h>
+#include <valhalla/baldr/pathlocation.h>
+
+namespace valhalla {
+namespace baldr {
+
+// Locations closer than this (meters) to an edge are considered to be on
+// the edge, so no side of street is assigned.
+constexpr float kSideOfStreetTolerance = 5.0f;
+
+/**
+ * A directed edge found near a location.
+ */
+struct NearestEdge {
+  // The directed edge, how far along it the location projects (0 - 1) and
+  // which side of the edge the location is on
+  PathLocation::PathEdge edge;
+
+  // Distance in meters from the location to the edge
+  float distance;
+
+  // Closest point on the edge to the location
+  midgard::PointLL point;
+};
+
+/**
+ * Find the directed edges nearest to a location on the local (most
+ * detailed) level of the hierarchy. Searches outward from the tile
+ * containing the location into neighboring tiles until the k nearest edges
+ * are found or the radius is exhausted. Each tile is searched for its k
+ * nearest edges with its spatial index (see GraphTile::FindNearestEdges),
+ * within the distance of the k-th nearest edge found so far. Shortcut
+ * edges and edges without the requested access in their forward direction
+ * are skipped.
+ * @param  reader  Graph reader used to get the tiles.
+ * @param  ll      Location.
+ * @param  radius  Maximum distance (meters) to an edge.
+ * @param  k       Maximum number of directed edges to return. Both
+ *                 directions of an edge count separately.
+ * @param  access  Access mask (see graphconstants.h). An edge must allow
+ *                 one of these modes.
+ * @return  Returns the edges closest first. Ties are ordered by edge id.
+ */
+std::vector<NearestEdge> FindNearestEdges(GraphReader& reader,
+                                          const midgard::PointLL& ll,
+                                          const float radius, const size_t k,
+                                          const uint32_t access = kAllAccess);
+
+/**
+ * Finds the directed edges nearest to locations like FindNearestEdges,
+ * keeping the decoded shapes of the edges it projected. Locations near
+ * each other, such as a run of locations in the same tile, then decode
+ * each candidate edge once. Only the shapes in the tiles searched for the
+ * last location are kept, so memory stays bounded by a single search.
+ * Like GraphReader it is NOT thread-safe.
+ */
+class EdgeSearcher {
+ public:
+  /**
+   * Constructor
+   * @param  reader  Graph reader used to get the tiles.
+   */
+  EdgeSearcher(GraphReader& reader);
+
+  /**
+   * Find the directed edges nearest to a location (see FindNearestEdges).
+   * @param  ll      Location.
+   * @param  radius  Maximum distance (meters) to an edge.
+   * @param  k       Maximum number of directed edges to return.
+   * @param  access  Access mask (see graphconstants.h).
+   * @return  Returns the edges closest first. Ties are ordered by edge id.
+   */
+  std::vector<NearestEdge> Find(const midgard::PointLL& ll, const float radius,
+                                const size_t k, const uint32_t access = kAllAccess);
+
+  /**
+   * Drop the decoded shapes, for instance to free them once done
+   * searching.
+   */
+  void Clear();
+
+ protected:
+  GraphReader& reader_;
+
+  // Decoded shapes by tile and edge info offset, for the tiles searched
+  // for the last location
+  std::unordered_map<GraphId, std::unordered_map<uint32_t, std::vector<midgard::PointLL> > > shapes_;
+};
+
+}
+}
+
+#endif  // VALHALLA_BALDR_EDGESEARCH_H_
@@ -1,16 +1,20 @@
 #ifndef VALHALLA_BALDR_GRAPHREADER_H_
 #define VALHALLA_BALDR_GRAPHREADER_H_
 
+#include <memory>
 #include <unordered_map>
 
 #include <valhalla/baldr/graphid.h>
 #include <valhalla/baldr/graphtile.h>
+#include <valhalla/baldr/nodecomponents.h>
 #include <valhalla/baldr/tilehierarchy.h>
 #include <boost/property_tree/ptree.hpp>
 
 namespace valhalla {
 namespace baldr {
 
+class connectivity_map_t;
+
 /**
  * Class that manages access to GraphTiles. Reads new tiles where necessary
  * and manages a memory cache of active tiles. It is NOT thread-safe!
@@ -20,7 +24,12 @@ class GraphReader {
   /**
    * Constructor
    *
-   * @param ptree  the configuration for the tilehierarchy
+   * @param ptree  the configuration for the tilehierarchy. Setting
+   *               "lazy_tiles" reads only the routing core of each tile up
+   *               front (see GraphTile). Setting "opposing_edge_tables"
+   *               finds opposing edges through per tile tables (see
+   *               GraphTile::GetOpposingEdgeId). A table loads each
+   *               neighboring tile the first time an edge into it is used.
    */
   GraphReader(const boost::property_tree::ptree& pt);
 
@@ -31,11 +40,21 @@ class GraphReader {
   bool DoesTileExist(const GraphId& graphid) const;
   static bool DoesTileExist(const TileHierarchy& tile_hierarchy, const GraphId& graphid);
 
+  /**
+   * Get the tiles that exist on a level of the hierarchy.
+   * @param  tile_hierarchy  Tile hierarchy.
+   * @param  level           Hierarchy level.
+   * @return  Returns the (base) Ids of the tiles, sorted.
+   */
+  static std::vector<GraphId> GetTileSet(const TileHierarchy& tile_hierarchy, const uint8_t level);
+
   /**
    * Returns true connectivity exists between the two tile ids
    * Note: the connectivity may not be routable or may fail for other reasons
    * the expectation is that the caller knows that this is best case
-   * scenario. The main use case is to quickly reject two disjoint locations
+   * scenario. The main use case is to quickly reject two disjoint locations.
+   * The connectivity map is made once per process for each tile directory
+   * and shared by all readers, so tile changes after that are not seen
    *
    * @param  GraphId  the first tile to check
    * @param  GraphId  the second tile to check
@@ -43,6 +62,28 @@ class GraphReader {
    */
   bool AreConnected(const GraphId& first, const GraphId& second) const;
 
+  /**
+   * Returns false if no route can lead from one node to another for a
+   * travel mode. Nodes are compared by their weak component labels (see
+   * NodeComponents), on any level, when both tiles have them, and by the
+   * connectivity of their tiles otherwise. Like AreConnected a true
+   * result does not guarantee a route.
+   *
+   * @param  origin       the node the route starts at
+   * @param  destination  the node the route ends at
+   * @param  access       access mask of the travel mode
+   * @return bool         whether or not a route may exist
+   */
+  bool AreConnected(const GraphId& origin, const GraphId& destination, const uint32_t access);
+
+  /**
+   * Get the component labels of the nodes of a tile.
+   * @param  graphid  the graphid of the tile
+   * @return NodeComponents*  the labels, nullptr if the tile has no labels
+   *                          file or it no longer matches the tile
+   */
+  const NodeComponents* GetComponents(const GraphId& graphid);
+
   /**
    * Get a pointer to a graph tile object given a GraphId.
    * @param graphid  the graphid of the tile
@@ -65,6 +106,14 @@ class GraphReader {
    */
   const GraphTile* GetGraphTile(const PointLL& pointll);
 
+  /**
+   * Add a tile that was read elsewhere to the cache, unless the cache
+   * already has it. Copies of a tile share its memory and derived indexes,
+   * so readers on several threads can share tiles that were read once.
+   * @param tile  the tile, ignored if it was not loaded
+   */
+  void AddGraphTile(const GraphTile& tile);
+
   /**
    * Get the tile hierarchy used in this graph reader
    * @return hierarchy
@@ -88,7 +137,9 @@ class GraphReader {
    * @return  Returns the graph Id of the opposing directed edge. An
    *          invalid graph Id is returned if the opposing edge does not
    *          exist (can occur with a regional extract where adjacent tile
-   *          is missing).
+   *          is missing). With opposing edge tables enabled the opposing edges
+   *          into each tile are looked up once and then read from the
+   *          table of the tile.
    */
   GraphId GetOpposingEdgeId(const GraphId& edgeid);
   GraphId GetOpposingEdgeId(const GraphId& edgeid, const GraphTile*& tile);
@@ -123,6 +174,19 @@ class GraphReader {
 
   // The max cache size in bytes
   size_t max_cache_size_;
+
+  // Whether tiles are mapped and their non routing sections read on demand
+  bool lazy_tiles_;
+
+  // Whether opposing edges are read from per tile tables
+  bool opposing_edge_tables_;
+
+  // Colors of the connected regions of tiles, shared by all the readers of
+  // the tile directory. Built on first use when there is no connectivity file
+  mutable std::shared_ptr<const connectivity_map_t> connectivity_map_;
+
+  // Component labels read so far by tile, nullptr if the tile has none
+  std::unordered_map<GraphId, std::shared_ptr<const NodeComponents> > components_;
 };
 
 }
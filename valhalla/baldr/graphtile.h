@@ -5,6 +5,9 @@
 #include <valhalla/baldr/graphid.h>
 #include <valhalla/baldr/graphtileheader.h>
 #include <valhalla/baldr/directededge.h>
+#include <valhalla/baldr/edgecore.h>
+#include <valhalla/baldr/edgecosts.h>
+#include <valhalla/baldr/nodecore.h>
 #include <valhalla/baldr/nodeinfo.h>
 #include <valhalla/baldr/transitdeparture.h>
 #include <valhalla/baldr/transitroute.h>
@@ -12,17 +15,24 @@
 #include <valhalla/baldr/transittransfer.h>
 #include <valhalla/baldr/sign.h>
 #include <valhalla/baldr/edgeinfo.h>
+#include <valhalla/baldr/quantizedshape.h>
+#include <valhalla/baldr/packedrtree.h>
 #include <valhalla/baldr/admininfo.h>
 #include <valhalla/baldr/tilehierarchy.h>
 #include <valhalla/midgard/util.h>
 
 #include <boost/shared_array.hpp>
+#include <boost/utility/string_ref.hpp>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 #include "signinfo.h"
 
 namespace valhalla {
 namespace baldr {
 
+class GraphReader;
+
 /**
  * Graph information for a tile within the Tiled Hierarchical Graph.
  */
@@ -36,10 +46,19 @@ class GraphTile {
   /**
    * Constructor given a GraphId. Reads the graph tile from file
    * into memory.
+   *
+   * With lazy loading the file is mapped into memory instead. The header,
+   * nodes and directed edges are read right away and the remaining sections
+   * (edge info, names, signs, admins, transit) are read from the file when
+   * first accessed, so a tile used only for routing keeps little of them
+   * resident. The tile file must not be truncated or rewritten in place
+   * while the tile is in use.
    * @param  hierarchy  Data describing the tiling and hierarchy system.
    * @param  graphid    GraphId (tileid and level)
+   * @param  lazy       Read the sections other than the routing core on demand.
    */
-  GraphTile(const TileHierarchy& hierarchy, const GraphId& graphid);
+  GraphTile(const TileHierarchy& hierarchy, const GraphId& graphid,
+            const bool lazy = false);
 
   /**
    * Destructor
@@ -77,6 +96,15 @@ class GraphTile {
    */
   size_t size() const;
 
+  /**
+   * Gets a fingerprint of the tile: its size and a checksum of its nodes
+   * and directed edges. Files derived from a tile and keyed by node index
+   * (see TileSidecar) store it to detect that the tile has been rebuilt or
+   * reordered since. Computed on first use.
+   * @return  Returns the fingerprint, 0 for an empty tile.
+   */
+  uint64_t fingerprint() const;
+
   /**
    * Gets the id of the graph tile
    * @return  Returns the graph id of the tile (pointing to the first node)
@@ -102,6 +130,28 @@ class GraphTile {
    */
   const NodeInfo* node(const size_t idx) const;
 
+  /**
+   * Get the expansion attributes of the nodes of this tile: edge range,
+   * access and position, packed densely (see NodeCore). Built on first
+   * use, so tiles that are never expanded do not pay for it.
+   * @return  Returns the node cores, indexed like the nodes.
+   */
+  midgard::iterable_t<const NodeCore> GetNodeCores() const;
+
+  /**
+   * Get a pointer to the expansion attributes of a node (see GetNodeCores).
+   * @param  node  GraphId of the node.
+   * @return  Returns a pointer to the node core.
+   */
+  const NodeCore* nodecore(const GraphId& node) const;
+
+  /**
+   * Get a pointer to the expansion attributes of a node (see GetNodeCores).
+   * @param  idx  Index of the node within the current tile.
+   * @return  Returns a pointer to the node core.
+   */
+  const NodeCore* nodecore(const size_t idx) const;
+
   /**
    * Get a pointer to a edge.
    * @param  edge  GraphId of the directed edge.
@@ -117,10 +167,29 @@ class GraphTile {
   const DirectedEdge* directededge(const size_t idx) const;
 
   /**
-   * Get a pointer to edge info.
+   * Get the edge info at the given offset. EdgeInfo is a lightweight view
+   * into this tile's data so it is returned by value (no allocation). If
+   * the tile has quantized shapes the edge info refers to them.
+   * @param  offset  Offset to the edge info (see DirectedEdge).
    * @return  Returns edge info.
    */
-  std::unique_ptr<const EdgeInfo> edgeinfo(const size_t offset) const;
+  EdgeInfo edgeinfo(const size_t offset) const;
+
+  /**
+   * Decode the shapes of many edges at once into one flat list of points.
+   * Decodes straight from the tile bytes and reuses the output buffers so
+   * no allocation is needed once they have grown.
+   * @param  edgeinfo_offsets  Offsets to the edge info of each edge (see
+   *                           DirectedEdge::edgeinfo_offset).
+   * @param  shapes   (OUT) Points of all the shapes, one after another.
+   *                  Cleared first.
+   * @param  offsets  (OUT) Index within shapes of the first point of each
+   *                  shape, followed by the total number of points. Shape i
+   *                  is [offsets[i], offsets[i+1]). Cleared first.
+   */
+  void DecodeShapes(const std::vector<uint32_t>& edgeinfo_offsets,
+                    std::vector<PointLL>& shapes,
+                    std::vector<uint32_t>& offsets) const;
 
   /**
    * Convenience method to get the directed edges originating at a node.
@@ -132,6 +201,88 @@ class GraphTile {
   const DirectedEdge* GetDirectedEdges(const uint32_t node_index,
                                        uint32_t& count, uint32_t& edge_index) const;
 
+  /**
+   * Get the routing core of the directed edges of this tile: the fields a
+   * path expansion reads, packed densely (see EdgeCore). Built on first
+   * use, so tiles that are never expanded do not pay for it.
+   * @return  Returns the edge cores, indexed like the directed edges.
+   */
+  midgard::iterable_t<const EdgeCore> GetEdgeCores() const;
+
+  /**
+   * Get the routing core of the directed edges originating at a node (see
+   * GetDirectedEdges). Reads the node core rather than the node.
+   * @param  node_index  Node Id within this tile.
+   * @param  count       (OUT) Number of outbound edges
+   * @param  edge_index  (OUT) Index of the first outbound edge.
+   * @return  Returns a pointer to the first outbound edge core.
+   */
+  const EdgeCore* GetEdgeCores(const uint32_t node_index, uint32_t& count,
+                               uint32_t& edge_index) const;
+
+  /**
+   * Get the travel time and accessibility of all directed edges of this
+   * tile for a travel mode (see EdgeCosts). Computed on the first request
+   * for a given access mask and cached with the tile, so later requests
+   * for the same mode read the precomputed values.
+   * @param  access  Access mask of the travel mode (see graphconstants.h).
+   * @return  Returns the costs, indexed like the directed edges. Valid
+   *          while this tile (or a copy of it) is alive.
+   */
+  const EdgeCosts& GetEdgeCosts(const uint32_t access) const;
+
+  /**
+   * Get the tiles that directed edges of this tile lead into: neighboring
+   * tiles and, through transition edges, tiles on other levels. Built on
+   * first use together with the boundary edges.
+   * @return  Returns the (base) Ids of the tiles, sorted.
+   */
+  const std::vector<GraphId>& GetBoundaryTiles() const;
+
+  /**
+   * Get the directed edges of this tile whose end node is in another tile.
+   * @param  tile  Tile the edges lead into (any Id within it).
+   * @return  Returns the indexes of the directed edges, in increasing order.
+   *          Empty if no edge of this tile leads into the tile.
+   */
+  midgard::iterable_t<const uint32_t> GetBoundaryEdges(const GraphId& tile) const;
+
+  /**
+   * Get the opposing directed edge of a directed edge of this tile. The
+   * opposing edges within this tile are found the first time, those in
+   * another tile the first time an edge into that tile is asked for, by
+   * loading that tile through the reader. After that finding an opposing
+   * edge is an array read with no tile or node lookups.
+   * @param  reader  Graph reader used to load the tile the edge ends in.
+   * @param  idx     Index of the directed edge within this tile.
+   * @return  Returns the opposing edge Id. It is invalid if the tile of the
+   *          end node does not exist.
+   */
+  GraphId GetOpposingEdgeId(GraphReader& reader, const uint32_t idx) const;
+
+  /**
+   * Get the opposing directed edge of each directed edge of this tile.
+   * Resolves every boundary tile, so this loads all the neighboring tiles
+   * the edges of this tile lead into (see GetOpposingEdgeId).
+   * @param  reader  Graph reader used to load neighboring tiles.
+   * @return  Returns the opposing edge Ids, indexed like the directed edges.
+   *          An Id is invalid if the tile of its end node does not exist.
+   */
+  midgard::iterable_t<const GraphId> GetOpposingEdgeIds(GraphReader& reader) const;
+
+  /**
+   * Get the directed edges that end at a node. Every directed edge has an
+   * opposing edge, so these are the opposing edges of the edges leaving
+   * the node, in the same order. Only the tiles the edges of the node lead
+   * into are loaded.
+   * @param  reader      Graph reader used to load the tiles of the end nodes.
+   * @param  node_index  Index of the node within this tile.
+   * @param  count       (OUT) Number of inbound directed edges.
+   * @return  Returns the Ids of the inbound directed edges.
+   */
+  const GraphId* GetIncomingEdgeIds(GraphReader& reader, const uint32_t node_index,
+                                    uint32_t& count) const;
+
   /**
    * Convenience method to get the names for an edge given the offset to the
    * edge information.
@@ -140,6 +291,35 @@ class GraphTile {
    */
   std::vector<std::string> GetNames(const uint32_t edgeinfo_offset) const;
 
+  /**
+   * Get the names for an edge without copying them out of the text list.
+   * @param  edgeinfo_offset  Offset to the edge info.
+   * @param  names  (OUT) References to the names. Cleared first. Only valid
+   *                while this tile is alive.
+   */
+  void GetNameRefs(const uint32_t edgeinfo_offset,
+                   std::vector<boost::string_ref>& names) const;
+
+  /**
+   * Get the directed edges that have the given street name. Names are
+   * normalized (see NormalizeName) so the match ignores case, punctuation
+   * and spacing. The index from name to edges is built on first use.
+   * @param  name  Street name.
+   * @return  Returns the indexes (within this tile) of the directed edges
+   *          with the name. Empty if there are none.
+   */
+  const std::vector<uint32_t>& GetEdgesByName(const boost::string_ref name) const;
+
+  /**
+   * Normalize a street name for searching. ASCII letters are lower cased
+   * and runs of other ASCII characters that are not letters or digits
+   * (spaces, punctuation) become a single space. Leading and trailing
+   * separators are removed. Non ASCII (UTF-8) bytes are kept as is.
+   * @param  name  Street name.
+   * @return  Returns the normalized name.
+   */
+  static std::string NormalizeName(const boost::string_ref name);
+
   /**
    * Get the admininfo at the specified index. Populates the state name and
    * country name from the text/name list.
@@ -162,6 +342,30 @@ class GraphTile {
    */
   std::string GetName(const uint32_t textlist_offset) const;
 
+  /**
+   * Get the text/name for a given offset to the textlist without copying it.
+   * @param   textlist_offset  offset into the text list.
+   * @return  Returns a reference to the text. Only valid while this tile is
+   *          alive.
+   */
+  boost::string_ref GetNameRef(const uint32_t textlist_offset) const;
+
+  /**
+   * Get the country text of the admin at the specified index without
+   * copying it (see admininfo).
+   * @param  idx  Index into the admin list.
+   * @return  Returns a reference to the country text.
+   */
+  boost::string_ref GetCountryText(const size_t idx) const;
+
+  /**
+   * Get the state text of the admin at the specified index without
+   * copying it (see admininfo).
+   * @param  idx  Index into the admin list.
+   * @return  Returns a reference to the state text.
+   */
+  boost::string_ref GetStateText(const size_t idx) const;
+
   /**
    * Convenience method to get the signs for an edge given the directed
    * edge index.
@@ -188,6 +392,63 @@ class GraphTile {
                                            const uint32_t dow,
                                            bool  date_before_tile) const;
 
+  /**
+   * Get the departures along a transit line with departure times within
+   * the time window [start_time, end_time]. Departures are sorted by line
+   * Id and departure time so this is a contiguous range. No service day
+   * filtering is done.
+   * @param   lineid      Transit line Id.
+   * @param   start_time  Start of the time window (seconds from midnight).
+   * @param   end_time    End of the time window (seconds from midnight).
+   * @return  Returns an iterable range of departures (may be empty).
+   */
+  midgard::iterable_t<const TransitDeparture> GetDepartures(
+                          const uint32_t lineid, const uint32_t start_time,
+                          const uint32_t end_time) const;
+
+  /**
+   * Get all departures along a transit line within the time window
+   * [start_time, end_time] that are valid on the given service day. This
+   * is the bulk form of GetNextDeparture used by round based transit
+   * algorithms: the departures of the line are found with one search.
+   * @param   lineid            Transit line Id.
+   * @param   start_time        Start of the time window (seconds from midnight).
+   * @param   end_time          End of the time window (seconds from midnight).
+   * @param   day               Days since the tile creation date.
+   * @param   dow               Day of week (see graphconstants.h)
+   * @param   date_before_tile  Is the date that was inputed before
+   *                            the tile creation date?
+   * @param   departures        (OUT) Valid departures are appended, sorted
+   *                            by departure time.
+   * @return  Returns the number of departures appended.
+   */
+  uint32_t GetDepartures(const uint32_t lineid, const uint32_t start_time,
+                         const uint32_t end_time, const uint32_t day,
+                         const uint32_t dow, const bool date_before_tile,
+                         std::vector<const TransitDeparture*>& departures) const;
+
+  /**
+   * Get all departures from a transit stop node within the time window
+   * [start_time, end_time] that are valid on the given service day. This
+   * collects the departures of every transit line leaving the node.
+   * Departures are grouped by line and sorted by departure time within
+   * each line.
+   * @param   node_index        Index of the transit stop node in this tile.
+   * @param   start_time        Start of the time window (seconds from midnight).
+   * @param   end_time          End of the time window (seconds from midnight).
+   * @param   day               Days since the tile creation date.
+   * @param   dow               Day of week (see graphconstants.h)
+   * @param   date_before_tile  Is the date that was inputed before
+   *                            the tile creation date?
+   * @param   departures        (OUT) Valid departures are appended.
+   * @return  Returns the number of departures appended.
+   */
+  uint32_t GetStopDepartures(const uint32_t node_index,
+                             const uint32_t start_time,
+                             const uint32_t end_time, const uint32_t day,
+                             const uint32_t dow, const bool date_before_tile,
+                             std::vector<const TransitDeparture*>& departures) const;
+
   /**
    * Get the departure given the directed edge Id and tripid
    * @param   edgeid  Directed edge Id.
@@ -214,7 +475,8 @@ class GraphTile {
 
   /**
    * Get a pointer to the first transfer record given the stop Id and
-   * compute the number of transfer records for the stop.
+   * compute the number of transfer records for the stop. Uses the transfer
+   * index built when the tile is loaded so this is a direct lookup.
    * @param   stopid  Stop Id.
    * @return  Returns a pair with a pointer to the initial transfer record
    *          and a count of transfer records from the given stop Id.
@@ -224,7 +486,7 @@ class GraphTile {
 
   /**
    * Get a pointer to the transfer record given the from stop Id and
-   * the to stop id.
+   * the to stop id. Binary searches the transfers from the from stop.
    * @param   from_stopid  From stop Id.
    * @param   to_stopid    To stop Id.
    * @return  Returns a pointer to the transfer record between the 2 stops.
@@ -252,8 +514,110 @@ class GraphTile {
    */
   midgard::iterable_t<GraphId> GetCell(size_t column, size_t row) const;
 
+  /**
+   * Find the directed edges whose shape bounding box intersects the given
+   * box. Uses a spatial index (packed Hilbert R-tree) over the edge shapes
+   * of this tile that is built on first use. Finer than GetCell in dense
+   * tiles. Transition edges are not included.
+   * @param  box    Bounding box to search.
+   * @param  edges  (OUT) Ids of the directed edges are appended (in no
+   *                particular order).
+   */
+  void FindEdges(const midgard::AABB2<PointLL>& box,
+                 std::vector<GraphId>& edges) const;
+
+  /**
+   * Find the directed edges nearest to a location using the spatial index
+   * (see FindEdges). Distance is measured to the edge shape. Both
+   * directions of an edge are returned (with the same distance). Shortcut
+   * edges and edges without the access in their forward direction are
+   * skipped.
+   * @param  ll            Location.
+   * @param  k             Maximum number of directed edges to find.
+   * @param  max_distance  Maximum distance (meters) to an edge.
+   * @param  edges         (OUT) Pairs of distance (meters) and directed
+   *                       edge Id, closest first. Cleared first.
+   * @param  access        Access mask (see graphconstants.h). An edge must
+   *                       allow one of these modes.
+   * @param  shapes        (IN/OUT) Optional decoded shapes of this tile by
+   *                       edge info offset. Shapes are decoded into it and
+   *                       reused, so keep it between searches near each other.
+   */
+  void FindNearestEdges(const PointLL& ll, const size_t k,
+                        const float max_distance,
+                        std::vector<std::pair<float, GraphId> >& edges,
+                        const uint32_t access = kAllAccess,
+                        std::unordered_map<uint32_t, std::vector<PointLL> >* shapes = nullptr) const;
+
  protected:
 
+  /**
+   * Builds the transfer index: a compressed sparse row layout where
+   * transfer_offsets_[stopid] is the index of the first transfer from
+   * the stop and transfer_offsets_[stopid+1] is one past the last. The
+   * tile data is never modified, unsorted transfers are sorted in a copy.
+   * Transfers from a stop Id past the stop count are left out.
+   */
+  void BuildTransferIndex();
+
+  /**
+   * Read a tile file into memory.
+   * @param  file_location  Path of the tile file.
+   * @param  ptr            Set to the start of the tile data.
+   * @return  Returns the size of the file.
+   */
+  size_t ReadFile(const std::string& file_location, char*& ptr);
+
+  /**
+   * Map a tile file into memory, reading its pages on first access.
+   * @param  file_location  Path of the tile file.
+   * @param  ptr            Set to the start of the tile data.
+   * @return  Returns the size of the file.
+   */
+  size_t MapFile(const std::string& file_location, char*& ptr);
+
+  /**
+   * Set the section pointers of a version 1 tile, whose sections follow
+   * the header in a fixed order sized by the record counts.
+   * @param  filesize  Size of the tile in bytes.
+   * @return  Returns true if the sections were found.
+   */
+  bool SetSectionsV1(const size_t filesize);
+
+  /**
+   * Set the section pointers of a version 2 tile from its table of
+   * contents (see TileSection). Sections of unknown types are skipped.
+   * @param  filesize  Size of the tile in bytes.
+   * @return  Returns false if a section lies outside the tile or the size
+   *          of a record section does not match its record count.
+   */
+  bool SetSectionsV2(const size_t filesize);
+
+  /**
+   * Build the boundary tiles and edges on first use.
+   */
+  void BuildBoundaryEdges() const;
+
+  /**
+   * Build the opposing edges of the edges ending within this tile on first
+   * use.
+   */
+  void BuildOpposingEdges() const;
+
+  /**
+   * Resolve the opposing edges of the edges into a boundary tile on first
+   * use, loading that tile.
+   * @param  reader    Graph reader used to load the tile.
+   * @param  boundary  Index of the tile in the boundary tiles.
+   */
+  void ResolveOpposingEdges(GraphReader& reader, const size_t boundary) const;
+
+  /**
+   * Get the spatial index of the directed edge shapes. Built on first use.
+   * @return  Returns the index. Ids are directed edge indexes.
+   */
+  const PackedRTree& GetEdgeIndex() const;
+
   // Size of the tile in bytes
   size_t size_;
 
@@ -285,6 +649,12 @@ class GraphTile {
   // Transit transfers, 1 or more per index (indexed by from stop Id)
   TransitTransfer* transit_transfers_;
 
+  // Offsets into the transit transfers indexed by from stop Id (CSR index)
+  std::vector<uint32_t> transfer_offsets_;
+
+  // Sorted copy of the transit transfers when the tile has them out of order
+  std::shared_ptr<std::vector<TransitTransfer> > sorted_transfers_;
+
   // Access restrictions, 1 or more per edge id
   AccessRestriction* access_restrictions_;
 
@@ -313,6 +683,16 @@ class GraphTile {
   // Number of bytes in the text/name list
   std::size_t textlist_size_;
 
+  // Optional quantized shapes of the edge info (empty if the tile does not
+  // have them)
+  QuantizedShapes quantized_shapes_;
+
+  // Indexes derived from the tile data on first use. Shared by copies of
+  // the tile and built at most once, so it is safe to query from many
+  // threads.
+  struct LazyData;
+  std::shared_ptr<LazyData> lazy_;
+
 };
 
 }
@@ -13,6 +13,13 @@ namespace baldr {
 // character array so the GraphTileHeader size remains fixed).
 constexpr size_t kMaxVersionSize = 16;
 
+// Tile formats. Version 1 stores the sections in a fixed order, located by
+// adding up the record counts. Version 2 follows the header with a table
+// of contents (see TileSection) and aligns each section. Tiles written
+// before the format version was stored have 0 there and are version 1.
+constexpr uint32_t kTileFormatV1 = 1;
+constexpr uint32_t kTileFormatV2 = 2;
+
 // Total number of binned edge cells in the tile
 constexpr size_t kGridDim = 5;
 constexpr size_t kCellCount = kGridDim * kGridDim;
@@ -265,6 +272,47 @@ class GraphTileHeader {
    */
   void set_complex_restriction_offset(const uint32_t offset);
 
+  /**
+   * Get the offset to the optional quantized shape section.
+   * @return  Returns the number of bytes to offset to the quantized shapes
+   *          or 0 if the tile does not have them.
+   */
+  uint32_t quantized_shape_offset() const;
+
+  /**
+   * Sets the offset to the quantized shape section. This section is
+   * optional and is stored last (after the text list). The offset must be
+   * a multiple of 4 bytes.
+   * @param offset Offset in bytes to the start of the quantized shapes
+   *               (0 if none).
+   */
+  void set_quantized_shape_offset(const uint32_t offset);
+
+  /**
+   * Get the format version of the tile layout.
+   * @return  Returns the format version (kTileFormatV1 or kTileFormatV2).
+   */
+  uint32_t format_version() const;
+
+  /**
+   * Sets the format version of the tile layout.
+   * @param  version  Format version (kTileFormatV1 or kTileFormatV2).
+   */
+  void set_format_version(const uint32_t version);
+
+  /**
+   * Get the number of entries in the table of contents that follows the
+   * header (format version 2 only).
+   * @return  Returns the number of sections.
+   */
+  uint32_t section_count() const;
+
+  /**
+   * Sets the number of entries in the table of contents.
+   * @param  count  Number of sections (at most 255).
+   */
+  void set_section_count(const uint32_t count);
+
   /**
    * Get the offset to the given cell in the 5x5 grid, the cells contain
    * graphids for all the edges that intersect the cell
@@ -292,7 +340,10 @@ class GraphTileHeader {
   uint64_t name_quality_  : 4;
   uint64_t speed_quality_ : 4;
   uint64_t exit_quality_  : 4;
-  uint64_t spare1_        : 48;
+  uint64_t quantized_shape_offset_ : 32; // Offset to quantized shapes
+  uint64_t format_version_ : 4;  // Tile format version (0 = version 1)
+  uint64_t section_count_  : 8;  // Entries in the table of contents
+  uint64_t spare1_         : 4;
 
   // Number of transit departure records
   uint64_t departurecount_ : 24;
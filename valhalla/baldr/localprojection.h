@@ -0,0 +1,71 @@
+#ifndef VALHALLA_BALDR_LOCALPROJECTION_H_
+#define VALHALLA_BALDR_LOCALPROJECTION_H_
+
+#include <vector>
+
+#include <valhalla/midgard/pointll.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * Where a location projects onto a shape.
+ */
+struct ShapeProjection {
+  // Distance in meters from the location to the shape
+  float distance;
+
+  // Fraction of the shape length before the closest point (0 - 1)
+  float along;
+
+  // Greater than 0 if the location is left of the shape direction
+  float cross;
+
+  // Closest point on the shape to the location
+  midgard::PointLL point;
+};
+
+/**
+ * Distances from a location to boxes and shapes, in meters. Uses an
+ * equirectangular projection centered on the location, which is accurate
+ * at the scale of a tile or a search radius.
+ */
+class LocalProjection {
+ public:
+  /**
+   * Constructor.
+   * @param  ll  Location to measure from.
+   */
+  LocalProjection(const midgard::PointLL& ll);
+
+  /**
+   * Get the distance to the nearest point of a bounding box.
+   * @param  minx  Minimum longitude of the box.
+   * @param  miny  Minimum latitude of the box.
+   * @param  maxx  Maximum longitude of the box.
+   * @param  maxy  Maximum latitude of the box.
+   * @return  Returns the distance in meters, 0 inside the box.
+   */
+  float Distance(const float minx, const float miny, const float maxx,
+                 const float maxy) const;
+
+  /**
+   * Project the location onto a shape. When segments are equally close the
+   * first one is used.
+   * @param  shape  Shape points.
+   * @return  Returns the projection. The distance is the largest float for
+   *          an empty shape.
+   */
+  ShapeProjection Project(const std::vector<midgard::PointLL>& shape) const;
+
+ protected:
+  midgard::PointLL ll_;
+
+  // Meters per degree of longitude at the location
+  float lng_scale_;
+};
+
+}
+}
+
+#endif  // VALHALLA_BALDR_LOCALPROJECTION_H_
@@ -0,0 +1,91 @@
+#ifndef VALHALLA_BALDR_NAMEINTERNER_H_
+#define VALHALLA_BALDR_NAMEINTERNER_H_
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <boost/utility/string_ref.hpp>
+#include <boost/functional/hash.hpp>
+
+namespace valhalla {
+namespace baldr {
+
+// Id used for names that have not been interned
+constexpr uint32_t kInvalidNameId = std::numeric_limits<uint32_t>::max();
+
+/**
+ * Maps names to small integer ids so that identical names (for example the
+ * same street name stored in the text lists of different tiles) share one
+ * id. Comparing ids is then equivalent to comparing the names. Ids are
+ * assigned in order starting at 0 and are never released. This class is
+ * thread-safe.
+ */
+class NameInterner {
+ public:
+  /**
+   * Constructor
+   */
+  NameInterner();
+
+  /**
+   * Get the process-wide interner. Ids from different interners are not
+   * comparable so use this one when ids are shared between objects.
+   * @return  Returns the process-wide interner.
+   */
+  static NameInterner& Get();
+
+  /**
+   * Get the id of a name, adding the name if it has not been seen before.
+   * @param  name  Name to intern.
+   * @return  Returns the id of the name.
+   */
+  uint32_t Intern(const boost::string_ref name);
+
+  /**
+   * Get the id of a name without adding it.
+   * @param  name  Name to find.
+   * @return  Returns the id of the name or kInvalidNameId if the name has not
+   *          been interned.
+   */
+  uint32_t Find(const boost::string_ref name) const;
+
+  /**
+   * Get the name for an id.
+   * @param  id  Id returned by Intern.
+   * @return  Returns the name. The reference remains valid for the lifetime
+   *          of the interner.
+   */
+  const std::string& name(const uint32_t id) const;
+
+  /**
+   * Get the number of interned names.
+   * @return  Returns the number of names.
+   */
+  size_t size() const;
+
+ protected:
+  struct NameHasher {
+    std::size_t operator()(const boost::string_ref name) const {
+      return boost::hash_range(name.begin(), name.end());
+    }
+  };
+
+  // Protects the members below
+  mutable std::mutex mutex_;
+
+  // Interned names indexed by id. A deque keeps references to the names
+  // stable as it grows (the map keys refer to them).
+  std::deque<std::string> names_;
+
+  // Map from name to id
+  std::unordered_map<boost::string_ref, uint32_t, NameHasher> ids_;
+};
+
+}
+}
+
+#endif  // VALHALLA_BALDR_NAMEINTERNER_H_
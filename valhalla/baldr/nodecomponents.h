@@ -0,0 +1,120 @@
+#ifndef VALHALLA_BALDR_NODECOMPONENTS_H_
+#define VALHALLA_BALDR_NODECOMPONENTS_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <valhalla/baldr/graphconstants.h>
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/baldr/graphtile.h>
+#include <valhalla/baldr/tilehierarchy.h>
+#include <valhalla/baldr/tilesidecar.h>
+
+namespace valhalla {
+namespace baldr {
+
+// Component label of a node that was not labeled
+constexpr uint32_t kNoComponent = std::numeric_limits<uint32_t>::max();
+
+// Travel modes labeled by default
+const std::vector<uint32_t> kComponentModes = { kAutoAccess, kPedestrianAccess, kBicycleAccess };
+
+/**
+ * Connected component labels of the nodes of one tile, for one or more
+ * travel modes. Components span all levels of the hierarchy and follow the
+ * directed edges a mode can use (see GraphTile::GetEdgeCosts) as well as
+ * the transition edges between levels, so nodes of a sparse upper level
+ * joined only through a lower level share a component.
+ * Nodes in the same strong component can reach each other. Nodes in
+ * different weak components cannot reach each other at all, which makes
+ * the weak labels a safe test to reject a route. Labels are stored next to
+ * their tile (see FileName) and are built by BuildComponents.
+ */
+class NodeComponents : public TileSidecar {
+ public:
+  /**
+   * Constructor for empty labels.
+   */
+  NodeComponents();
+
+  /**
+   * Constructor for unlabeled nodes of a tile, see set_labels.
+   * @param  tile  Graph tile.
+   */
+  NodeComponents(const GraphTile& tile);
+
+  /**
+   * Constructor. Reads labels written by Write.
+   * @param  file  Labels file.
+   */
+  NodeComponents(const std::string& file);
+
+  /**
+   * Write the labels to a file (see TileSidecar::Write).
+   * @param  file  Labels file.
+   * @return  Returns true if the file was written.
+   */
+  bool Write(const std::string& file) const;
+
+  /**
+   * Gets the labels file name of a tile: the tile file name with an .scc
+   * extension.
+   * @param  graphid    Tile (base) Id.
+   * @param  hierarchy  Tile hierarchy.
+   * @return  Returns the path of the labels file.
+   */
+  static std::string FileName(const GraphId& graphid, const TileHierarchy& hierarchy);
+
+  /**
+   * Get the strong component of a node.
+   * @param  node_index  Index of the node within the tile.
+   * @param  access      Access mask of the travel mode.
+   * @return  Returns the component id, unique within the hierarchy,
+   *          or kNoComponent if the node or mode was not labeled.
+   */
+  uint32_t strong(const uint32_t node_index, const uint32_t access) const;
+
+  /**
+   * Get the weak component of a node: the nodes connected to it by edges
+   * the mode can use in either direction.
+   * @param  node_index  Index of the node within the tile.
+   * @param  access      Access mask of the travel mode.
+   * @return  Returns the component id, unique within the hierarchy,
+   *          or kNoComponent if the node or mode was not labeled.
+   */
+  uint32_t weak(const uint32_t node_index, const uint32_t access) const;
+
+  /**
+   * Set the labels of a travel mode.
+   * @param  access  Access mask of the travel mode.
+   * @param  strong  Strong component of each node of the tile.
+   * @param  weak    Weak component of each node of the tile.
+   */
+  void set_labels(const uint32_t access, std::vector<uint32_t> strong,
+                  std::vector<uint32_t> weak);
+
+ protected:
+  // Strong and weak component of each node by access mask
+  std::unordered_map<uint32_t, std::pair<std::vector<uint32_t>, std::vector<uint32_t> > > labels_;
+};
+
+/**
+ * Labels the connected components of the nodes of all levels for each
+ * travel mode and writes the labels next to the tiles. Modes are labeled
+ * on their own threads. Strong components are found with an iterative
+ * version of Tarjan's algorithm, so deep graphs do not overflow the stack.
+ * @param  hierarchy     Tile hierarchy.
+ * @param  access_modes  Access masks of the travel modes.
+ * @return  Returns the number of labels files written.
+ */
+size_t BuildComponents(const TileHierarchy& hierarchy,
+                       const std::vector<uint32_t>& access_modes = kComponentModes);
+
+}
+}
+
+#endif  // VALHALLA_BALDR_NODECOMPONENTS_H_
@@ -0,0 +1,101 @@
+#ifndef VALHALLA_BALDR_NODECORE_H_
+#define VALHALLA_BALDR_NODECORE_H_
+
+#include <cstdint>
+#include <utility>
+
+#include <valhalla/midgard/pointll.h>
+#include <valhalla/baldr/graphconstants.h>
+#include <valhalla/baldr/nodeinfo.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * The attributes of a node read while expanding a path: its outbound edge
+ * range, access and position (for the A* heuristic). Packed into 16 bytes
+ * instead of the 32 bytes of a NodeInfo, leaving out admin, time zone,
+ * heading and transit stop data. Built from the nodes of a tile (see
+ * GraphTile::nodecore) and indexed the same way. Accessors are defined here
+ * so they inline into the expansion loop.
+ */
+class NodeCore {
+ public:
+  /**
+   * Constructor
+   * @param  node  Node to copy the expansion attributes from.
+   */
+  NodeCore(const NodeInfo& node);
+
+  /**
+   * Get the latitude, longitude of the node.
+   * @return  Returns the latitude and longitude of the node.
+   */
+  const midgard::PointLL& latlng() const {
+    return static_cast<const midgard::PointLL&>(latlng_);
+  }
+
+  /**
+   * Get the index of the first outbound edge from this node. Since
+   * all outbound edges are in the same tile/level as the node we
+   * only need an index within the tile.
+   * @return  Returns the index of the first outbound edge.
+   */
+  uint32_t edge_index() const {
+    return edge_index_;
+  }
+
+  /**
+   * Get the number of outbound directed edges.
+   * @return  Returns the number of outbound directed edges.
+   */
+  uint32_t edge_count() const {
+    return edge_count_;
+  }
+
+  /**
+   * Get the access modes (bit mask) allowed to pass through the node.
+   * @return  Returns the access mask (see graphconstants.h).
+   */
+  uint16_t access() const {
+    return access_;
+  }
+
+  /**
+   * Get the type of the node.
+   * @return  Returns the node type.
+   */
+  NodeType type() const {
+    return static_cast<NodeType>(type_);
+  }
+
+  // Flags, see the accessors of the same name in NodeInfo
+  bool parent() const {
+    return parent_;
+  }
+  bool child() const {
+    return child_;
+  }
+  bool mode_change() const {
+    return mode_change_;
+  }
+
+ protected:
+  // Latitude, longitude position of the node.
+  std::pair<float, float> latlng_;
+
+  uint64_t edge_index_  : 22; // Index within the tile of the first
+                              // outbound directed edge
+  uint64_t edge_count_  : 7;  // Number of outbound edges (on this level)
+  uint64_t access_      : 12; // Access through the node - bit field
+  uint64_t type_        : 4;  // NodeType, see graphconstants
+  uint64_t parent_      : 1;  // Is this a parent node
+  uint64_t child_       : 1;  // Is this a child node
+  uint64_t mode_change_ : 1;  // Mode change allowed?
+  uint64_t spare_       : 16;
+};
+
+}
+}
+
+#endif  // VALHALLA_BALDR_NODECORE_H_
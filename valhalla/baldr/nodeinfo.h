@@ -28,6 +28,32 @@ constexpr float kHeadingShrinkFactor = (255.f/359.f);
 // Heading expand factor to increase max heading of 255 to 359
 constexpr float kHeadingExpandFactor = (359.f/255.f);
 
+/**
+ * Bit fields of a node, in storage order after the lat,lng. The members of
+ * NodeInfo and the field table of recordfields.h are both generated from
+ * this list (see the DirectedEdge lists in directededge.h).
+ */
+#define VALHALLA_NODEINFO_BITFIELDS(FIELD, OTHER) \
+  /* Node attributes and admin information */ \
+  FIELD(kEdgeIndex, uint64_t, edge_index_, 22) /* Index within the node's tile of its first outbound directed edge */ \
+  FIELD(kAccess, uint64_t, access_, 12) /* Access through the node - bit field */ \
+  FIELD(kEdgeCount, uint64_t, edge_count_, 7) /* Number of outbound edges (on this level) */ \
+  FIELD(kBestRC, uint64_t, bestrc_, 3) /* Best directed edge road class */ \
+  FIELD(kAdminIndex, uint64_t, admin_index_, 6) /* Index into this tile's list of admin data */ \
+  FIELD(kTimeZone, uint64_t, timezone_, 9) /* Time zone */ \
+  FIELD(kIntersection, uint64_t, intersection_, 5) /* Intersection type */ \
+  \
+  /* Node type and additional node attributes */ \
+  FIELD(kLocalDriveability, uint32_t, local_driveability_, 16) /* Driveability for local edges (up to kMaxLocalEdgeIndex+1 edges) */ \
+  FIELD(kDensity, uint32_t, density_, 4) /* Relative road density */ \
+  FIELD(kType, uint32_t, type_, 4) /* NodeType, see graphconstants */ \
+  FIELD(kLocalEdgeCount, uint32_t, local_edge_count_, 3) /* # of edges on local level (up to kMaxLocalEdgeIndex+1) */ \
+  FIELD(kParent, uint32_t, parent_, 1) /* Is this a parent node */ \
+  FIELD(kChild, uint32_t, child_, 1) /* Is this a child node */ \
+  FIELD(kModeChange, uint32_t, mode_change_, 1) /* Mode change allowed? */ \
+  FIELD(kTrafficSignal, uint32_t, traffic_signal_, 1) /* Traffic signal */ \
+  OTHER(uint32_t, spare1_, 1)
+
 /**
  * Information held for each node within the graph. The graph uses a forward
  * star structure: nodes point to the first outbound directed edge and each
@@ -325,28 +351,12 @@ class NodeInfo {
   // Latitude, longitude position of the node.
   std::pair<float, float> latlng_;
 
-  // Node attributes and admin information
-  uint64_t edge_index_   : 22;  // Index within the node's tile of its first
-                                // outbound directed edge
-  uint64_t access_       : 12;  // Access through the node - bit field
-  uint64_t edge_count_   : 7;   // Number of outbound edges (on this level)
-  uint64_t bestrc_       : 3;   // Best directed edge road class
-  uint64_t admin_index_  : 6;   // Index into this tile's list of admin data
-  uint64_t timezone_     : 9;   // Time zone
-  uint64_t intersection_ : 5;   // Intersection type
-
-  // Node type and additional node attributes
-  uint32_t local_driveability_ : 16; // Driveability for local edges (up to
-                                     // kMaxLocalEdgeIndex+1 edges)
-  uint32_t density_            : 4;  // Relative road density
-  uint32_t type_               : 4;  // NodeType, see graphconstants
-  uint32_t local_edge_count_   : 3;  // # of edges on local level (up to
-                                     // kMaxLocalEdgeIndex+1)
-  uint32_t parent_             : 1;  // Is this a parent node
-  uint32_t child_              : 1;  // Is this a child node
-  uint32_t mode_change_        : 1;  // Mode change allowed?
-  uint32_t traffic_signal_     : 1;  // Traffic signal
-  uint32_t spare1_             : 1;
+  // Bit fields generated from the list above
+#define VALHALLA_DECLARE_FIELD(field, type, member, width) type member : width;
+#define VALHALLA_DECLARE_OTHER(type, member, width) type member : width;
+  VALHALLA_NODEINFO_BITFIELDS(VALHALLA_DECLARE_FIELD, VALHALLA_DECLARE_OTHER)
+#undef VALHALLA_DECLARE_FIELD
+#undef VALHALLA_DECLARE_OTHER
 
   // Transit stop index
   union NodeStop {
@@ -358,6 +368,10 @@ class NodeInfo {
   // Headings of up to kMaxLocalEdgeIndex+1 local edges (rounded to
   // nearest 2 degrees)
   uint64_t headings_;
+
+  // The members recordfields.h places by hand rather than from the list
+  static_assert(sizeof(std::pair<float, float>) == 8, "The lat,lng must be the first word");
+  static_assert(sizeof(NodeStop) == 4, "The stop index must fill the union");
 };
 
 }
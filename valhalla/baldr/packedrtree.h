@@ -0,0 +1,147 @@
+#ifndef VALHALLA_BALDR_PACKEDRTREE_H_
+#define VALHALLA_BALDR_PACKEDRTREE_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * Static spatial index over bounding boxes. Items are sorted along a
+ * Hilbert curve (by the center of their box) and packed bottom up into
+ * nodes of kNodeSize children, so nearby items end up in the same nodes
+ * and the tree adapts to the density of the data. The tree cannot be
+ * modified once built. Boxes are in x,y (lng,lat) coordinates.
+ */
+class PackedRTree {
+ public:
+  // Number of children per node
+  static constexpr uint32_t kNodeSize = 16;
+
+  struct Box {
+    float minx;
+    float miny;
+    float maxx;
+    float maxy;
+  };
+
+  /**
+   * Constructor. Creates an empty tree. Add items then call Build.
+   */
+  PackedRTree();
+
+  /**
+   * Reserve memory for the given number of items.
+   * @param  count  Number of items.
+   */
+  void reserve(const size_t count);
+
+  /**
+   * Add an item. Must be called before Build.
+   * @param  box  Bounding box of the item.
+   * @param  id   Id of the item (returned by queries).
+   */
+  void Add(const Box& box, const uint32_t id);
+
+  /**
+   * Sort the items and build the tree.
+   */
+  void Build();
+
+  /**
+   * Get the number of items in the tree.
+   * @return  Returns the number of items.
+   */
+  size_t size() const;
+
+  /**
+   * Find the items whose box intersects the given box.
+   * @param  box      Box to search.
+   * @param  results  (OUT) Ids of the items are appended (in no
+   *                  particular order).
+   */
+  void Query(const Box& box, std::vector<uint32_t>& results) const;
+
+  /**
+   * Find the nearest items. The search is best first: nodes and items are
+   * visited in order of the distance to their box, and the exact distance
+   * of an item is only computed once its box is the closest remaining.
+   * @param  k             Maximum number of items to find.
+   * @param  max_distance  Items farther than this are not returned.
+   * @param  box_distance  Function (const Box&) -> float giving a lower bound
+   *                       of the distance to anything inside the box.
+   * @param  distance      Function (uint32_t id) -> float giving the exact
+   *                       distance to an item. Must not be less than the
+   *                       distance to the box of the item.
+   * @param  results       (OUT) Pairs of distance and id, closest first.
+   *                       Cleared first.
+   */
+  template <class box_distance_t, class distance_t>
+  void Nearest(const size_t k, const float max_distance,
+               const box_distance_t& box_distance, const distance_t& distance,
+               std::vector<std::pair<float, uint32_t> >& results) const {
+    results.clear();
+    if (k == 0 || ids_.empty()) {
+      return;
+    }
+
+    // Queue entries are the distance and the position within boxes_. The
+    // sign bit of the position marks items whose distance is exact.
+    typedef std::pair<float, uint64_t> entry_t;
+    const uint64_t kExact = 1ULL << 63;
+    std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t> > queue;
+    queue.emplace(box_distance(boxes_.back()), boxes_.size() - 1);
+    while (!queue.empty() && results.size() < k) {
+      entry_t top = queue.top();
+      queue.pop();
+      if (top.first > max_distance) {
+        break;
+      }
+
+      // An exact distance is final: nothing left can be closer
+      if (top.second & kExact) {
+        results.emplace_back(top.first, static_cast<uint32_t>(top.second & ~kExact));
+        continue;
+      }
+
+      // An item: queue its exact distance
+      size_t pos = top.second;
+      if (pos < ids_.size()) {
+        queue.emplace(distance(ids_[pos]), ids_[pos] | kExact);
+        continue;
+      }
+
+      // A node: queue its children
+      size_t end;
+      size_t first = FirstChild(pos, end);
+      for (size_t i = first; i < end; ++i) {
+        queue.emplace(box_distance(boxes_[i]), i);
+      }
+    }
+  }
+
+ protected:
+  // Get the range of children of the node at the given position
+  size_t FirstChild(const size_t pos, size_t& end) const;
+
+  // Boxes of the items (sorted) followed by the nodes of each level. The
+  // last box is the root.
+  std::vector<Box> boxes_;
+
+  // Ids of the items in sorted order
+  std::vector<uint32_t> ids_;
+
+  // Start position of each level within boxes_ (level 0 are the items)
+  // followed by the total number of boxes
+  std::vector<size_t> level_bounds_;
+};
+
+}
+}
+
+#endif  // VALHALLA_BALDR_PACKEDRTREE_H_
@@ -0,0 +1,43 @@
+#ifndef VALHALLA_BALDR_PARALLEL_H_
+#define VALHALLA_BALDR_PARALLEL_H_
+
+#include <cstddef>
+#include <functional>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * Get the number of threads to run work items on.
+ * @param  threads  Requested number of threads, 0 for the hardware
+ *                  concurrency.
+ * @param  count    Number of work items.
+ * @return  Returns the number of threads, at most one per work item and
+ *          at least 1.
+ */
+size_t ThreadCount(const size_t threads, const size_t count);
+
+/**
+ * Run work(thread) for each thread in [0, threads): on the calling thread
+ * and on threads - 1 extra threads. Once all of them have finished the
+ * error of the first thread that threw, if any, is rethrown.
+ * @param  threads  Number of threads, at least 1.
+ * @param  work     Work of a thread, given its index.
+ */
+void RunThreads(const size_t threads, const std::function<void (size_t)>& work);
+
+/**
+ * Run work(i) for each i in [0, count) on a pool of threads (see
+ * RunThreads). Each thread takes the next item until there are none left,
+ * so items that take longer do not hold the others up.
+ * @param  count    Number of work items.
+ * @param  threads  Number of threads, 0 for the hardware concurrency.
+ * @param  work     Work of an item, given its index.
+ */
+void ParallelFor(const size_t count, const size_t threads,
+                 const std::function<void (size_t)>& work);
+
+}
+}
+
+#endif  // VALHALLA_BALDR_PARALLEL_H_
@@ -0,0 +1,100 @@
+#ifndef VALHALLA_BALDR_QUANTIZEDSHAPE_H_
+#define VALHALLA_BALDR_QUANTIZEDSHAPE_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <valhalla/midgard/pointll.h>
+#include <valhalla/midgard/util.h>
+
+namespace valhalla {
+namespace baldr {
+
+// Quantized coordinates are stored in 1e-6 degrees (same precision as the
+// encoded shape).
+constexpr double kQuantizedShapePrecision = 1e6;
+
+/**
+ * Optional tile section holding the shape of each edge info as fixed width
+ * quantized coordinates. Unlike the encoded (varint) shape these need no
+ * serial decode: each point is an int32 lng,lat pair in 1e-6 degrees that
+ * can be used directly or converted with plain vector arithmetic.
+ *
+ * Layout of the section:
+ *   uint32_t count                       Number of shapes.
+ *   QuantizedShapes::Entry[count + 1]    Index sorted by edge info offset.
+ *                                        The last entry is a sentinel whose
+ *                                        point_offset is the total number
+ *                                        of points.
+ *   int32_t[2 * total]                   lng,lat pairs of all shapes.
+ */
+class QuantizedShapes {
+ public:
+  // Index entry. Points of the shape are [point_offset, next point_offset).
+  struct Entry {
+    uint32_t edgeinfo_offset;
+    uint32_t point_offset;
+  };
+
+  /**
+   * Constructor for a tile without quantized shapes.
+   */
+  QuantizedShapes();
+
+  /**
+   * Constructor. A section that is truncated or whose index is not sorted
+   * is ignored (logged) so lookups never read past it.
+   * @param  ptr   Pointer to the start of the section within the tile.
+   * @param  size  Size (bytes) of the section.
+   */
+  QuantizedShapes(const char* ptr, const size_t size);
+
+  /**
+   * Are there any quantized shapes?
+   * @return  Returns true if the section is absent or empty.
+   */
+  bool empty() const;
+
+  /**
+   * Get the quantized shape for the edge info at the given offset.
+   * @param  edgeinfo_offset  Offset to the edge info (see DirectedEdge).
+   * @return  Returns the interleaved lng,lat coordinates. Empty if the edge
+   *          info has no quantized shape.
+   */
+  midgard::iterable_t<const int32_t> find(const uint32_t edgeinfo_offset) const;
+
+  /**
+   * Converts quantized coordinates to points and appends them to a list.
+   * @param  coords  Interleaved lng,lat coordinates (1e-6 degrees).
+   * @param  count   Number of points (half the number of coordinates).
+   * @param  shape   (OUT) Points are appended.
+   */
+  static void Dequantize(const int32_t* coords, const size_t count,
+                         std::vector<midgard::PointLL>& shape);
+
+  /**
+   * Serializes shapes into the section format.
+   * @param  shapes  Shape of each edge info keyed by edge info offset.
+   * @return  Returns the bytes of the section.
+   */
+  static std::string Serialize(
+      const std::map<uint32_t, std::vector<midgard::PointLL> >& shapes);
+
+ protected:
+  // Index of shapes (count + 1 entries including the sentinel)
+  const Entry* entries_;
+
+  // Number of shapes
+  uint32_t count_;
+
+  // Quantized lng,lat coordinates of all shapes
+  const int32_t* coords_;
+};
+
+}
+}
+
+#endif  // VALHALLA_BALDR_QUANTIZEDSHAPE_H_
@@ -0,0 +1,240 @@
+#ifndef VALHALLA_BALDR_RECORDFIELDS_H_
+#define VALHALLA_BALDR_RECORDFIELDS_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+#include <valhalla/baldr/directededge.h>
+#include <valhalla/baldr/nodeinfo.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * Location of a bit field within a fixed size record viewed as an array of
+ * 64 bit words (bits are allocated from the least significant bit, as the
+ * compilers we support lay out bit fields on little endian targets).
+ */
+struct BitField {
+  uint32_t word;   // Index of the 64 bit word holding the field
+  uint32_t shift;  // Bit offset of the field within the word
+  uint32_t width;  // Number of bits (at most 32)
+};
+
+// Expand a layout list entry to a field name, or to nothing
+#define VALHALLA_FIELD_NAME(field, type, member, width) field,
+#define VALHALLA_NO_FIELD_NAME(type, member, width)
+
+/**
+ * Fields of DirectedEdge that can be extracted in bulk, generated from the
+ * bit field lists in directededge.h. Values are extracted as stored: fields
+ * holding values for several local edge indexes (turn type, stop impact,
+ * edge to left/right) come out whole.
+ */
+enum class DirectedEdgeField : uint8_t {
+  VALHALLA_DIRECTEDEDGE_WORDS(VALHALLA_FIELD_NAME, VALHALLA_NO_FIELD_NAME)
+  VALHALLA_DIRECTEDEDGE_STOPIMPACT(VALHALLA_FIELD_NAME, VALHALLA_NO_FIELD_NAME)
+  kLineId,
+  VALHALLA_DIRECTEDEDGE_TRANSITIONS(VALHALLA_FIELD_NAME, VALHALLA_NO_FIELD_NAME)
+  kCount
+};
+
+/**
+ * Fields of NodeInfo that can be extracted in bulk, generated from the bit
+ * field list in nodeinfo.h. Values are extracted as stored: local
+ * driveability holds values for several local edge indexes and the local
+ * edge count is stored less one.
+ */
+enum class NodeInfoField : uint8_t {
+  VALHALLA_NODEINFO_BITFIELDS(VALHALLA_FIELD_NAME, VALHALLA_NO_FIELD_NAME)
+  kStopIndex,
+  kCount
+};
+
+#undef VALHALLA_FIELD_NAME
+#undef VALHALLA_NO_FIELD_NAME
+
+/**
+ * A member of a record layout, in storage order. Members are placed one
+ * after another (in units of their declared type, which they may not
+ * straddle). A view names the bits of the members that follow it, as a
+ * member of a union does, and takes no space itself.
+ */
+struct LayoutMember {
+  uint32_t field;   // Field index, kNoField for members that are not fields
+  uint32_t width;   // Number of bits
+  uint32_t unit;    // Number of bits of the declared type
+  bool view;
+};
+
+constexpr uint32_t kNoField = ~0u;
+
+// Expand a layout list entry to a LayoutMember
+#define VALHALLA_EDGE_MEMBER(field, type, member, width) \
+  {static_cast<uint32_t>(DirectedEdgeField::field), width, 8 * sizeof(type), false},
+#define VALHALLA_NODE_MEMBER(field, type, member, width) \
+  {static_cast<uint32_t>(NodeInfoField::field), width, 8 * sizeof(type), false},
+#define VALHALLA_OTHER_MEMBER(type, member, width) {kNoField, width, 8 * sizeof(type), false},
+
+// Layout of DirectedEdge. Only the end node and the stop impact / line id
+// union are placed by hand (directededge.h asserts their sizes).
+constexpr LayoutMember kDirectedEdgeLayout[] = {
+  {kNoField, 64, 64, false},  // End node
+  VALHALLA_DIRECTEDEDGE_WORDS(VALHALLA_EDGE_MEMBER, VALHALLA_OTHER_MEMBER)
+  {static_cast<uint32_t>(DirectedEdgeField::kLineId), 32, 32, true},
+  VALHALLA_DIRECTEDEDGE_STOPIMPACT(VALHALLA_EDGE_MEMBER, VALHALLA_OTHER_MEMBER)
+  VALHALLA_DIRECTEDEDGE_TRANSITIONS(VALHALLA_EDGE_MEMBER, VALHALLA_OTHER_MEMBER)
+};
+
+// Layout of NodeInfo. Only the lat,lng, the stop index union and the
+// headings are placed by hand (nodeinfo.h asserts their sizes).
+constexpr LayoutMember kNodeInfoLayout[] = {
+  {kNoField, 64, 64, false},  // Lat,lng
+  VALHALLA_NODEINFO_BITFIELDS(VALHALLA_NODE_MEMBER, VALHALLA_OTHER_MEMBER)
+  {static_cast<uint32_t>(NodeInfoField::kStopIndex), 32, 32, true},
+  {kNoField, 32, 32, false},  // Stop index / name consistency
+  {kNoField, 64, 64, false}   // Headings
+};
+
+#undef VALHALLA_EDGE_MEMBER
+#undef VALHALLA_NODE_MEMBER
+#undef VALHALLA_OTHER_MEMBER
+
+/**
+ * Get the number of bits of a layout.
+ * @param  layout  Layout members.
+ * @param  count   Number of members.
+ * @return  Returns the number of bits.
+ */
+constexpr uint32_t LayoutBits(const LayoutMember* layout, const size_t count) {
+  return count == 0 ? 0 :
+      LayoutBits(layout, count - 1) + (layout[count - 1].view ? 0 : layout[count - 1].width);
+}
+
+/**
+ * Check that no member of a layout straddles a unit of its declared type,
+ * so members are placed where the compiler places the bit fields.
+ * @param  layout  Layout members.
+ * @param  count   Number of members.
+ * @param  bit     Bit position of the first member.
+ * @return  Returns true if every member fits its unit.
+ */
+constexpr bool LayoutFits(const LayoutMember* layout, const size_t count,
+                          const uint32_t bit = 0) {
+  return count == 0 ||
+      ((bit % layout->unit) + layout->width <= layout->unit &&
+       LayoutFits(layout + 1, count - 1, bit + (layout->view ? 0 : layout->width)));
+}
+
+/**
+ * Find the location of a field in a layout. Fails to compile (or throws)
+ * if the field is not in the layout.
+ * @param  layout  Layout members.
+ * @param  count   Number of members.
+ * @param  field   Field index.
+ * @param  bit     Bit position of the first member.
+ * @return  Returns the word, shift and width of the field.
+ */
+constexpr BitField LocateField(const LayoutMember* layout, const size_t count,
+                               const uint32_t field, const uint32_t bit = 0) {
+  return count == 0 ? throw std::logic_error("Field is not in the layout") :
+      layout->field == field ? BitField{bit / 64, bit % 64, layout->width} :
+      LocateField(layout + 1, count - 1, field, bit + (layout->view ? 0 : layout->width));
+}
+
+constexpr size_t kDirectedEdgeLayoutSize = sizeof(kDirectedEdgeLayout) / sizeof(LayoutMember);
+constexpr size_t kNodeInfoLayoutSize = sizeof(kNodeInfoLayout) / sizeof(LayoutMember);
+static_assert(LayoutBits(kDirectedEdgeLayout, kDirectedEdgeLayoutSize) == 8 * sizeof(DirectedEdge),
+              "DirectedEdge layout does not match its size");
+static_assert(LayoutFits(kDirectedEdgeLayout, kDirectedEdgeLayoutSize),
+              "DirectedEdge layout has a member straddling its unit");
+static_assert(LayoutBits(kNodeInfoLayout, kNodeInfoLayoutSize) == 8 * sizeof(NodeInfo),
+              "NodeInfo layout does not match its size");
+static_assert(LayoutFits(kNodeInfoLayout, kNodeInfoLayoutSize),
+              "NodeInfo layout has a member straddling its unit");
+
+/**
+ * Get the location of a DirectedEdge field.
+ * @param  field  Field.
+ * @return  Returns the word, shift and width of the field.
+ */
+constexpr BitField GetBitField(const DirectedEdgeField field) {
+  return LocateField(kDirectedEdgeLayout, kDirectedEdgeLayoutSize, static_cast<uint32_t>(field));
+}
+
+/**
+ * Get the location of a NodeInfo field.
+ * @param  field  Field.
+ * @return  Returns the word, shift and width of the field.
+ */
+constexpr BitField GetBitField(const NodeInfoField field) {
+  return LocateField(kNodeInfoLayout, kNodeInfoLayoutSize, static_cast<uint32_t>(field));
+}
+
+/**
+ * Does a field lie within one 32 bit half of its word, so it can be loaded
+ * into a 32 bit lane (see LoadField4).
+ * @param  field  Field location.
+ * @return  Returns true if the field does not straddle the halves.
+ */
+constexpr bool InHalfWord(const BitField& field) {
+  return (field.shift % 32) + field.width <= 32;
+}
+
+#if defined(__SSE2__)
+/**
+ * Load a field of 4 consecutive records into the 32 bit lanes of an SSE2
+ * register, record j into lane j. The 32 bit halves holding the field are
+ * gathered from two 64 bit pairs and the field is shifted and masked in
+ * all lanes at once.
+ * @param  words  First word of the first record.
+ * @param  field  Field location, within one half of its word (InHalfWord).
+ * @return  Returns the field values.
+ */
+template <size_t kWords>
+inline __m128i LoadField4(const uint64_t* words, const BitField& field) {
+  const uint64_t* w = words + field.word;
+  __m128 low = _mm_castsi128_ps(_mm_set_epi64x(w[kWords], w[0]));
+  __m128 high = _mm_castsi128_ps(_mm_set_epi64x(w[3 * kWords], w[2 * kWords]));
+  __m128i halves = _mm_castps_si128(field.shift < 32 ?
+      _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)) :
+      _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+  uint32_t mask = field.width < 32 ? (1u << field.width) - 1 : ~0u;
+  return _mm_and_si128(_mm_srl_epi32(halves, _mm_cvtsi32_si128(field.shift % 32)),
+                       _mm_set1_epi32(static_cast<int>(mask)));
+}
+#endif
+
+/**
+ * Extract one field of consecutive directed edges into a dense array, for
+ * filtering or analytics over a whole tile. The records are read as 64 bit
+ * words and the field is pulled out with a shift and mask, instead of an
+ * accessor call per edge.
+ * @param  edges   First directed edge.
+ * @param  count   Number of directed edges.
+ * @param  field   Field to extract.
+ * @param  values  (OUT) Field values, one per edge. Must hold count values.
+ */
+void ExtractField(const DirectedEdge* edges, const size_t count,
+                  const DirectedEdgeField field, uint32_t* values);
+
+/**
+ * Extract one field of consecutive nodes into a dense array (see the
+ * DirectedEdge overload).
+ * @param  nodes   First node.
+ * @param  count   Number of nodes.
+ * @param  field   Field to extract.
+ * @param  values  (OUT) Field values, one per node. Must hold count values.
+ */
+void ExtractField(const NodeInfo* nodes, const size_t count,
+                  const NodeInfoField field, uint32_t* values);
+
+}
+}
+
+#endif  // VALHALLA_BALDR_RECORDFIELDS_H_
@@ -0,0 +1,33 @@
+#ifndef VALHALLA_BALDR_SHAPEDECODER_H_
+#define VALHALLA_BALDR_SHAPEDECODER_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include <valhalla/midgard/pointll.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * Decodes an encoded polyline (6 digit precision, lat before lng) directly
+ * from the given bytes and appends the points to the output. This is the
+ * same encoding as midgard::encode but avoids the string copy and the new
+ * vector. The bytes are classified (varint terminators and 5 bit payloads)
+ * with SSE2, and with AVX2 when the CPU supports it (checked at run time),
+ * with a scalar fallback otherwise. Each varint is then assembled without a
+ * per-byte loop.
+ * @param  encoded  Pointer to the encoded shape bytes.
+ * @param  size     Number of encoded bytes.
+ * @param  shape    (OUT) Decoded points are appended. Reuse this buffer
+ *                  across calls to avoid allocations.
+ * @return Returns the number of points appended.
+ */
+size_t DecodePolyline(const char* encoded, const size_t size,
+                      std::vector<midgard::PointLL>& shape);
+
+}
+}
+
+#endif  // VALHALLA_BALDR_SHAPEDECODER_H_
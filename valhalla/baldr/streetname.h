@@ -4,17 +4,32 @@
 #include <string>
 #include <memory>
 
+#include <valhalla/baldr/nameinterner.h>
+
 namespace valhalla {
 namespace baldr {
 
 class StreetName {
  public:
-  StreetName(const std::string& value);
+  /**
+   * Constructor
+   * @param  value  Street name.
+   * @param  id     Id of the name in the process-wide NameInterner or
+   *                kInvalidNameId if the name is not interned.
+   */
+  StreetName(const std::string& value, const uint32_t id = kInvalidNameId);
 
   virtual ~StreetName();
 
   const std::string& value() const;
 
+  /**
+   * Get the interned id of the name.
+   * @return  Returns the id or kInvalidNameId if the name is not interned.
+   */
+  uint32_t id() const;
+
+  // Compares the ids if both names are interned, else the values.
   bool operator ==(const StreetName& rhs) const;
 
   bool StartsWith(const std::string& prefix) const;
@@ -33,6 +48,7 @@ class StreetName {
 
  protected:
   std::string value_;
+  uint32_t id_;
 
 };
 
@@ -12,7 +12,7 @@ namespace baldr {
 
 class StreetNameUs : public StreetName {
  public:
-  StreetNameUs(const std::string& value);
+  StreetNameUs(const std::string& value, const uint32_t id = kInvalidNameId);
 
   std::string GetPreDir() const override;
 
@@ -16,7 +16,13 @@ class StreetNames : public std::list<std::unique_ptr<StreetName>> {
  public:
   StreetNames();
 
-  StreetNames(const std::vector<std::string>& names);
+  /**
+   * Constructor
+   * @param  names   Street names.
+   * @param  intern  If true the names are interned in the process-wide
+   *                 NameInterner so that comparisons use ids.
+   */
+  StreetNames(const std::vector<std::string>& names, const bool intern = false);
 
   virtual ~StreetNames();
 
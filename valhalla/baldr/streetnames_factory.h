@@ -14,8 +14,17 @@ class StreetNamesFactory {
  public:
   StreetNamesFactory() = delete;
 
+  /**
+   * Create the street names for a country.
+   * @param  country_code  Country ISO code.
+   * @param  names         Street names.
+   * @param  intern        If true the names are interned in the process-wide
+   *                       NameInterner so that comparisons use ids.
+   * @return  Returns the street names.
+   */
   static std::unique_ptr<StreetNames> Create(
-      const std::string& country_code, const std::vector<std::string>& names);
+      const std::string& country_code, const std::vector<std::string>& names,
+      const bool intern = false);
 
 };
 
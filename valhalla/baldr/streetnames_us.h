@@ -14,7 +14,13 @@ class StreetNamesUs : public StreetNames {
  public:
   StreetNamesUs();
 
-  StreetNamesUs(const std::vector<std::string>& names);
+  /**
+   * Constructor
+   * @param  names   Street names.
+   * @param  intern  If true the names are interned in the process-wide
+   *                 NameInterner so that comparisons use ids.
+   */
+  StreetNamesUs(const std::vector<std::string>& names, const bool intern = false);
 
   ~StreetNamesUs();
 
@@ -11,6 +11,7 @@
 #include <valhalla/midgard/tiles.h>
 #include <valhalla/baldr/graphid.h>
 #include <valhalla/baldr/graphconstants.h>
+#include <valhalla/baldr/tilepath.h>
 
 namespace valhalla {
 namespace baldr {
@@ -71,6 +72,14 @@ class TileHierarchy {
    */
   GraphId GetGraphId(const midgard::PointLL& pointll, const uint8_t level) const;
 
+  /**
+   * Get the codec of the tile file paths of the levels, relative to the
+   * tile directory
+   *
+   * @return the tile path codec
+   */
+  const TilePath& tile_path() const;
+
  private:
   explicit TileHierarchy();
 
@@ -78,6 +87,8 @@ class TileHierarchy {
   std::map<uint8_t, TileLevel> levels_;
   // the tiles are stored
   std::string tile_dir_;
+  // formats and parses tile paths, worked out once from the levels
+  TilePath tile_path_;
 };
 
 }
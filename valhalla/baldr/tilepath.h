@@ -0,0 +1,93 @@
+#ifndef VALHALLA_BALDR_TILEPATH_H_
+#define VALHALLA_BALDR_TILEPATH_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <valhalla/baldr/graphid.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * Formats and parses the paths of tile files relative to the tile
+ * directory: the level followed by the tile id in groups of 3 digits, one
+ * directory per group, for example 2/000/749/133.gph. The number of groups
+ * of each level is enough for the largest tile id of the level and is
+ * worked out once, so formatting and parsing do not allocate.
+ */
+class TilePath {
+ public:
+  // Longest path: a 3 digit level, 4 groups for a 32 bit tile id and the
+  // extension, with the terminating null
+  static constexpr size_t kMaxLength = 3 + 4 * 4 + 4 + 1;
+
+  /**
+   * Constructor for no levels.
+   */
+  TilePath();
+
+  /**
+   * Adds a level.
+   * @param  level   Hierarchy level.
+   * @param  max_id  Largest tile id of the level.
+   */
+  void AddLevel(const uint8_t level, const uint32_t max_id);
+
+  /**
+   * Formats the path of a tile into a buffer.
+   * @param  graphid  Graph Id of the tile (its level and tile id).
+   * @param  buffer   Buffer of at least kMaxLength characters.
+   * @return  Returns the length of the path, without the terminating null.
+   */
+  size_t Format(const GraphId& graphid, char* buffer) const;
+
+  /**
+   * Gets the path of a tile.
+   * @param  graphid  Graph Id of the tile (its level and tile id).
+   * @return  Returns the path.
+   */
+  std::string Path(const GraphId& graphid) const;
+
+  /**
+   * Gets the full path of a tile file, or of a file kept next to it.
+   * @param  dir        Tile directory.
+   * @param  graphid    Graph Id of the tile (its level and tile id).
+   * @param  extension  Extension of the file, replacing .gph.
+   * @return  Returns the path, allocated once.
+   */
+  std::string FullPath(const std::string& dir, const GraphId& graphid,
+                       const char* extension = ".gph") const;
+
+  /**
+   * Parses the tile path at the end of a file path. The level must be
+   * written without leading zeros and followed by the number of groups
+   * of the level.
+   * @param  path    File path, it may start with the tile directory.
+   * @param  length  Length of the file path.
+   * @return  Returns the (base) Id of the tile, invalid if the path does not
+   *          end with a tile path.
+   */
+  GraphId Parse(const char* path, const size_t length) const;
+
+  /**
+   * Finds the tile files under a directory. Entries are read directly
+   * rather than through boost::filesystem and only the names ending in
+   * .gph are parsed.
+   * @param  dir        Directory to search.
+   * @param  recursive  Whether to search the subdirectories too.
+   * @return  Returns the (base) Ids of the tiles, in no particular order.
+   */
+  std::vector<GraphId> FindTiles(const std::string& dir, const bool recursive = true) const;
+
+ protected:
+  // Number of digit groups by level, -1 for a level that does not exist
+  int8_t groups_[256];
+};
+
+}
+}
+
+#endif  // VALHALLA_BALDR_TILEPATH_H_
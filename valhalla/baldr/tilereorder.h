@@ -0,0 +1,77 @@
+#ifndef VALHALLA_BALDR_TILEREORDER_H_
+#define VALHALLA_BALDR_TILEREORDER_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/baldr/graphtile.h>
+#include <valhalla/baldr/tilehierarchy.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * New positions of the nodes and directed edges of a tile.
+ */
+struct TileOrder {
+  std::vector<uint32_t> nodes;  // New index of each node
+  std::vector<uint32_t> edges;  // New index of each directed edge
+};
+
+/**
+ * Gets the distance along a Hilbert curve filling a 65536 x 65536 grid to
+ * a cell of the grid. Cells near each other along the curve are near each
+ * other in the grid.
+ * @param  x  Column of the cell (0 - 65535).
+ * @param  y  Row of the cell (0 - 65535).
+ * @return  Returns the distance along the curve.
+ */
+uint32_t HilbertIndex(const uint32_t x, const uint32_t y);
+
+/**
+ * Gets a locality preserving order of the nodes of a tile: nodes are
+ * ordered along a Hilbert curve over the tile bounding box, ties keep
+ * their current order. The directed edges of each node follow the node
+ * in their current order, so the local edge indexes at each node (opposing
+ * edge index, turn and restriction masks) do not change.
+ * @param  tile       Graph tile.
+ * @param  hierarchy  Tile hierarchy, used for the tile bounding box.
+ * @return  Returns the new positions of the nodes and directed edges.
+ */
+TileOrder HilbertOrder(const GraphTile& tile, const TileHierarchy& hierarchy);
+
+/**
+ * Gets a tile rewritten with its nodes and directed edges renumbered. Node
+ * edge indexes, end nodes, sign and access restriction edge indexes and
+ * edge cells are remapped. End nodes and edge cells in other tiles are
+ * remapped with the order of that tile when it has one.
+ * @param  hierarchy  Tile hierarchy.
+ * @param  graphid    Tile to rewrite.
+ * @param  orders     New orders keyed by tile (base) id, must include the tile.
+ * @return  Returns the bytes of the rewritten tile.
+ */
+std::string ReorderTile(const TileHierarchy& hierarchy, const GraphId& graphid,
+                        const std::unordered_map<GraphId, TileOrder>& orders);
+
+/**
+ * Rewrites all the tiles in the tile directory with their nodes in
+ * Hilbert order (see HilbertOrder). Every tile is ordered before any is
+ * rewritten, since end nodes refer to nodes in neighboring tiles. Every
+ * tile is written to a temporary file before any replaces its tile, and
+ * the old tiles are kept as .bak files until all are replaced, so a failed
+ * write or rename leaves the tiles as they were (unless restoring a backup
+ * fails too, which is logged and reported). The component labels (see
+ * NodeComponents) and overlays (see CellOverlay) of the tiles are removed
+ * and the connectivity file no longer matches the tiles, rebuild them.
+ * @param  hierarchy  Tile hierarchy.
+ * @return  Returns the number of tiles rewritten.
+ */
+size_t ReorderTiles(const TileHierarchy& hierarchy);
+
+}
+}
+
+#endif  // VALHALLA_BALDR_TILEREORDER_H_
@@ -0,0 +1,62 @@
+#ifndef VALHALLA_BALDR_TILESECTION_H_
+#define VALHALLA_BALDR_TILESECTION_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <valhalla/baldr/graphtileheader.h>
+
+namespace valhalla {
+namespace baldr {
+
+// Sections of a version 2 tile start on a cache line
+constexpr uint32_t kTileSectionAlignment = 64;
+
+/**
+ * Entry in the table of contents of a version 2 tile. The table follows
+ * the header (see GraphTileHeader::section_count) and locates each section
+ * so sections can be added, reordered or left out without breaking
+ * readers. Readers skip section types they do not know.
+ */
+struct TileSection {
+  enum class Type : uint32_t {
+    kNodes = 0,
+    kDirectedEdges = 1,
+    kDepartures = 2,
+    kTransitStops = 3,
+    kTransitRoutes = 4,
+    kTransitTransfers = 5,
+    kAccessRestrictions = 6,
+    kSigns = 7,
+    kAdmins = 8,
+    kEdgeCells = 9,
+    kEdgeInfo = 10,
+    kTextList = 11,
+    kQuantizedShapes = 12
+  };
+
+  uint32_t type;       // Section type (see Type)
+  uint32_t offset;     // Offset in bytes from the start of the tile
+  uint32_t size;       // Size in bytes
+  uint32_t alignment;  // Alignment of the offset in bytes
+};
+
+/**
+ * Serialize a tile in the version 2 format: the header, the table of
+ * contents and the sections, each aligned to kTileSectionAlignment.
+ * @param  header    Header with the record counts and cell offsets set.
+ *                   The format version, section count and the edge info,
+ *                   text list and quantized shape offsets are set here.
+ * @param  sections  Section types and their bytes, in the order to store
+ *                   them.
+ * @return  Returns the tile bytes.
+ */
+std::string SerializeTile(GraphTileHeader header,
+    const std::vector<std::pair<TileSection::Type, std::string> >& sections);
+
+}
+}
+
+#endif  // VALHALLA_BALDR_TILESECTION_H_
@@ -0,0 +1,94 @@
+#ifndef VALHALLA_BALDR_TILESIDECAR_H_
+#define VALHALLA_BALDR_TILESIDECAR_H_
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/baldr/graphtile.h>
+
+namespace valhalla {
+namespace baldr {
+
+/**
+ * Base of the files stored next to a tile with data derived from it and
+ * keyed by node index (see CellOverlay and NodeComponents). Each file
+ * starts with a header holding its layout version and the tile id, node
+ * count and fingerprint (see GraphTile::fingerprint) of the tile it was
+ * built from, so data of a tile that was rebuilt or reordered since is
+ * not used.
+ */
+class TileSidecar {
+ public:
+  /**
+   * Get the tile the data was built from.
+   * @return  Returns the tile (base) Id, invalid if there is no data.
+   */
+  GraphId tile() const;
+
+  /**
+   * Get the number of nodes of the tile the data was built from.
+   * @return  Returns the node count.
+   */
+  uint32_t nodecount() const;
+
+  /**
+   * Get the fingerprint of the tile the data was built from.
+   * @return  Returns the fingerprint.
+   */
+  uint64_t fingerprint() const;
+
+  /**
+   * Was the data built from this tile, as it is now?
+   * @param  tile  Graph tile.
+   * @return  Returns true if the tile id, node count and fingerprint match.
+   */
+  bool Matches(const GraphTile& tile) const;
+
+ protected:
+  /**
+   * Constructor for no data.
+   */
+  TileSidecar();
+
+  /**
+   * Constructor for data built from a tile.
+   * @param  tile  Graph tile.
+   */
+  TileSidecar(const GraphTile& tile);
+
+  /**
+   * Read a file written by Write. The tile id, node count and fingerprint
+   * are only set if the whole file could be read.
+   * @param  file       Sidecar file.
+   * @param  version    Layout version the file must have.
+   * @param  read_body  Reads what follows the header, given the node count.
+   * @return  Returns false if the file is missing, has another version or
+   *          is truncated (logged), the data read must then be dropped.
+   */
+  bool Read(const std::string& file, const uint32_t version,
+            const std::function<void (std::istream&, const uint32_t)>& read_body);
+
+  /**
+   * Write the header and the data to a file. It is written to a temporary
+   * file that then replaces the file, so readers never see part of it.
+   * @param  file        Sidecar file.
+   * @param  version     Layout version.
+   * @param  write_body  Writes what follows the header.
+   * @return  Returns true if the file was written.
+   */
+  bool Write(const std::string& file, const uint32_t version,
+             const std::function<void (std::ostream&)>& write_body) const;
+
+  GraphId tile_;
+  uint32_t nodecount_;
+  uint64_t fingerprint_;
+};
+
+}
+}
+
+#endif  // VALHALLA_BALDR_TILESIDECAR_H_